@@ -0,0 +1,66 @@
+/**
+ * @file allocations.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Heap allocation counter of benchmarks.
+ * @version 0.1
+ * @date 2019-06-15
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Replaces global operator new/delete, kept in separate translation unit
+ * so replacements are never inlined into callers.
+ */
+
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+/* benchmarks run in one thread, counter needs no synchronization */
+static uint64_t allocations = 0;
+
+/**
+ * @brief Getter of number of allocations made so far.
+ *
+ * @return uint64_t Number of operator new calls.
+ */
+uint64_t allocation_count()
+{
+    return allocations;
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
\ No newline at end of file
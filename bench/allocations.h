@@ -0,0 +1,18 @@
+/**
+ * @file allocations.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Heap allocation counter of benchmarks.
+ * @version 0.1
+ * @date 2019-06-15
+ *
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_BENCH_ALLOCATIONS_H
+#define DISSPCAP_BENCH_ALLOCATIONS_H
+
+#include <stdint.h>
+
+uint64_t allocation_count();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,529 @@
+/**
+ * @file dissectors.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Microbenchmarks of dissectors over packets from pcaps.
+ * @version 0.1
+ * @date 2019-06-15
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Usage: disspcap_bench [benchmark options] [pcap or directory ...]
+ * (tests/pcaps by default). One iteration dissects one packet, so reported
+ * time is time per packet. bytes_per_second counts dissected bytes and
+ * allocs/pkt heap allocations made by dissector.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <dirent.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <vector>
+
+#include "allocations.h"
+
+#include "../src/dns.h"
+#include "../src/ethernet.h"
+#include "../src/http.h"
+#include "../src/ipv4.h"
+#include "../src/ipv6.h"
+#include "../src/irc.h"
+#include "../src/packet.h"
+#include "../src/pcap.h"
+#include "../src/tcp.h"
+#include "../src/telnet.h"
+#include "../src/udp.h"
+
+using namespace disspcap;
+
+namespace {
+
+const char* DEFAULT_PCAPS = "tests/pcaps"; /**< Used when no pcap is given. */
+
+/**
+ * @brief Captured frame.
+ */
+struct frame {
+    std::vector<uint8_t> data;
+    uint8_t link_type;
+    double timestamp;
+};
+
+/**
+ * @brief Set of inputs of one benchmark.
+ */
+typedef std::vector<std::vector<uint8_t>> sample_set;
+
+/**
+ * @brief Inputs of all benchmarks, layers start at the beginning of sample.
+ */
+struct samples {
+    std::vector<std::pair<std::string, std::vector<frame>>> pcaps;
+    std::vector<frame> frames;
+    sample_set ethernet;
+    sample_set ipv4;
+    sample_set ipv6;
+    sample_set tcp;
+    sample_set udp;
+    sample_set dns;
+    sample_set http;
+    sample_set irc;
+    sample_set telnet;
+};
+
+/**
+ * @brief Dissects one sample.
+ */
+typedef void (*dissector)(uint8_t* data, unsigned int length);
+
+/**
+ * @brief Dissects Ethernet sample.
+ */
+void dissect_ethernet(uint8_t* data, unsigned int)
+{
+    Ethernet ethernet(data);
+    benchmark::DoNotOptimize(&ethernet);
+}
+
+/**
+ * @brief Dissects IPv4 sample.
+ */
+void dissect_ipv4(uint8_t* data, unsigned int)
+{
+    IPv4 ipv4(data);
+    benchmark::DoNotOptimize(&ipv4);
+}
+
+/**
+ * @brief Dissects IPv6 sample.
+ */
+void dissect_ipv6(uint8_t* data, unsigned int)
+{
+    IPv6 ipv6(data);
+    benchmark::DoNotOptimize(&ipv6);
+}
+
+/**
+ * @brief Dissects TCP sample.
+ */
+void dissect_tcp(uint8_t* data, unsigned int length)
+{
+    TCP tcp(data, length);
+    benchmark::DoNotOptimize(&tcp);
+}
+
+/**
+ * @brief Dissects UDP sample.
+ */
+void dissect_udp(uint8_t* data, unsigned int)
+{
+    UDP udp(data);
+    benchmark::DoNotOptimize(&udp);
+}
+
+/**
+ * @brief Dissects DNS sample.
+ */
+void dissect_dns(uint8_t* data, unsigned int length)
+{
+    DNS dns(data, length);
+    benchmark::DoNotOptimize(&dns);
+}
+
+/**
+ * @brief Dissects HTTP sample.
+ */
+void dissect_http(uint8_t* data, unsigned int length)
+{
+    HTTP http(data, length);
+    benchmark::DoNotOptimize(&http);
+}
+
+/**
+ * @brief Dissects IRC sample.
+ */
+void dissect_irc(uint8_t* data, unsigned int length)
+{
+    IRC irc(data, length);
+    benchmark::DoNotOptimize(&irc);
+}
+
+/**
+ * @brief Dissects Telnet sample.
+ */
+void dissect_telnet(uint8_t* data, unsigned int length)
+{
+    Telnet telnet(data, length);
+    benchmark::DoNotOptimize(&telnet);
+}
+
+/**
+ * @brief Sets reported counters.
+ *
+ * @param state Benchmark state.
+ * @param bytes Dissected bytes.
+ * @param allocated Allocations made while dissecting.
+ */
+void report(benchmark::State& state, uint64_t bytes, uint64_t allocated)
+{
+    if (bytes) {
+        state.SetBytesProcessed(bytes);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs/pkt"] = benchmark::Counter(allocated, benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief Benchmark of one dissector, samples are dissected in turn.
+ *
+ * @param state Benchmark state.
+ * @param set Samples.
+ * @param dissect Dissector.
+ */
+void bench_layer(benchmark::State& state, const sample_set* set, dissector dissect)
+{
+    if (set->empty()) {
+        state.SkipWithError("no samples in given pcaps");
+        return;
+    }
+
+    std::vector<std::vector<uint8_t>> inputs(*set);
+    size_t index       = 0;
+    uint64_t bytes     = 0;
+    uint64_t allocated = allocation_count();
+
+    for (auto _ : state) {
+        std::vector<uint8_t>& input = inputs[index];
+        dissect(input.data(), input.size());
+        bytes += input.size();
+
+        if (++index == inputs.size()) {
+            index = 0;
+        }
+    }
+
+    report(state, bytes, allocation_count() - allocated);
+}
+
+/**
+ * @brief Benchmark of whole packet dissection (Packet::parse).
+ *
+ * @param state Benchmark state.
+ * @param frames Captured frames.
+ */
+void bench_packet(benchmark::State& state, const std::vector<frame>* frames)
+{
+    if (frames->empty()) {
+        state.SkipWithError("no packets in given pcaps");
+        return;
+    }
+
+    std::vector<frame> inputs(*frames);
+    size_t index       = 0;
+    uint64_t bytes     = 0;
+    uint64_t allocated = allocation_count();
+
+    for (auto _ : state) {
+        frame& input = inputs[index];
+        Packet packet(input.data.data(), input.data.size(), input.timestamp, nullptr, input.link_type);
+        benchmark::DoNotOptimize(&packet);
+        bytes += input.data.size();
+
+        if (++index == inputs.size()) {
+            index = 0;
+        }
+    }
+
+    report(state, bytes, allocation_count() - allocated);
+}
+
+/**
+ * @brief Reads summary fields through layer getters (as Python attribute access does).
+ *
+ * @param packet Dissected packet.
+ */
+void read_fields(const Packet& packet)
+{
+    benchmark::DoNotOptimize(packet.timestamp());
+    benchmark::DoNotOptimize(packet.length());
+    benchmark::DoNotOptimize(packet.payload_length());
+
+    if (packet.ipv4()) {
+        benchmark::DoNotOptimize(packet.ipv4()->source().data());
+        benchmark::DoNotOptimize(packet.ipv4()->destination().data());
+    } else if (packet.ipv6()) {
+        benchmark::DoNotOptimize(packet.ipv6()->source().data());
+        benchmark::DoNotOptimize(packet.ipv6()->destination().data());
+    }
+
+    if (packet.tcp()) {
+        benchmark::DoNotOptimize(packet.tcp()->source_port());
+        benchmark::DoNotOptimize(packet.tcp()->destination_port());
+    } else if (packet.udp()) {
+        benchmark::DoNotOptimize(packet.udp()->source_port());
+        benchmark::DoNotOptimize(packet.udp()->destination_port());
+    }
+}
+
+/**
+ * @brief Reads summary at once.
+ *
+ * @param packet Dissected packet.
+ */
+void read_summary(const Packet& packet)
+{
+    packet_summary summary = packet.summary();
+    benchmark::DoNotOptimize(&summary);
+}
+
+/**
+ * @brief Benchmark of reading fields of already dissected packets.
+ *
+ * C++ baseline of bench/python_overhead.py.
+ *
+ * @param state Benchmark state.
+ * @param frames Captured frames.
+ * @param read Reader of fields.
+ */
+void bench_fields(benchmark::State& state, const std::vector<frame>* frames, void (*read)(const Packet&))
+{
+    if (frames->empty()) {
+        state.SkipWithError("no packets in given pcaps");
+        return;
+    }
+
+    std::vector<frame> inputs(*frames);
+    std::vector<std::unique_ptr<Packet>> packets;
+
+    for (frame& input : inputs) {
+        packets.push_back(std::unique_ptr<Packet>(
+            new Packet(input.data.data(), input.data.size(), input.timestamp, nullptr, input.link_type)));
+    }
+
+    size_t index       = 0;
+    uint64_t allocated = allocation_count();
+
+    for (auto _ : state) {
+        read(*packets[index]);
+
+        if (++index == packets.size()) {
+            index = 0;
+        }
+    }
+
+    report(state, 0, allocation_count() - allocated);
+}
+
+/**
+ * @brief Adds part of frame starting at offset to sample set.
+ *
+ * @param set Sample set.
+ * @param data Frame data.
+ * @param offset Start of layer.
+ * @param length Length of layer (clamped to frame).
+ */
+void add_sample(sample_set& set, const std::vector<uint8_t>& data, unsigned int offset, unsigned int length)
+{
+    if (offset >= data.size()) {
+        return;
+    }
+
+    length = std::min<unsigned int>(length, data.size() - offset);
+    set.push_back(std::vector<uint8_t>(data.begin() + offset, data.begin() + offset + length));
+}
+
+/**
+ * @brief Sorts layers of one frame into sample sets.
+ *
+ * @param all Sample sets.
+ * @param captured Frame.
+ */
+void add_frame(samples& all, const frame& captured)
+{
+    std::vector<uint8_t> data(captured.data);
+    Packet packet(data.data(), data.size(), captured.timestamp, nullptr, captured.link_type);
+    decap_result encapsulation;
+
+    decapsulate(data.data(), data.size(), encapsulation, captured.link_type);
+
+    if (encapsulation.network_offset > data.size()) {
+        return;
+    }
+
+    if (packet.ethernet()) {
+        all.ethernet.push_back(std::vector<uint8_t>(data.begin() + encapsulation.link_offset, data.end()));
+    }
+
+    unsigned int network   = encapsulation.network_offset;
+    unsigned int transport = 0;
+    unsigned int length    = 0;
+
+    if (packet.ipv4()) {
+        add_sample(all.ipv4, data, network, data.size() - network);
+
+        if (!packet.ipv4()->is_fragment()) {
+            transport = network + packet.ipv4()->header_length() * 4;
+            length    = packet.ipv4()->payload_length();
+        }
+    } else if (packet.ipv6() && network + IPV6_LEN <= data.size()) {
+        add_sample(all.ipv6, data, network, data.size() - network);
+
+        if (!packet.ipv6()->is_fragment()) {
+            uint16_t total_length;
+            std::memcpy(&total_length, data.data() + network + 4, sizeof(total_length));
+
+            /* extension headers are part of IPv6 payload length */
+            length    = packet.ipv6()->payload_length();
+            transport = network + IPV6_LEN + ntohs(total_length) - length;
+        }
+    }
+
+    if (!transport) {
+        return;
+    }
+
+    if (packet.tcp()) {
+        add_sample(all.tcp, data, transport, length);
+    } else if (packet.udp()) {
+        add_sample(all.udp, data, transport, length);
+    }
+
+    uint8_t* payload            = packet.payload();
+    unsigned int payload_length = packet.payload_length();
+
+    if (packet.dns() && payload_length >= 2) {
+        /* DNS over TCP is prefixed by message length */
+        unsigned int skip = packet.tcp() ? 2 : 0;
+        all.dns.push_back(std::vector<uint8_t>(payload + skip, payload + payload_length));
+    }
+
+    if (packet.http()) {
+        all.http.push_back(std::vector<uint8_t>(payload, payload + payload_length));
+    }
+
+    if (packet.irc()) {
+        all.irc.push_back(std::vector<uint8_t>(payload, payload + payload_length));
+    }
+
+    if (packet.telnet()) {
+        all.telnet.push_back(std::vector<uint8_t>(payload, payload + payload_length));
+    }
+}
+
+/**
+ * @brief Loads frames of pcap.
+ *
+ * @param all Sample sets.
+ * @param path Path to pcap.
+ */
+void load_pcap(samples& all, const std::string& path)
+{
+    Pcap pcap(path);
+    std::vector<frame> frames;
+    auto packet = pcap.next_packet(true);
+
+    while (packet) {
+        frame captured;
+        captured.data.assign(packet->raw_data(), packet->raw_data() + packet->length());
+        captured.link_type = pcap.link_type();
+        captured.timestamp = packet->timestamp();
+
+        add_frame(all, captured);
+        frames.push_back(captured);
+        all.frames.push_back(captured);
+        packet = pcap.next_packet(true);
+    }
+
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    all.pcaps.push_back(std::make_pair(name, frames));
+}
+
+/**
+ * @brief Loads pcap or all pcaps of directory.
+ *
+ * @param all Sample sets.
+ * @param path Path to pcap or directory.
+ */
+void load(samples& all, const std::string& path)
+{
+    struct stat info;
+
+    if (stat(path.c_str(), &info) != 0) {
+        throw std::runtime_error("Cannot access " + path);
+    }
+
+    if (!S_ISDIR(info.st_mode)) {
+        load_pcap(all, path);
+        return;
+    }
+
+    DIR* dir = opendir(path.c_str());
+    std::vector<std::string> names;
+
+    if (!dir) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name(entry->d_name);
+
+        if (name.size() > 5 && name.compare(name.size() - 5, 5, ".pcap") == 0) {
+            names.push_back(name);
+        }
+    }
+
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        load_pcap(all, path + "/" + name);
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    samples all;
+
+    try {
+        if (argc < 2) {
+            load(all, DEFAULT_PCAPS);
+        }
+
+        for (int i = 1; i < argc; ++i) {
+            load(all, argv[i]);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    benchmark::RegisterBenchmark("Ethernet", bench_layer, &all.ethernet, dissect_ethernet);
+    benchmark::RegisterBenchmark("IPv4", bench_layer, &all.ipv4, dissect_ipv4);
+    benchmark::RegisterBenchmark("IPv6", bench_layer, &all.ipv6, dissect_ipv6);
+    benchmark::RegisterBenchmark("TCP", bench_layer, &all.tcp, dissect_tcp);
+    benchmark::RegisterBenchmark("UDP", bench_layer, &all.udp, dissect_udp);
+    benchmark::RegisterBenchmark("DNS", bench_layer, &all.dns, dissect_dns);
+    benchmark::RegisterBenchmark("HTTP", bench_layer, &all.http, dissect_http);
+    benchmark::RegisterBenchmark("IRC", bench_layer, &all.irc, dissect_irc);
+    benchmark::RegisterBenchmark("Telnet", bench_layer, &all.telnet, dissect_telnet);
+    benchmark::RegisterBenchmark("Packet::parse/all", bench_packet, &all.frames);
+    benchmark::RegisterBenchmark("Packet::fields", bench_fields, &all.frames, read_fields);
+    benchmark::RegisterBenchmark("Packet::summary", bench_fields, &all.frames, read_summary);
+
+    for (const auto& pcap : all.pcaps) {
+        benchmark::RegisterBenchmark(("Packet::parse/" + pcap.first).c_str(), bench_packet, &pcap.second);
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
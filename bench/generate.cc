@@ -0,0 +1,782 @@
+/**
+ * @file generate.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Deterministic generator of synthetic captures for benchmarks.
+ * @version 0.1
+ * @date 2019-06-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Usage: disspcap_generate -o capture.pcap [options], see usage().
+ * Same options (and seed) always produce byte identical capture, own
+ * PRNG is used as standard distributions differ between libraries.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint8_t GEN_DNS    = 0; /**< DNS over UDP. */
+const uint8_t GEN_HTTP   = 1; /**< HTTP over TCP. */
+const uint8_t GEN_IRC    = 2; /**< IRC over TCP. */
+const uint8_t GEN_TELNET = 3; /**< Telnet over TCP. */
+const uint8_t GEN_TCP    = 4; /**< Other TCP. */
+const uint8_t GEN_UDP    = 5; /**< Other UDP. */
+const uint8_t GEN_KINDS  = 6;
+
+const char* const GEN_NAMES[GEN_KINDS] = { "dns", "http", "irc", "telnet", "tcp", "udp" };
+const uint16_t GEN_PORTS[GEN_KINDS]    = { 53, 80, 6667, 23, 5001, 5004 };
+
+const unsigned int MIN_FRAME    = 60;    /**< Minimal Ethernet frame (without FCS). */
+const unsigned int MAX_FRAME    = 65535; /**< Snapshot length of capture. */
+const uint32_t START_TIME       = 1560000000;
+const uint32_t PACKET_SPACING   = 10; /**< Microseconds between packets. */
+const uint16_t ETH_TYPE_IPV4    = 0x0800;
+const uint16_t ETH_TYPE_IPV6    = 0x86dd;
+const uint16_t ETH_TYPE_VLAN    = 0x8100;
+const uint8_t IP_PROTOCOL_TCP   = 6;
+const uint8_t IP_PROTOCOL_UDP   = 17;
+const uint8_t TELNET_IAC        = 255;
+const unsigned int SERVER_COUNT = 64; /**< Flows share small set of servers. */
+
+/**
+ * @brief Splitmix64 generator, deterministic on every platform.
+ */
+class Random {
+public:
+    Random(uint64_t seed)
+        : state_{ seed }
+    {
+    }
+
+    /**
+     * @brief Next 64 random bits.
+     */
+    uint64_t next()
+    {
+        uint64_t z = (this->state_ += 0x9e3779b97f4a7c15ULL);
+        z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Random number in [0, bound).
+     */
+    uint32_t below(uint32_t bound)
+    {
+        return bound ? static_cast<uint32_t>(this->next() % bound) : 0;
+    }
+
+    /**
+     * @brief True with given probability.
+     */
+    bool chance(double probability)
+    {
+        return (this->next() >> 11) * (1.0 / 9007199254740992.0) < probability;
+    }
+
+private:
+    uint64_t state_;
+};
+
+/**
+ * @brief Generator options.
+ */
+struct options {
+    std::string output;
+    uint64_t packets;
+    unsigned int flows;
+    uint64_t seed;
+    unsigned int mix[GEN_KINDS];                              /**< Weights of protocols. */
+    std::vector<std::pair<unsigned int, unsigned int>> sizes; /**< Frame size, weight. */
+    double vlan;
+    double ipv6;
+    double malformed;
+};
+
+/**
+ * @brief Generated connection (or UDP conversation).
+ */
+struct flow {
+    uint8_t kind;
+    bool ipv6;
+    uint16_t vlan; /**< VLAN ID, 0 if untagged. */
+    uint8_t client[16];
+    uint8_t server[16];
+    uint16_t client_port;
+    uint16_t server_port;
+    uint16_t host;   /**< Server index (DNS and HTTP host name). */
+    uint32_t seq[2]; /**< Next sequence number of client, server. */
+    uint16_t dns_id;
+    uint32_t counter; /**< Packets generated so far. */
+};
+
+/**
+ * @brief Picks index by weights.
+ *
+ * @param random Generator.
+ * @param weights Weights.
+ * @param count Number of weights.
+ * @return unsigned int Picked index.
+ */
+unsigned int pick(Random& random, const unsigned int* weights, unsigned int count)
+{
+    unsigned int total = 0;
+
+    for (unsigned int i = 0; i < count; ++i) {
+        total += weights[i];
+    }
+
+    uint32_t point = random.below(total);
+
+    for (unsigned int i = 0; i < count; ++i) {
+        if (point < weights[i]) {
+            return i;
+        }
+
+        point -= weights[i];
+    }
+
+    return count - 1;
+}
+
+/**
+ * @brief Appends 16-bit value in network order.
+ */
+void put16(std::vector<uint8_t>& out, uint16_t value)
+{
+    out.push_back(value >> 8);
+    out.push_back(value & 0xff);
+}
+
+/**
+ * @brief Appends 32-bit value in network order.
+ */
+void put32(std::vector<uint8_t>& out, uint32_t value)
+{
+    put16(out, value >> 16);
+    put16(out, value & 0xffff);
+}
+
+/**
+ * @brief Appends string.
+ */
+void put(std::vector<uint8_t>& out, const std::string& text)
+{
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+/**
+ * @brief Appends text of repeated words up to given length.
+ *
+ * @param out Output.
+ * @param random Generator.
+ * @param length Number of appended bytes.
+ */
+void put_words(std::vector<uint8_t>& out, Random& random, unsigned int length)
+{
+    static const char* const WORDS[] = { "lorem", "ipsum", "dolor", "sit", "amet", "packet", "capture", "network" };
+
+    for (unsigned int i = 0; i < length;) {
+        const char* word = WORDS[random.below(8)];
+
+        for (; *word && i < length; ++word, ++i) {
+            out.push_back(*word);
+        }
+
+        if (i < length) {
+            out.push_back(' ');
+            ++i;
+        }
+    }
+}
+
+/**
+ * @brief Appends DNS name of flow server.
+ */
+void put_dns_name(std::vector<uint8_t>& out, const flow& conversation)
+{
+    std::string host = "host" + std::to_string(conversation.host);
+
+    out.push_back(host.size());
+    put(out, host);
+    out.push_back(7);
+    put(out, "example");
+    out.push_back(3);
+    put(out, "com");
+    out.push_back(0);
+}
+
+/**
+ * @brief Builds DNS query or response (size target is ignored).
+ */
+void dns_payload(std::vector<uint8_t>& out, flow& conversation, bool from_client)
+{
+    uint16_t type = conversation.ipv6 ? 28 : 1;
+
+    if (from_client) {
+        ++conversation.dns_id;
+    }
+
+    put16(out, conversation.dns_id);
+    put16(out, from_client ? 0x0100 : 0x8180);
+    put16(out, 1);
+    put16(out, from_client ? 0 : 1);
+    put16(out, 0);
+    put16(out, 0);
+    put_dns_name(out, conversation);
+    put16(out, type);
+    put16(out, 1);
+
+    if (!from_client) {
+        put16(out, 0xc00c); /* pointer to question name */
+        put16(out, type);
+        put16(out, 1);
+        put32(out, 300);
+        put16(out, conversation.ipv6 ? 16 : 4);
+        out.insert(out.end(), conversation.server, conversation.server + (conversation.ipv6 ? 16 : 4));
+    }
+}
+
+/**
+ * @brief Builds HTTP request or response of about given length.
+ */
+void http_payload(std::vector<uint8_t>& out, Random& random, const flow& conversation, bool from_client, unsigned int length)
+{
+    std::string header;
+
+    if (from_client) {
+        header = "GET /page" + std::to_string(random.below(1000)) + ".html HTTP/1.1\r\n"
+                 "Host: www" + std::to_string(conversation.host) + ".example.com\r\n"
+                 "User-Agent: disspcap-bench/0.1\r\n"
+                 "Accept: */*\r\n";
+
+        if (length > header.size() + 14) {
+            /* grow request by padding header */
+            put(out, header + "X-Padding: ");
+            put_words(out, random, length - header.size() - 15);
+            put(out, "\r\n\r\n");
+            return;
+        }
+
+        put(out, header + "\r\n");
+        return;
+    }
+
+    unsigned int body = length > 96 ? length - 96 : 0;
+    header            = "HTTP/1.1 200 OK\r\n"
+             "Content-Type: text/html\r\n"
+             "Content-Length: " + std::to_string(body) + "\r\n\r\n";
+    put(out, header);
+    put_words(out, random, body);
+}
+
+/**
+ * @brief Builds IRC lines of about given length.
+ */
+void irc_payload(std::vector<uint8_t>& out, Random& random, const flow& conversation, bool from_client, unsigned int length)
+{
+    std::string prefix = from_client ? "PRIVMSG #bench :"
+                                     : ":user" + std::to_string(conversation.client_port) + "!u@example.com PRIVMSG #bench :";
+    unsigned int start = out.size();
+
+    do {
+        unsigned int text = 8 + random.below(72);
+        put(out, prefix);
+        put_words(out, random, text);
+        put(out, "\r\n");
+    } while (out.size() - start < length);
+}
+
+/**
+ * @brief Builds Telnet keystrokes (client) or screen output (server) with commands.
+ */
+void telnet_payload(std::vector<uint8_t>& out, Random& random, bool from_client, unsigned int length)
+{
+    if (random.chance(0.1)) {
+        /* option negotiation - IAC DO/WILL option */
+        out.push_back(TELNET_IAC);
+        out.push_back(from_client ? 251 : 253);
+        out.push_back(random.below(40));
+    }
+
+    if (from_client) {
+        put_words(out, random, 1 + random.below(16));
+        put(out, "\r\n");
+        return;
+    }
+
+    put_words(out, random, length);
+    put(out, "\r\n");
+}
+
+/**
+ * @brief Builds payload of flow packet.
+ */
+void payload(std::vector<uint8_t>& out, Random& random, flow& conversation, bool from_client, unsigned int length)
+{
+    switch (conversation.kind) {
+    case GEN_DNS:
+        dns_payload(out, conversation, from_client);
+        break;
+    case GEN_HTTP:
+        http_payload(out, random, conversation, from_client, length);
+        break;
+    case GEN_IRC:
+        irc_payload(out, random, conversation, from_client, length);
+        break;
+    case GEN_TELNET:
+        telnet_payload(out, random, from_client, length);
+        break;
+    default:
+        for (unsigned int i = 0; i < length; ++i) {
+            out.push_back(random.below(256));
+        }
+    }
+}
+
+/**
+ * @brief Damages payload - random bytes are overwritten or it is cut short.
+ */
+void malform(std::vector<uint8_t>& data, Random& random)
+{
+    if (data.empty()) {
+        return;
+    }
+
+    if (random.chance(0.5)) {
+        data.resize(random.below(data.size()));
+        return;
+    }
+
+    for (unsigned int i = 0, count = 1 + random.below(8); i < count; ++i) {
+        data[random.below(data.size())] = random.below(256);
+    }
+}
+
+/**
+ * @brief Computes IPv4 header checksum.
+ */
+uint16_t ipv4_checksum(const uint8_t* header)
+{
+    uint32_t sum = 0;
+
+    for (unsigned int i = 0; i < 20; i += 2) {
+        sum += (header[i] << 8) | header[i + 1];
+    }
+
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+
+    return ~sum;
+}
+
+/**
+ * @brief Builds whole frame of flow.
+ *
+ * @param frame Output frame.
+ * @param random Generator.
+ * @param conversation Flow.
+ * @param size Target frame size.
+ * @param malformed Payload is damaged.
+ */
+void build_frame(std::vector<uint8_t>& frame, Random& random, flow& conversation, unsigned int size, bool malformed)
+{
+    bool from_client  = conversation.kind == GEN_DNS ? conversation.counter % 2 == 0 : random.chance(0.5);
+    bool tcp          = conversation.kind != GEN_DNS && conversation.kind != GEN_UDP;
+    unsigned int link = conversation.vlan ? 18 : 14;
+    unsigned int ip   = conversation.ipv6 ? 40 : 20;
+    unsigned int l4   = tcp ? 20 : 8;
+    unsigned int head = link + ip + l4;
+    std::vector<uint8_t> data;
+
+    payload(data, random, conversation, from_client, size > head ? size - head : 0);
+
+    if (malformed) {
+        malform(data, random);
+    }
+
+    if (head + data.size() > MAX_FRAME) {
+        data.resize(MAX_FRAME - head);
+    }
+
+    const uint8_t* source      = from_client ? conversation.client : conversation.server;
+    const uint8_t* destination = from_client ? conversation.server : conversation.client;
+    uint16_t source_port       = from_client ? conversation.client_port : conversation.server_port;
+    uint16_t destination_port  = from_client ? conversation.server_port : conversation.client_port;
+
+    frame.clear();
+
+    /* ethernet (locally administered MACs derived from addresses) */
+    for (int side = 0; side < 2; ++side) {
+        const uint8_t* address = side ? source : destination;
+        frame.push_back(0x02);
+        frame.push_back(side);
+        frame.insert(frame.end(), address + (conversation.ipv6 ? 12 : 0), address + (conversation.ipv6 ? 16 : 4));
+    }
+
+    if (conversation.vlan) {
+        put16(frame, ETH_TYPE_VLAN);
+        put16(frame, conversation.vlan);
+    }
+
+    put16(frame, conversation.ipv6 ? ETH_TYPE_IPV6 : ETH_TYPE_IPV4);
+
+    unsigned int l4_length = l4 + data.size();
+    uint8_t protocol       = tcp ? IP_PROTOCOL_TCP : IP_PROTOCOL_UDP;
+
+    if (conversation.ipv6) {
+        put32(frame, 0x60000000);
+        put16(frame, l4_length);
+        frame.push_back(protocol);
+        frame.push_back(64);
+        frame.insert(frame.end(), source, source + 16);
+        frame.insert(frame.end(), destination, destination + 16);
+    } else {
+        unsigned int start = frame.size();
+        frame.push_back(0x45);
+        frame.push_back(0);
+        put16(frame, ip + l4_length);
+        put16(frame, conversation.counter & 0xffff);
+        put16(frame, 0x4000); /* don't fragment */
+        frame.push_back(64);
+        frame.push_back(protocol);
+        put16(frame, 0);
+        frame.insert(frame.end(), source, source + 4);
+        frame.insert(frame.end(), destination, destination + 4);
+
+        uint16_t checksum = ipv4_checksum(&frame[start]);
+        frame[start + 10] = checksum >> 8;
+        frame[start + 11] = checksum & 0xff;
+    }
+
+    put16(frame, source_port);
+    put16(frame, destination_port);
+
+    if (tcp) {
+        uint32_t& seq = conversation.seq[from_client ? 0 : 1];
+        put32(frame, seq);
+        put32(frame, conversation.seq[from_client ? 1 : 0]);
+        frame.push_back(0x50); /* data offset 5 */
+        frame.push_back(0x18); /* PSH, ACK */
+        put16(frame, 65535);
+        put16(frame, 0);
+        put16(frame, 0);
+        seq += data.size();
+    } else {
+        put16(frame, l4_length);
+        put16(frame, 0);
+    }
+
+    frame.insert(frame.end(), data.begin(), data.end());
+
+    if (frame.size() < MIN_FRAME) {
+        frame.resize(MIN_FRAME, 0);
+    }
+
+    ++conversation.counter;
+}
+
+/**
+ * @brief Creates flows, protocols, IPv6 and VLAN are assigned by options.
+ */
+std::vector<flow> make_flows(Random& random, const options& config)
+{
+    std::vector<flow> flows(config.flows);
+
+    for (unsigned int i = 0; i < config.flows; ++i) {
+        flow& conversation = flows[i];
+        unsigned int host  = i % SERVER_COUNT;
+
+        std::memset(&conversation, 0, sizeof(conversation));
+        conversation.kind        = pick(random, config.mix, GEN_KINDS);
+        conversation.ipv6        = random.chance(config.ipv6);
+        conversation.vlan        = random.chance(config.vlan) ? 1 + random.below(4094) : 0;
+        conversation.host        = host;
+        conversation.client_port = 32768 + i % 28000;
+        conversation.server_port = GEN_PORTS[conversation.kind];
+        conversation.seq[0]      = static_cast<uint32_t>(random.next());
+        conversation.seq[1]      = static_cast<uint32_t>(random.next());
+        conversation.dns_id      = random.below(65536);
+
+        if (conversation.ipv6) {
+            /* fd00::/8 unique local addresses, host in last bytes */
+            conversation.client[0]  = 0xfd;
+            conversation.client[1]  = 1;
+            conversation.client[12] = i >> 24;
+            conversation.client[13] = i >> 16;
+            conversation.client[14] = i >> 8;
+            conversation.client[15] = i;
+            conversation.server[0]  = 0xfd;
+            conversation.server[1]  = 2;
+            conversation.server[14] = host >> 8;
+            conversation.server[15] = host;
+        } else {
+            conversation.client[0] = 10;
+            conversation.client[1] = i >> 16;
+            conversation.client[2] = i >> 8;
+            conversation.client[3] = i;
+            conversation.server[0] = 172;
+            conversation.server[1] = 16;
+            conversation.server[2] = host >> 8;
+            conversation.server[3] = host;
+        }
+    }
+
+    return flows;
+}
+
+/**
+ * @brief Writes capture.
+ *
+ * @param config Generator options.
+ * @return uint64_t Number of written bytes (frames only).
+ */
+uint64_t generate(const options& config)
+{
+    FILE* file = std::fopen(config.output.c_str(), "wb");
+
+    if (!file) {
+        throw std::runtime_error("Cannot open " + config.output);
+    }
+
+    /* pcap header in native byte order, microsecond timestamps, Ethernet */
+    uint32_t magic     = 0xa1b2c3d4;
+    uint16_t version[] = { 2, 4 };
+    uint32_t fields[]  = { 0, 0, MAX_FRAME, 1 }; /* zone, sigfigs, snaplen, link type */
+    std::fwrite(&magic, sizeof(magic), 1, file);
+    std::fwrite(version, sizeof(version), 1, file);
+    std::fwrite(fields, sizeof(fields), 1, file);
+
+    Random random(config.seed);
+    std::vector<flow> flows = make_flows(random, config);
+    std::vector<unsigned int> weights;
+    std::vector<uint8_t> frame;
+    uint64_t written = 0;
+
+    for (const auto& size : config.sizes) {
+        weights.push_back(size.second);
+    }
+
+    for (uint64_t i = 0; i < config.packets; ++i) {
+        flow& conversation = flows[random.below(flows.size())];
+        unsigned int size  = config.sizes[pick(random, weights.data(), weights.size())].first;
+
+        build_frame(frame, random, conversation, size, random.chance(config.malformed));
+
+        uint64_t time      = static_cast<uint64_t>(START_TIME) * 1000000 + i * PACKET_SPACING;
+        uint32_t record[4] = { static_cast<uint32_t>(time / 1000000),
+                               static_cast<uint32_t>(time % 1000000),
+                               static_cast<uint32_t>(frame.size()),
+                               static_cast<uint32_t>(frame.size()) };
+        std::fwrite(record, sizeof(record), 1, file);
+        std::fwrite(frame.data(), 1, frame.size(), file);
+        written += frame.size();
+    }
+
+    if (std::fclose(file) != 0) {
+        throw std::runtime_error("Cannot write " + config.output);
+    }
+
+    return written;
+}
+
+/**
+ * @brief Parses list of name:weight pairs.
+ *
+ * @param text List, e.g. "dns:20,http:30".
+ * @return std::vector<std::pair<std::string, unsigned int>> Pairs.
+ */
+std::vector<std::pair<std::string, unsigned int>> parse_weights(const std::string& text)
+{
+    std::vector<std::pair<std::string, unsigned int>> weights;
+    size_t start = 0;
+
+    while (start < text.size()) {
+        size_t end   = text.find(',', start);
+        end          = end == std::string::npos ? text.size() : end;
+        size_t colon = text.find(':', start);
+
+        if (colon == std::string::npos || colon > end) {
+            throw std::invalid_argument("Expected name:weight in " + text);
+        }
+
+        weights.push_back(std::make_pair(text.substr(start, colon - start),
+                                         std::stoul(text.substr(colon + 1, end - colon - 1))));
+        start = end + 1;
+    }
+
+    return weights;
+}
+
+/**
+ * @brief Sets protocol mix.
+ */
+void set_mix(options& config, const std::string& text)
+{
+    std::memset(config.mix, 0, sizeof(config.mix));
+    unsigned int total = 0;
+
+    for (const auto& weight : parse_weights(text)) {
+        unsigned int kind = 0;
+
+        while (kind < GEN_KINDS && weight.first != GEN_NAMES[kind]) {
+            ++kind;
+        }
+
+        if (kind == GEN_KINDS) {
+            throw std::invalid_argument("Unknown protocol " + weight.first);
+        }
+
+        config.mix[kind] = weight.second;
+        total += weight.second;
+    }
+
+    if (!total) {
+        throw std::invalid_argument("Protocol mix is empty");
+    }
+}
+
+/**
+ * @brief Sets frame size distribution.
+ */
+void set_sizes(options& config, const std::string& text)
+{
+    config.sizes.clear();
+
+    for (const auto& weight : parse_weights(text)) {
+        unsigned int size = std::stoul(weight.first);
+
+        if (size < MIN_FRAME || size > MAX_FRAME) {
+            throw std::invalid_argument("Frame size out of range: " + weight.first);
+        }
+
+        config.sizes.push_back(std::make_pair(size, weight.second));
+    }
+
+    if (config.sizes.empty()) {
+        throw std::invalid_argument("Size distribution is empty");
+    }
+}
+
+/**
+ * @brief Parses share (0 - 1).
+ */
+double parse_share(const char* text)
+{
+    double share = std::stod(text);
+
+    if (share < 0 || share > 1) {
+        throw std::invalid_argument(std::string("Share out of range: ") + text);
+    }
+
+    return share;
+}
+
+/**
+ * @brief Prints options.
+ */
+void usage()
+{
+    std::cerr << "Usage: disspcap_generate -o FILE [options]\n"
+                 "  -o, --output FILE      output pcap\n"
+                 "  -n, --packets N        number of packets (1000000)\n"
+                 "  -f, --flows N          number of flows (1024)\n"
+                 "  -s, --seed N           seed (1)\n"
+                 "  -m, --mix LIST         protocol weights (dns:20,http:30,irc:10,telnet:10,tcp:20,udp:10)\n"
+                 "  -z, --sizes LIST       frame size weights (64:7,576:4,1500:1)\n"
+                 "      --vlan SHARE       share of VLAN tagged flows (0.1)\n"
+                 "      --ipv6 SHARE       share of IPv6 flows (0.2)\n"
+                 "      --malformed SHARE  share of damaged packets (0.01)\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    static const struct option long_options[] = {
+        { "output", required_argument, nullptr, 'o' },
+        { "packets", required_argument, nullptr, 'n' },
+        { "flows", required_argument, nullptr, 'f' },
+        { "seed", required_argument, nullptr, 's' },
+        { "mix", required_argument, nullptr, 'm' },
+        { "sizes", required_argument, nullptr, 'z' },
+        { "vlan", required_argument, nullptr, 'v' },
+        { "ipv6", required_argument, nullptr, '6' },
+        { "malformed", required_argument, nullptr, 'x' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    options config;
+    config.packets   = 1000000;
+    config.flows     = 1024;
+    config.seed      = 1;
+    config.vlan      = 0.1;
+    config.ipv6      = 0.2;
+    config.malformed = 0.01;
+
+    try {
+        set_mix(config, "dns:20,http:30,irc:10,telnet:10,tcp:20,udp:10");
+        set_sizes(config, "64:7,576:4,1500:1");
+
+        int option;
+
+        while ((option = getopt_long(argc, argv, "o:n:f:s:m:z:h", long_options, nullptr)) != -1) {
+            switch (option) {
+            case 'o':
+                config.output = optarg;
+                break;
+            case 'n':
+                config.packets = std::stoull(optarg);
+                break;
+            case 'f':
+                config.flows = std::stoul(optarg);
+                break;
+            case 's':
+                config.seed = std::stoull(optarg);
+                break;
+            case 'm':
+                set_mix(config, optarg);
+                break;
+            case 'z':
+                set_sizes(config, optarg);
+                break;
+            case 'v':
+                config.vlan = parse_share(optarg);
+                break;
+            case '6':
+                config.ipv6 = parse_share(optarg);
+                break;
+            case 'x':
+                config.malformed = parse_share(optarg);
+                break;
+            default:
+                usage();
+                return option == 'h' ? 0 : 1;
+            }
+        }
+
+        if (config.output.empty() || !config.flows) {
+            usage();
+            return 1;
+        }
+
+        uint64_t written = generate(config);
+        std::cerr << config.packets << " packets, " << written << " bytes written to " << config.output << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
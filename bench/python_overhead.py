@@ -0,0 +1,188 @@
+"""
+    Measures cost of reading dissected fields from Python
+    (per attribute access) and compares it with C++ baseline
+    (Packet::fields and Packet::summary of build/disspcap_bench).
+
+    Usage: python3 bench/python_overhead.py [pcap or directory ...]
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import time
+
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+repo_path = os.path.dirname(dir_path)
+
+
+def pcap_paths(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for name in sorted(os.listdir(path)):
+                if name.endswith('.pcap'):
+                    yield os.path.join(path, name)
+        else:
+            yield path
+
+
+def load(paths):
+    packets = []
+
+    for path in pcap_paths(paths):
+        pcap = disspcap.Pcap(path)
+        packet = pcap.next_packet()
+
+        while packet:
+            packets.append(packet)
+            packet = pcap.next_packet()
+
+    return packets
+
+
+def read_fields(packet):
+    """Same fields as summary(), layer by layer."""
+    packet.timestamp
+    packet.length
+    packet.payload_length
+    network = packet.ipv4 or packet.ipv6
+
+    if network:
+        network.source
+        network.destination
+
+    transport = packet.tcp or packet.udp
+
+    if transport:
+        transport.source_port
+        transport.destination_port
+
+
+ACCESSES = [
+    ('packet.timestamp', None, lambda p: p.timestamp),
+    ('packet.ipv4', None, lambda p: p.ipv4),
+    ('packet.ipv4.source', lambda p: p.ipv4, lambda p: p.ipv4.source),
+    ('packet.tcp.source_port', lambda p: p.tcp, lambda p: p.tcp.source_port),
+    ('packet.payload', None, lambda p: p.payload),
+    ('packet.http.headers', lambda p: p.http, lambda p: p.http.headers),
+    ("packet.http.header('Host')", lambda p: p.http, lambda p: p.http.header('Host')),
+    ('packet.irc.messages', lambda p: p.irc, lambda p: p.irc.messages),
+    ('packet.irc.message(0)', lambda p: p.irc and len(p.irc), lambda p: p.irc.message(0)),
+    ('fields (layer by layer)', None, read_fields),
+    ('packet.summary()', None, lambda p: p.summary()),
+]
+
+
+def per_call(packets, read, repeat):
+    """Best time of one call in nanoseconds."""
+    best = float('inf')
+
+    for _ in range(repeat):
+        start = time.perf_counter()
+
+        for packet in packets:
+            read(packet)
+
+        best = min(best, time.perf_counter() - start)
+
+    return best / len(packets) * 1e9
+
+
+def whole_capture(paths, repeat):
+    """Reading and dissecting with fields access vs next_summary()."""
+    def by_fields():
+        for path in pcap_paths(paths):
+            pcap = disspcap.Pcap(path)
+            packet = pcap.next_packet(False)
+
+            while packet:
+                read_fields(packet)
+                packet = pcap.next_packet(False)
+
+    def by_summary():
+        for path in pcap_paths(paths):
+            pcap = disspcap.Pcap(path)
+
+            while pcap.next_summary():
+                pass
+
+    results = {}
+
+    for name, run in (('next_packet + fields', by_fields), ('next_summary()', by_summary)):
+        best = float('inf')
+
+        for _ in range(repeat):
+            start = time.perf_counter()
+            run()
+            best = min(best, time.perf_counter() - start)
+
+        results[name] = best
+
+    return results
+
+
+def cpp_baseline(binary, paths):
+    """Nanoseconds per packet of C++ field reads, empty if binary is missing."""
+    if not os.path.exists(binary):
+        return {}
+
+    output = subprocess.run([binary, '--benchmark_filter=^Packet::(fields|summary)$',
+                             '--benchmark_format=json'] + list(paths),
+                            check=True, stdout=subprocess.PIPE).stdout
+    scale = {'ns': 1, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+    return {entry['name']: entry['real_time'] * scale[entry['time_unit']]
+            for entry in json.loads(output)['benchmarks']}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Python binding overhead.')
+    parser.add_argument('paths', nargs='*', default=[f'{repo_path}/tests/pcaps'])
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--cpp', default=f'{repo_path}/build/disspcap_bench',
+                        help='C++ benchmark binary (make bench)')
+    parser.add_argument('--json', help='write results to file')
+    args = parser.parse_args()
+
+    packets = load(args.paths)
+    loop = per_call(packets, lambda p: None, args.repeat)
+    results = {'packets': len(packets), 'loop_ns': loop, 'access_ns': {}}
+
+    print(f'{len(packets)} packets, empty loop {loop:.1f} ns (subtracted)')
+    print(f'{"access":32} {"ns":>10} {"calls":>8}')
+
+    for name, accepts, read in ACCESSES:
+        selected = [p for p in packets if accepts is None or accepts(p)]
+
+        if not selected:
+            print(f'{name:32} {"-":>10} {0:>8}')
+            continue
+
+        cost = per_call(selected, read, args.repeat) - loop
+        results['access_ns'][name] = cost
+        print(f'{name:32} {cost:10.1f} {len(selected):>8}')
+
+    baseline = cpp_baseline(args.cpp, args.paths)
+    results['cpp_ns'] = baseline
+
+    for name, python_name in (('Packet::fields', 'fields (layer by layer)'),
+                              ('Packet::summary', 'packet.summary()')):
+        if name in baseline and python_name in results['access_ns']:
+            cpp = baseline[name]
+            python = results['access_ns'][python_name]
+            print(f'{name:32} {cpp:10.1f} ns in C++, Python {python / cpp:.0f}x')
+
+    results['capture_s'] = whole_capture(args.paths, args.repeat)
+
+    for name, seconds in results['capture_s'].items():
+        print(f'{name:32} {len(packets) / seconds:10.0f} packets/s')
+
+    if args.json:
+        with open(args.json, 'w') as output:
+            json.dump(results, output, indent=2)
+
+
+if __name__ == '__main__':
+    main()
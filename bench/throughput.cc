@@ -0,0 +1,392 @@
+/**
+ * @file throughput.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief End-to-end throughput of reading and dissecting captures.
+ * @version 0.1
+ * @date 2019-06-16
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Usage: disspcap_throughput [options] pcap..., see usage().
+ * Every thread reads and dissects whole capture on its own (as one
+ * capture queue would), reported rates are sums of all threads.
+ * Results are written as JSON.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/packet.h"
+#include "../src/pcap.h"
+#include "../src/prefetch.h"
+
+using namespace disspcap;
+
+namespace {
+
+const char* const BACKENDS[] = { "pcap", "pcap-copy", "prefetch" };
+const unsigned int BACKEND_COUNT = 3;
+
+/**
+ * @brief Totals of one thread.
+ */
+struct totals {
+    uint64_t packets;
+    uint64_t bytes;
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Result of one configuration (best of repetitions).
+ */
+struct result {
+    std::string pcap;
+    std::string backend;
+    unsigned int threads;
+    uint64_t packets;
+    uint64_t bytes;
+    double seconds;
+    long peak_rss_kb;
+};
+
+/**
+ * @brief Reads and dissects whole capture.
+ *
+ * @param path Path to pcap.
+ * @param backend Reader backend (index to BACKENDS).
+ * @param out Totals.
+ */
+void run_reader(const std::string& path, unsigned int backend, totals& out)
+{
+    try {
+        Pcap pcap(path);
+
+        if (backend == 2) {
+            PacketPrefetcher prefetcher(pcap);
+
+            for (auto packet = prefetcher.next_packet(); packet; packet = prefetcher.next_packet()) {
+                ++out.packets;
+                out.bytes += packet->length();
+            }
+
+            return;
+        }
+
+        bool copy = backend == 1;
+
+        for (auto packet = pcap.next_packet(copy); packet; packet = pcap.next_packet(copy)) {
+            ++out.packets;
+            out.bytes += packet->length();
+        }
+    } catch (...) {
+        out.error = std::current_exception();
+    }
+}
+
+/**
+ * @brief Resets peak resident set size of process (Linux only, ignored elsewhere).
+ */
+void reset_peak_rss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+
+    if (clear_refs) {
+        clear_refs << "5";
+    }
+}
+
+/**
+ * @brief Getter of peak resident set size.
+ *
+ * @return long Peak RSS in KiB (since last reset if supported).
+ */
+long peak_rss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stol(line.substr(6));
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief Runs one configuration.
+ *
+ * @param path Path to pcap.
+ * @param backend Reader backend.
+ * @param threads Number of threads.
+ * @param repeat Number of repetitions, fastest one is reported.
+ * @return result Result.
+ */
+result measure(const std::string& path, unsigned int backend, unsigned int threads, unsigned int repeat)
+{
+    result best;
+    best.pcap        = path;
+    best.backend     = BACKENDS[backend];
+    best.threads     = threads;
+    best.seconds     = -1;
+    best.peak_rss_kb = 0;
+
+    for (unsigned int r = 0; r < repeat; ++r) {
+        std::vector<totals> counters(threads, totals{ 0, 0, nullptr });
+        std::vector<std::thread> workers;
+
+        reset_peak_rss();
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = 0; i < threads; ++i) {
+            workers.push_back(std::thread(run_reader, std::cref(path), backend, std::ref(counters[i])));
+        }
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        uint64_t packets                      = 0;
+        uint64_t bytes                        = 0;
+
+        for (const totals& counter : counters) {
+            if (counter.error) {
+                std::rethrow_exception(counter.error);
+            }
+
+            packets += counter.packets;
+            bytes += counter.bytes;
+        }
+
+        best.peak_rss_kb = std::max(best.peak_rss_kb, peak_rss());
+
+        if (best.seconds < 0 || elapsed.count() < best.seconds) {
+            best.seconds = elapsed.count();
+            best.packets = packets;
+            best.bytes   = bytes;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Escapes string for JSON.
+ */
+std::string json_string(const std::string& text)
+{
+    std::string escaped = "\"";
+
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            escaped += buf;
+        } else {
+            escaped += c;
+        }
+    }
+
+    return escaped + "\"";
+}
+
+/**
+ * @brief Writes results as JSON.
+ *
+ * @param out Output stream.
+ * @param results Results.
+ */
+void write_json(std::ostream& out, const std::vector<result>& results)
+{
+    char date[32];
+    char host[256] = "";
+    std::time_t now = std::time(nullptr);
+
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    gethostname(host, sizeof(host) - 1);
+
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"date\": " << json_string(date) << ",\n"
+        << "    \"host\": " << json_string(host) << ",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+        << "  },\n"
+        << "  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const result& entry = results[i];
+        double pps          = entry.seconds > 0 ? entry.packets / entry.seconds : 0;
+        double gbps         = entry.seconds > 0 ? entry.bytes * 8 / entry.seconds / 1e9 : 0;
+
+        out << (i ? "," : "") << "\n    {"
+            << "\"pcap\": " << json_string(entry.pcap) << ", "
+            << "\"backend\": " << json_string(entry.backend) << ", "
+            << "\"threads\": " << entry.threads << ", "
+            << "\"packets\": " << entry.packets << ", "
+            << "\"bytes\": " << entry.bytes << ", "
+            << "\"seconds\": " << entry.seconds << ", "
+            << "\"pps\": " << pps << ", "
+            << "\"gbps\": " << gbps << ", "
+            << "\"peak_rss_kb\": " << entry.peak_rss_kb << "}";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+/**
+ * @brief Parses comma separated list of numbers.
+ */
+std::vector<unsigned int> parse_list(const std::string& text)
+{
+    std::vector<unsigned int> values;
+    std::stringstream stream(text);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        unsigned int value = std::stoul(item);
+
+        if (!value) {
+            throw std::invalid_argument("Thread count must be positive");
+        }
+
+        values.push_back(value);
+    }
+
+    return values;
+}
+
+/**
+ * @brief Parses backend name (or "all").
+ */
+std::vector<unsigned int> parse_backends(const std::string& text)
+{
+    std::vector<unsigned int> backends;
+    std::stringstream stream(text);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        size_t known = backends.size();
+
+        for (unsigned int i = 0; i < BACKEND_COUNT; ++i) {
+            if (item == "all" || item == BACKENDS[i]) {
+                backends.push_back(i);
+            }
+        }
+
+        if (backends.size() == known) {
+            throw std::invalid_argument("Unknown backend " + item);
+        }
+    }
+
+    return backends;
+}
+
+/**
+ * @brief Prints options.
+ */
+void usage()
+{
+    std::cerr << "Usage: disspcap_throughput [options] pcap...\n"
+                 "  -b, --backends LIST  pcap, pcap-copy, prefetch or all (all)\n"
+                 "  -t, --threads LIST   thread counts (1,2,4)\n"
+                 "  -r, --repeat N       repetitions, fastest is reported (3)\n"
+                 "  -o, --output FILE    JSON output (stdout)\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    static const struct option long_options[] = {
+        { "backends", required_argument, nullptr, 'b' },
+        { "threads", required_argument, nullptr, 't' },
+        { "repeat", required_argument, nullptr, 'r' },
+        { "output", required_argument, nullptr, 'o' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    try {
+        std::vector<unsigned int> backends = parse_backends("all");
+        std::vector<unsigned int> threads  = parse_list("1,2,4");
+        unsigned int repeat                = 3;
+        std::string output;
+        int option;
+
+        while ((option = getopt_long(argc, argv, "b:t:r:o:h", long_options, nullptr)) != -1) {
+            switch (option) {
+            case 'b':
+                backends = parse_backends(optarg);
+                break;
+            case 't':
+                threads = parse_list(optarg);
+                break;
+            case 'r':
+                repeat = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                usage();
+                return option == 'h' ? 0 : 1;
+            }
+        }
+
+        if (optind == argc) {
+            usage();
+            return 1;
+        }
+
+        std::vector<result> results;
+
+        for (int i = optind; i < argc; ++i) {
+            for (unsigned int backend : backends) {
+                for (unsigned int count : threads) {
+                    results.push_back(measure(argv[i], backend, count, repeat));
+                    const result& last = results.back();
+                    std::cerr << last.pcap << " " << last.backend << " x" << last.threads << ": "
+                              << last.packets / last.seconds << " pps" << std::endl;
+                }
+            }
+        }
+
+        if (output.empty()) {
+            write_json(std::cout, results);
+        } else {
+            std::ofstream file(output);
+
+            if (!file) {
+                throw std::runtime_error("Cannot open " + output);
+            }
+
+            write_json(file, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -41,6 +41,7 @@ ext_modules = [
         sources=[
             'src/python_module.cc',
             'src/pcap.cc',
+            'src/live_capture.cc',
             'src/packet.cc',
             'src/ethernet.cc',
             'src/ipv4.cc',
@@ -48,10 +49,23 @@ ext_modules = [
             'src/tcp.cc',
             'src/udp.cc',
             'src/dns.cc',
+            'src/dns_tracker.cc',
+            'src/reassembly.cc',
+            'src/decap.cc',
             'src/http.cc',
+            'src/scan.cc',
             'src/irc.cc',
             'src/telnet.cc',
-            'src/common.cc'
+            'src/common.cc',
+            'src/flow.cc',
+            'src/histogram.cc',
+            'src/http_tracker.cc',
+            'src/telnet_tracker.cc',
+            'src/session.cc',
+            'src/topk.cc',
+            'src/cardinality.cc',
+            'src/columnar.cc',
+            'src/prefetch.cc'
         ],
         include_dirs=[
             # Path to pybind11 headers
@@ -131,7 +145,7 @@ setup(
     long_description=long_description,
     long_description_content_type='text/x-rst',
     ext_modules=ext_modules,
-    install_requires=['pybind11>=2.2'],
+    install_requires=['pybind11>=2.6'],
     cmdclass={'build_ext': BuildExt},
     zip_safe=False,
     classifiers=[
@@ -0,0 +1,408 @@
+/**
+ * @file cardinality.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Distinct value counting (HyperLogLog).
+ * @version 0.1
+ * @date 2019-06-03
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * Flajolet et al., HyperLogLog: the analysis of a near-optimal cardinality estimation algorithm
+ * Heule et al., HyperLogLog in Practice
+ */
+
+#include "cardinality.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "common.h"
+#include "flow.h"
+
+namespace disspcap {
+
+/**
+ * @brief Construct a new HyperLogLog::HyperLogLog object.
+ *
+ * @param precision Number of index bits (clamped to 4..18), uses 2^precision bytes.
+ */
+HyperLogLog::HyperLogLog(uint8_t precision)
+    : precision_{ std::min(std::max(precision, HLL_MIN_PRECISION), HLL_MAX_PRECISION) }
+    , registers_(1u << this->precision_, 0)
+{
+}
+
+/**
+ * @brief Adds binary key.
+ *
+ * @param key Binary key.
+ * @param length Key length.
+ */
+void HyperLogLog::add(const void* key, unsigned int length)
+{
+    this->add_hash(hash_bytes(key, length));
+}
+
+/**
+ * @brief Adds binary key.
+ *
+ * @param key Binary key.
+ */
+void HyperLogLog::add(const std::string& key)
+{
+    this->add_hash(hash_bytes(key.data(), key.size()));
+}
+
+/**
+ * @brief Adds already hashed key.
+ *
+ * First precision bits select register, position of first set bit
+ * of remaining ones is the rank kept in it.
+ *
+ * @param hash 64-bit hash of key.
+ */
+void HyperLogLog::add_hash(uint64_t hash)
+{
+    unsigned int index = hash >> (64 - this->precision_);
+    uint64_t rest      = hash << this->precision_;
+    uint8_t rank       = rest ? __builtin_clzll(rest) + 1 : 64 - this->precision_ + 1;
+
+    if (rank > this->registers_[index]) {
+        this->registers_[index] = rank;
+    }
+}
+
+/**
+ * @brief Adds field of packet.
+ *
+ * @param packet Packet.
+ * @param field FIELD_* value.
+ * @return true Packet has field.
+ * @return false Otherwise.
+ */
+bool HyperLogLog::add_packet(const Packet& packet, uint8_t field)
+{
+    uint8_t key[FIELD_MAX_LEN];
+    unsigned int length = packet_field(packet, field, key);
+
+    if (!length) {
+        return false;
+    }
+
+    this->add(key, length);
+
+    return true;
+}
+
+/**
+ * @brief Merges other sketch - result counts union of both.
+ *
+ * @param other Sketch of same precision.
+ */
+void HyperLogLog::merge(const HyperLogLog& other)
+{
+    if (other.precision_ != this->precision_) {
+        throw std::invalid_argument("HyperLogLog precisions differ.");
+    }
+
+    for (unsigned int i = 0; i < this->registers_.size(); ++i) {
+        this->registers_[i] = std::max(this->registers_[i], other.registers_[i]);
+    }
+}
+
+/**
+ * @brief Forgets all keys.
+ */
+void HyperLogLog::clear()
+{
+    std::fill(this->registers_.begin(), this->registers_.end(), 0);
+}
+
+/**
+ * @brief Estimates number of distinct keys.
+ *
+ * Small cardinalities use linear counting of empty registers.
+ *
+ * @return uint64_t Estimated number of distinct keys.
+ */
+uint64_t HyperLogLog::estimate() const
+{
+    double m           = this->registers_.size();
+    double sum         = 0;
+    unsigned int zeros = 0;
+
+    for (uint8_t rank : this->registers_) {
+        sum += std::ldexp(1.0, -rank);
+        zeros += rank == 0;
+    }
+
+    double alpha;
+
+    switch (this->registers_.size()) {
+    case 16:
+        alpha = 0.673;
+        break;
+    case 32:
+        alpha = 0.697;
+        break;
+    case 64:
+        alpha = 0.709;
+        break;
+    default:
+        alpha = 0.7213 / (1 + 1.079 / m);
+    }
+
+    double estimate = alpha * m * m / sum;
+
+    if (estimate <= 2.5 * m && zeros) {
+        estimate = m * std::log(m / zeros);
+    }
+
+    return std::llround(estimate);
+}
+
+/**
+ * @brief Getter of standard error of estimate.
+ *
+ * @return double Relative standard error (e.g. 0.016).
+ */
+double HyperLogLog::relative_error() const
+{
+    return 1.04 / std::sqrt(static_cast<double>(this->registers_.size()));
+}
+
+/**
+ * @brief Getter of precision.
+ *
+ * @return uint8_t Number of index bits.
+ */
+uint8_t HyperLogLog::precision() const
+{
+    return this->precision_;
+}
+
+/**
+ * @brief Construct a new CardinalitySeries::CardinalitySeries object.
+ *
+ * @param interval Bucket length (seconds).
+ * @param precision Precision of bucket sketches.
+ * @param max_buckets Number of newest buckets kept.
+ */
+CardinalitySeries::CardinalitySeries(double interval, uint8_t precision, unsigned int max_buckets)
+    : interval_{ interval > 0 ? interval : 60 }
+    , precision_{ precision }
+    , max_buckets_{ max_buckets ? max_buckets : 1 }
+{
+}
+
+/**
+ * @brief Adds binary key seen at given time.
+ *
+ * Keys older than kept buckets are ignored.
+ *
+ * @param timestamp Time (seconds since epoch).
+ * @param key Binary key.
+ * @param length Key length.
+ */
+void CardinalitySeries::add(double timestamp, const void* key, unsigned int length)
+{
+    HyperLogLog* sketch = this->bucket(static_cast<int64_t>(std::floor(timestamp / this->interval_)));
+
+    if (sketch) {
+        sketch->add(key, length);
+    }
+}
+
+/**
+ * @brief Adds binary key seen at given time.
+ *
+ * @param timestamp Time (seconds since epoch).
+ * @param key Binary key.
+ */
+void CardinalitySeries::add(double timestamp, const std::string& key)
+{
+    this->add(timestamp, key.data(), key.size());
+}
+
+/**
+ * @brief Adds field of packet at its capture time.
+ *
+ * @param packet Packet.
+ * @param field FIELD_* value.
+ * @return true Packet has field.
+ * @return false Otherwise.
+ */
+bool CardinalitySeries::add_packet(const Packet& packet, uint8_t field)
+{
+    uint8_t key[FIELD_MAX_LEN];
+    unsigned int length = packet_field(packet, field, key);
+
+    if (!length) {
+        return false;
+    }
+
+    this->add(packet.timestamp(), key, length);
+
+    return true;
+}
+
+/**
+ * @brief Merges other series bucket by bucket.
+ *
+ * @param other Series of same interval and precision.
+ */
+void CardinalitySeries::merge(const CardinalitySeries& other)
+{
+    if (other.interval_ != this->interval_ || other.precision_ != this->precision_) {
+        throw std::invalid_argument("Series intervals or precisions differ.");
+    }
+
+    for (const auto& bucket : other.buckets_) {
+        HyperLogLog* sketch = this->bucket(bucket.first);
+
+        if (sketch) {
+            sketch->merge(bucket.second);
+        }
+    }
+}
+
+/**
+ * @brief Drops all buckets.
+ */
+void CardinalitySeries::clear()
+{
+    this->buckets_.clear();
+}
+
+/**
+ * @brief Returns estimates of all kept buckets.
+ *
+ * @return std::vector<std::pair<double, uint64_t>> Bucket start time and estimate, oldest first.
+ */
+std::vector<std::pair<double, uint64_t>> CardinalitySeries::series() const
+{
+    std::vector<std::pair<double, uint64_t>> series;
+    series.reserve(this->buckets_.size());
+
+    for (const auto& bucket : this->buckets_) {
+        series.push_back(std::make_pair(bucket.first * this->interval_, bucket.second.estimate()));
+    }
+
+    return series;
+}
+
+/**
+ * @brief Estimates distinct keys over time range (union of its buckets).
+ *
+ * @param begin Range begin (seconds since epoch).
+ * @param end Range end (exclusive).
+ * @return uint64_t Estimated number of distinct keys.
+ */
+uint64_t CardinalitySeries::estimate(double begin, double end) const
+{
+    HyperLogLog total(this->precision_);
+
+    auto it = this->buckets_.lower_bound(static_cast<int64_t>(std::floor(begin / this->interval_)));
+
+    for (; it != this->buckets_.end() && it->first * this->interval_ < end; ++it) {
+        total.merge(it->second);
+    }
+
+    return total.estimate();
+}
+
+/**
+ * @brief Getter of bucket length.
+ *
+ * @return double Interval (seconds).
+ */
+double CardinalitySeries::interval() const
+{
+    return this->interval_;
+}
+
+/**
+ * @brief Returns sketch of bucket, creates it if needed.
+ *
+ * @param index Bucket index (start time / interval).
+ * @return HyperLogLog* Sketch, nullptr if bucket is older than kept ones.
+ */
+HyperLogLog* CardinalitySeries::bucket(int64_t index)
+{
+    auto it = this->buckets_.find(index);
+
+    if (it != this->buckets_.end()) {
+        return &it->second;
+    }
+
+    if (this->buckets_.size() >= this->max_buckets_) {
+        if (index < this->buckets_.begin()->first) {
+            return nullptr;
+        }
+
+        this->buckets_.erase(this->buckets_.begin());
+    }
+
+    return &this->buckets_.insert(std::make_pair(index, HyperLogLog(this->precision_))).first->second;
+}
+
+/**
+ * @brief Extracts binary key of packet field.
+ *
+ * Addresses are in network byte order (4 or 16 bytes), flows are
+ * flow_key structures, DNS names are uncompressed dotted names.
+ *
+ * @param packet Packet.
+ * @param field FIELD_* value.
+ * @param key Buffer of FIELD_MAX_LEN bytes.
+ * @return unsigned int Key length, 0 if packet does not have field.
+ */
+unsigned int packet_field(const Packet& packet, uint8_t field, uint8_t* key)
+{
+    switch (field) {
+    case FIELD_SOURCE:
+    case FIELD_DESTINATION:
+        if (packet.ipv4()) {
+            uint32_t address = field == FIELD_SOURCE ? packet.ipv4()->raw_source() : packet.ipv4()->raw_destination();
+            std::memcpy(key, &address, sizeof(address));
+            return sizeof(address);
+        }
+
+        if (packet.ipv6()) {
+            std::memcpy(key, field == FIELD_SOURCE ? packet.ipv6()->raw_source() : packet.ipv6()->raw_destination(),
+                        IPV6_ADDR_LEN);
+            return IPV6_ADDR_LEN;
+        }
+
+        return 0;
+    case FIELD_FLOW: {
+        flow_key flow;
+
+        if (!make_flow_key(packet, flow)) {
+            return 0;
+        }
+
+        std::memcpy(key, &flow, sizeof(flow));
+        return sizeof(flow);
+    }
+    case FIELD_DNS_NAME: {
+        const DNS* dns = packet.dns();
+
+        if (!dns || dns->records().empty() || dns->records()[0].section != DNS_SECTION_QUESTION) {
+            return 0;
+        }
+
+        std::string name    = dns->name(dns->records()[0]);
+        unsigned int length = std::min<unsigned int>(name.size(), FIELD_MAX_LEN);
+
+        std::memcpy(key, name.data(), length);
+        return length;
+    }
+    default:
+        return 0;
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/**
+ * @file cardinality.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Distinct value counting (HyperLogLog).
+ * @version 0.1
+ * @date 2019-06-03
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * Flajolet et al., HyperLogLog: the analysis of a near-optimal cardinality estimation algorithm
+ * Heule et al., HyperLogLog in Practice
+ */
+
+#ifndef DISSPCAP_CARDINALITY_H
+#define DISSPCAP_CARDINALITY_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "packet.h"
+
+namespace disspcap {
+
+const uint8_t HLL_PRECISION     = 12; /**< Default precision - 4096 registers, ~1.6 % error. */
+const uint8_t HLL_MIN_PRECISION = 4;  /**< Minimal precision. */
+const uint8_t HLL_MAX_PRECISION = 18; /**< Maximal precision. */
+
+const unsigned int HLL_MAX_BUCKETS = 1440; /**< Default number of kept series buckets. */
+
+const unsigned int FIELD_MAX_LEN = 256; /**< Maximal length of packet field key. */
+
+const uint8_t FIELD_SOURCE      = 0; /**< Source IP address. */
+const uint8_t FIELD_DESTINATION = 1; /**< Destination IP address. */
+const uint8_t FIELD_FLOW        = 2; /**< Binary 5-tuple (flow_key). */
+const uint8_t FIELD_DNS_NAME    = 3; /**< Name of first DNS question. */
+
+/**
+ * @brief HyperLogLog sketch of distinct binary keys.
+ *
+ * Memory is 2^precision bytes regardless of number of distinct keys.
+ * Sketches of same precision can be merged (e.g. from threads or files).
+ */
+class HyperLogLog {
+public:
+    HyperLogLog(uint8_t precision = HLL_PRECISION);
+    void add(const void* key, unsigned int length);
+    void add(const std::string& key);
+    void add_hash(uint64_t hash);
+    bool add_packet(const Packet& packet, uint8_t field);
+    void merge(const HyperLogLog& other);
+    void clear();
+    uint64_t estimate() const;
+    double relative_error() const;
+    uint8_t precision() const;
+
+private:
+    uint8_t precision_;
+    std::vector<uint8_t> registers_;
+};
+
+/**
+ * @brief Distinct keys per time interval.
+ *
+ * Every interval has its own HyperLogLog, only the newest max_buckets
+ * intervals are kept.
+ */
+class CardinalitySeries {
+public:
+    CardinalitySeries(double interval          = 60,
+                      uint8_t precision        = HLL_PRECISION,
+                      unsigned int max_buckets = HLL_MAX_BUCKETS);
+    void add(double timestamp, const void* key, unsigned int length);
+    void add(double timestamp, const std::string& key);
+    bool add_packet(const Packet& packet, uint8_t field);
+    void merge(const CardinalitySeries& other);
+    void clear();
+    std::vector<std::pair<double, uint64_t>> series() const;
+    uint64_t estimate(double begin, double end) const;
+    double interval() const;
+
+private:
+    double interval_;
+    uint8_t precision_;
+    unsigned int max_buckets_;
+    std::map<int64_t, HyperLogLog> buckets_;
+    HyperLogLog* bucket(int64_t index);
+};
+
+unsigned int packet_field(const Packet& packet, uint8_t field, uint8_t* key);
+}
+
+#endif
\ No newline at end of file
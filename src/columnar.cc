@@ -0,0 +1,746 @@
+/**
+ * @file columnar.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Columnar (Arrow C data interface) export of dissected packets.
+ * @version 0.1
+ * @date 2019-06-10
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * https://arrow.apache.org/docs/format/CDataInterface.html
+ * https://arrow.apache.org/docs/format/CDataInterface/PyCapsuleInterface.html
+ */
+
+#include "columnar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "cardinality.h"
+#include "flow.h"
+
+namespace disspcap {
+
+/**
+ * @brief Private data of exported array - keeps column buffers alive.
+ */
+struct array_node {
+    std::shared_ptr<batch_columns> columns;
+    std::vector<const void*> buffers;
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> child_pointers;
+    ArrowArray dictionary;
+};
+
+/**
+ * @brief Private data of exported schema.
+ */
+struct schema_node {
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> child_pointers;
+    ArrowSchema dictionary;
+};
+
+/**
+ * @brief Release callback of exported array.
+ *
+ * Children and dictionary which were not moved by consumer are released too.
+ *
+ * @param array Array.
+ */
+static void release_array(ArrowArray* array)
+{
+    array_node* node = static_cast<array_node*>(array->private_data);
+
+    for (ArrowArray* child : node->child_pointers) {
+        if (child->release) {
+            child->release(child);
+        }
+    }
+
+    if (array->dictionary && array->dictionary->release) {
+        array->dictionary->release(array->dictionary);
+    }
+
+    delete node;
+    array->release = nullptr;
+}
+
+/**
+ * @brief Release callback of exported schema.
+ *
+ * @param schema Schema.
+ */
+static void release_schema(ArrowSchema* schema)
+{
+    schema_node* node = static_cast<schema_node*>(schema->private_data);
+
+    for (ArrowSchema* child : node->child_pointers) {
+        if (child->release) {
+            child->release(child);
+        }
+    }
+
+    if (schema->dictionary && schema->dictionary->release) {
+        schema->dictionary->release(schema->dictionary);
+    }
+
+    delete node;
+    schema->release = nullptr;
+}
+
+/**
+ * @brief Fills exported array sharing given buffers.
+ *
+ * @param array Array to fill.
+ * @param columns Owner of buffers.
+ * @param length Number of elements.
+ * @param null_count Number of nulls.
+ * @param buffers Buffer pointers (validity first).
+ * @param n_children Number of children (filled by caller).
+ * @return array_node* Private data of array.
+ */
+static array_node* make_array(ArrowArray* array,
+                              const std::shared_ptr<batch_columns>& columns,
+                              int64_t length,
+                              int64_t null_count,
+                              std::vector<const void*> buffers,
+                              unsigned int n_children = 0)
+{
+    array_node* node = new array_node;
+
+    node->columns = columns;
+    node->buffers = std::move(buffers);
+    node->children.resize(n_children);
+
+    for (ArrowArray& child : node->children) {
+        node->child_pointers.push_back(&child);
+    }
+
+    array->length       = length;
+    array->null_count   = null_count;
+    array->offset       = 0;
+    array->n_buffers    = node->buffers.size();
+    array->n_children   = n_children;
+    array->buffers      = node->buffers.data();
+    array->children     = n_children ? node->child_pointers.data() : nullptr;
+    array->dictionary   = nullptr;
+    array->release      = release_array;
+    array->private_data = node;
+
+    return node;
+}
+
+/**
+ * @brief Fills exported schema.
+ *
+ * @param schema Schema to fill.
+ * @param format Arrow format string.
+ * @param name Field name.
+ * @param flags ARROW_FLAG_* values.
+ * @param n_children Number of children (filled by caller).
+ * @return schema_node* Private data of schema.
+ */
+static schema_node* make_schema(ArrowSchema* schema,
+                                const char* format,
+                                const char* name,
+                                int64_t flags,
+                                unsigned int n_children = 0)
+{
+    schema_node* node = new schema_node;
+
+    node->format = format;
+    node->name   = name;
+    node->children.resize(n_children);
+
+    for (ArrowSchema& child : node->children) {
+        node->child_pointers.push_back(&child);
+    }
+
+    schema->format       = node->format.c_str();
+    schema->name         = node->name.c_str();
+    schema->metadata     = nullptr;
+    schema->flags        = flags;
+    schema->n_children   = n_children;
+    schema->children     = n_children ? node->child_pointers.data() : nullptr;
+    schema->dictionary   = nullptr;
+    schema->release      = release_schema;
+    schema->private_data = node;
+
+    return node;
+}
+
+/**
+ * @brief Appends validity bit.
+ *
+ * @param validity Bitmap.
+ * @param index Element index.
+ * @param valid Element is not null.
+ */
+static void append_bit(validity_bitmap& validity, int64_t index, bool valid)
+{
+    if (index % 8 == 0) {
+        validity.bits.push_back(0);
+    }
+
+    if (valid) {
+        validity.bits.back() |= 1 << (index % 8);
+    } else {
+        ++validity.null_count;
+    }
+}
+
+/**
+ * @brief Returns validity buffer for export (none if there are no nulls).
+ *
+ * @param validity Bitmap.
+ * @return const void* Buffer or nullptr.
+ */
+static const void* validity_buffer(const validity_bitmap& validity)
+{
+    return validity.null_count ? validity.bits.data() : nullptr;
+}
+
+/**
+ * @brief Appends null string.
+ *
+ * @param column Dictionary column.
+ * @param index Element index.
+ */
+static void append_null(dictionary_column& column, int64_t index)
+{
+    append_bit(column.validity, index, false);
+    column.indices.push_back(0);
+}
+
+/**
+ * @brief Appends string identified by binary key.
+ *
+ * @param column Dictionary column.
+ * @param index Element index.
+ * @param key Binary key of value.
+ * @param render Returns string value, called only for new keys.
+ */
+template <typename Render>
+static void append_value(dictionary_column& column, int64_t index, const std::string& key, Render render)
+{
+    auto it = column.ids.find(key);
+
+    if (it == column.ids.end()) {
+        std::string value = render();
+        int32_t id        = column.offsets.size() - 1;
+
+        column.data += value;
+        column.offsets.push_back(column.data.size());
+        it = column.ids.insert(std::make_pair(key, id)).first;
+    }
+
+    append_bit(column.validity, index, true);
+    column.indices.push_back(it->second);
+}
+
+/**
+ * @brief Exports dictionary column.
+ *
+ * @param array Array to fill.
+ * @param columns Owner of buffers.
+ * @param column Dictionary column.
+ * @param length Number of elements.
+ */
+static void export_dictionary(ArrowArray* array,
+                              const std::shared_ptr<batch_columns>& columns,
+                              const dictionary_column& column,
+                              int64_t length)
+{
+    array_node* node = make_array(array, columns, length, column.validity.null_count,
+                                  { validity_buffer(column.validity), column.indices.data() });
+
+    make_array(&node->dictionary, columns, column.offsets.size() - 1, 0,
+               { nullptr, column.offsets.data(), column.data.data() });
+    array->dictionary = &node->dictionary;
+}
+
+/**
+ * @brief Exports dictionary column schema.
+ *
+ * @param schema Schema to fill.
+ * @param name Field name.
+ */
+static void export_dictionary_schema(ArrowSchema* schema, const char* name)
+{
+    schema_node* node = make_schema(schema, "i", name, ARROW_FLAG_NULLABLE);
+
+    make_schema(&node->dictionary, "u", "", 0);
+    schema->dictionary = &node->dictionary;
+}
+
+/**
+ * @brief Creates empty columns.
+ *
+ * @return std::shared_ptr<batch_columns> Columns.
+ */
+static std::shared_ptr<batch_columns> empty_columns()
+{
+    std::shared_ptr<batch_columns> columns = std::make_shared<batch_columns>();
+    dictionary_column* dictionaries[]      = { &columns->source, &columns->destination, &columns->dns_qname,
+                                          &columns->http_host, &columns->http_uri };
+
+    columns->length                       = 0;
+    columns->protocol_validity.null_count = 0;
+    columns->port_validity.null_count     = 0;
+
+    for (dictionary_column* column : dictionaries) {
+        column->validity.null_count = 0;
+        column->offsets.push_back(0);
+    }
+
+    return columns;
+}
+
+/**
+ * @brief Construct a new PacketBatch::PacketBatch object.
+ */
+PacketBatch::PacketBatch()
+    : columns_{ empty_columns() }
+{
+}
+
+/**
+ * @brief Appends summary of packet as one row.
+ *
+ * @param packet Dissected packet.
+ */
+void PacketBatch::append(const Packet& packet)
+{
+    batch_columns& columns = this->writable();
+    int64_t index          = columns.length;
+    uint8_t key[FIELD_MAX_LEN];
+    unsigned int length;
+
+    columns.timestamp.push_back(std::llround(packet.timestamp() * 1e6));
+    columns.packet_length.push_back(packet.length());
+
+    /* addresses are rendered once per distinct value */
+    dictionary_column* addresses[] = { &columns.source, &columns.destination };
+    uint8_t fields[]               = { FIELD_SOURCE, FIELD_DESTINATION };
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        if ((length = packet_field(packet, fields[i], key))) {
+            this->key_.assign(reinterpret_cast<char*>(key), length);
+            append_value(*addresses[i], index, this->key_,
+                         [&]() { return str_address(length == IPV6_ADDR_LEN ? 6 : 4, key); });
+        } else {
+            append_null(*addresses[i], index);
+        }
+    }
+
+    uint8_t protocol = 0;
+
+    if (packet.ipv4()) {
+        protocol = packet.ipv4()->protocol_number();
+    } else if (packet.ipv6()) {
+        protocol = packet.ipv6()->next_header_number();
+    }
+
+    append_bit(columns.protocol_validity, index, packet.ipv4() || packet.ipv6());
+    columns.protocol.push_back(protocol);
+
+    uint16_t source_port      = 0;
+    uint16_t destination_port = 0;
+
+    if (packet.tcp()) {
+        source_port      = packet.tcp()->source_port();
+        destination_port = packet.tcp()->destination_port();
+    } else if (packet.udp()) {
+        source_port      = packet.udp()->source_port();
+        destination_port = packet.udp()->destination_port();
+    }
+
+    append_bit(columns.port_validity, index, packet.tcp() || packet.udp());
+    columns.source_port.push_back(source_port);
+    columns.destination_port.push_back(destination_port);
+
+    if ((length = packet_field(packet, FIELD_DNS_NAME, key))) {
+        this->key_.assign(reinterpret_cast<char*>(key), length);
+        append_value(columns.dns_qname, index, this->key_, [&]() { return this->key_; });
+    } else {
+        append_null(columns.dns_qname, index);
+    }
+
+    const HTTP* http = packet.http();
+
+    if (http && http->is_request()) {
+        const http_header* host = http->find_header(HTTP_HOST);
+
+        if (host) {
+            this->key_.assign(host->value, host->value_length);
+            append_value(columns.http_host, index, this->key_, [&]() { return this->key_; });
+        } else {
+            append_null(columns.http_host, index);
+        }
+
+        append_value(columns.http_uri, index, http->request_uri(), [&]() { return http->request_uri(); });
+    } else {
+        append_null(columns.http_host, index);
+        append_null(columns.http_uri, index);
+    }
+
+    ++columns.length;
+}
+
+/**
+ * @brief Dissects packets of pcap into batch.
+ *
+ * @param pcap Opened pcap.
+ * @param max_packets Maximum number of packets (0 - until end of file).
+ * @return unsigned int Number of appended packets.
+ */
+unsigned int PacketBatch::read(Pcap& pcap, unsigned int max_packets)
+{
+    unsigned int count = 0;
+    std::unique_ptr<Packet> packet;
+
+    while ((!max_packets || count < max_packets) && (packet = pcap.next_packet()) != nullptr) {
+        this->append(*packet);
+        ++count;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Drops all rows.
+ */
+void PacketBatch::clear()
+{
+    this->columns_ = empty_columns();
+}
+
+/**
+ * @brief Getter of number of rows.
+ *
+ * @return unsigned int Number of packets.
+ */
+unsigned int PacketBatch::size() const
+{
+    return this->columns_->length;
+}
+
+/**
+ * @brief Exports batch as Arrow struct array (record batch).
+ *
+ * Buffers are shared, not copied - they live until consumer releases
+ * array, even if batch is destroyed.
+ *
+ * @param array Filled with exported array (consumer releases it).
+ * @param schema Filled with exported schema (consumer releases it).
+ */
+void PacketBatch::export_batch(struct ArrowArray* array, struct ArrowSchema* schema) const
+{
+    const std::shared_ptr<batch_columns>& columns = this->columns_;
+    int64_t length                                = columns->length;
+
+    array_node* node = make_array(array, columns, length, 0, { nullptr }, 10);
+    ArrowArray* c    = node->children.data();
+
+    make_array(&c[0], columns, length, 0, { nullptr, columns->timestamp.data() });
+    make_array(&c[1], columns, length, 0, { nullptr, columns->packet_length.data() });
+    export_dictionary(&c[2], columns, columns->source, length);
+    export_dictionary(&c[3], columns, columns->destination, length);
+    make_array(&c[4], columns, length, columns->protocol_validity.null_count,
+               { validity_buffer(columns->protocol_validity), columns->protocol.data() });
+    make_array(&c[5], columns, length, columns->port_validity.null_count,
+               { validity_buffer(columns->port_validity), columns->source_port.data() });
+    make_array(&c[6], columns, length, columns->port_validity.null_count,
+               { validity_buffer(columns->port_validity), columns->destination_port.data() });
+    export_dictionary(&c[7], columns, columns->dns_qname, length);
+    export_dictionary(&c[8], columns, columns->http_host, length);
+    export_dictionary(&c[9], columns, columns->http_uri, length);
+
+    this->export_schema(schema);
+}
+
+/**
+ * @brief Exports schema of batch.
+ *
+ * @param schema Filled with exported schema (consumer releases it).
+ */
+void PacketBatch::export_schema(struct ArrowSchema* schema) const
+{
+    schema_node* node = make_schema(schema, "+s", "", 0, 10);
+    ArrowSchema* c    = node->children.data();
+
+    make_schema(&c[0], "tsu:UTC", "timestamp", 0);
+    make_schema(&c[1], "I", "length", 0);
+    export_dictionary_schema(&c[2], "source");
+    export_dictionary_schema(&c[3], "destination");
+    make_schema(&c[4], "C", "protocol", ARROW_FLAG_NULLABLE);
+    make_schema(&c[5], "S", "source_port", ARROW_FLAG_NULLABLE);
+    make_schema(&c[6], "S", "destination_port", ARROW_FLAG_NULLABLE);
+    export_dictionary_schema(&c[7], "dns_qname");
+    export_dictionary_schema(&c[8], "http_host");
+    export_dictionary_schema(&c[9], "http_uri");
+}
+
+/**
+ * @brief Returns columns which may be modified (copied if shared with export).
+ *
+ * @return batch_columns& Columns.
+ */
+batch_columns& PacketBatch::writable()
+{
+    if (this->columns_.use_count() > 1) {
+        this->columns_ = std::make_shared<batch_columns>(*this->columns_);
+    }
+
+    return *this->columns_;
+}
+
+/**
+ * @brief Record field identifiers (indexes of record_fields table).
+ */
+enum record_field_id {
+    RECORD_TIMESTAMP,
+    RECORD_LENGTH,
+    RECORD_PAYLOAD_LENGTH,
+    RECORD_IP_VERSION,
+    RECORD_SOURCE,
+    RECORD_DESTINATION,
+    RECORD_PROTOCOL,
+    RECORD_SOURCE_PORT,
+    RECORD_DESTINATION_PORT,
+    RECORD_FIELDS
+};
+
+/**
+ * @brief Supported record fields (offsets are assigned per records layout).
+ */
+static const record_field record_fields[RECORD_FIELDS] = {
+    { "timestamp", "f8", 0, 8 },          /**< Seconds since epoch. */
+    { "length", "u4", 0, 4 },             /**< Packet length. */
+    { "payload_length", "u4", 0, 4 },     /**< Length of last dissected layer payload. */
+    { "ip_version", "u1", 0, 1 },         /**< 4, 6 or 0. */
+    { "source", "S39", 0, 39 },           /**< Source IP address (text). */
+    { "destination", "S39", 0, 39 },      /**< Destination IP address (text). */
+    { "protocol", "u1", 0, 1 },           /**< IP protocol number. */
+    { "source_port", "u2", 0, 2 },        /**< TCP/UDP source port. */
+    { "destination_port", "u2", 0, 2 },   /**< TCP/UDP destination port. */
+};
+
+/**
+ * @brief Construct a new PacketRecords::PacketRecords object.
+ *
+ * Fields are packed in given order, without padding.
+ *
+ * @param fields Names of fields, all fields if empty.
+ */
+PacketRecords::PacketRecords(const std::vector<std::string>& fields)
+    : itemsize_{ 0 }
+    , size_{ 0 }
+{
+    if (fields.empty()) {
+        for (uint8_t i = 0; i < RECORD_FIELDS; ++i) {
+            this->ids_.push_back(i);
+        }
+    }
+
+    for (const std::string& name : fields) {
+        uint8_t id = 0;
+
+        while (id < RECORD_FIELDS && name != record_fields[id].name) {
+            ++id;
+        }
+
+        if (id == RECORD_FIELDS) {
+            throw std::invalid_argument("Unknown record field: " + name);
+        }
+
+        this->ids_.push_back(id);
+    }
+
+    for (uint8_t id : this->ids_) {
+        record_field field = record_fields[id];
+        field.offset       = this->itemsize_;
+
+        this->itemsize_ += field.size;
+        this->fields_.push_back(field);
+    }
+}
+
+/**
+ * @brief Appends record of packet.
+ *
+ * @param packet Packet.
+ */
+void PacketRecords::append(const Packet& packet)
+{
+    this->data_.resize(this->data_.size() + this->itemsize_);
+
+    uint8_t* record = this->data_.data() + this->size_ * this->itemsize_;
+    const IPv4* ipv4 = packet.ipv4();
+    const IPv6* ipv6 = packet.ipv6();
+
+    for (unsigned int i = 0; i < this->ids_.size(); ++i) {
+        uint8_t* value = record + this->fields_[i].offset;
+
+        switch (this->ids_[i]) {
+        case RECORD_TIMESTAMP: {
+            double timestamp = packet.timestamp();
+            std::memcpy(value, &timestamp, sizeof(timestamp));
+            break;
+        }
+        case RECORD_LENGTH: {
+            uint32_t length = packet.length();
+            std::memcpy(value, &length, sizeof(length));
+            break;
+        }
+        case RECORD_PAYLOAD_LENGTH: {
+            uint32_t length = packet.payload_length();
+            std::memcpy(value, &length, sizeof(length));
+            break;
+        }
+        case RECORD_IP_VERSION:
+            *value = ipv4 ? 4 : ipv6 ? 6 : 0;
+            break;
+        case RECORD_SOURCE:
+        case RECORD_DESTINATION: {
+            bool source                = this->ids_[i] == RECORD_SOURCE;
+            const std::string* address = nullptr;
+
+            if (ipv4) {
+                address = source ? &ipv4->source() : &ipv4->destination();
+            } else if (ipv6) {
+                address = source ? &ipv6->source() : &ipv6->destination();
+            }
+
+            if (address) {
+                std::memcpy(value, address->data(), std::min<size_t>(address->size(), this->fields_[i].size));
+            }
+
+            break;
+        }
+        case RECORD_PROTOCOL:
+            if (ipv4) {
+                *value = ipv4->protocol_number();
+            } else if (ipv6) {
+                *value = ipv6->next_header_number();
+            }
+
+            break;
+        case RECORD_SOURCE_PORT:
+        case RECORD_DESTINATION_PORT: {
+            bool source   = this->ids_[i] == RECORD_SOURCE_PORT;
+            uint16_t port = 0;
+
+            if (packet.tcp()) {
+                port = source ? packet.tcp()->source_port() : packet.tcp()->destination_port();
+            } else if (packet.udp()) {
+                port = source ? packet.udp()->source_port() : packet.udp()->destination_port();
+            }
+
+            std::memcpy(value, &port, sizeof(port));
+            break;
+        }
+        }
+    }
+
+    ++this->size_;
+}
+
+/**
+ * @brief Dissects packets of pcap into records.
+ *
+ * @param pcap Opened pcap.
+ * @param max_packets Maximum number of packets (0 - until end of file).
+ * @return unsigned int Number of appended packets.
+ */
+unsigned int PacketRecords::read(Pcap& pcap, unsigned int max_packets)
+{
+    unsigned int count = 0;
+    std::unique_ptr<Packet> packet;
+
+    while ((!max_packets || count < max_packets) && (packet = pcap.next_packet()) != nullptr) {
+        this->append(*packet);
+        ++count;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Getter of number of records.
+ *
+ * @return unsigned int Number of packets.
+ */
+unsigned int PacketRecords::size() const
+{
+    return this->size_;
+}
+
+/**
+ * @brief Getter of record size.
+ *
+ * @return unsigned int Record size (bytes).
+ */
+unsigned int PacketRecords::itemsize() const
+{
+    return this->itemsize_;
+}
+
+/**
+ * @brief Getter of record layout.
+ *
+ * @return const std::vector<record_field>& Fields in record order.
+ */
+const std::vector<record_field>& PacketRecords::fields() const
+{
+    return this->fields_;
+}
+
+/**
+ * @brief Getter of records buffer (size() * itemsize() bytes).
+ *
+ * @return uint8_t* Records.
+ */
+uint8_t* PacketRecords::data()
+{
+    return this->data_.data();
+}
+
+/**
+ * @brief Dissects whole pcap into batch.
+ *
+ * @param pcap_path Path to pcap.
+ * @return PacketBatch Batch with one row per packet.
+ */
+PacketBatch read_batch(const std::string& pcap_path)
+{
+    Pcap pcap(pcap_path);
+    PacketBatch batch;
+
+    batch.read(pcap);
+
+    return batch;
+}
+/**
+ * @brief Dissects whole pcap into records.
+ *
+ * @param pcap_path Path to pcap.
+ * @param fields Names of fields, all fields if empty.
+ * @return PacketRecords Records with one record per packet.
+ */
+PacketRecords read_records(const std::string& pcap_path, const std::vector<std::string>& fields)
+{
+    PacketRecords records(fields);
+    Pcap pcap(pcap_path);
+
+    records.read(pcap);
+
+    return records;
+}
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+/**
+ * @file columnar.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Columnar (Arrow C data interface) export of dissected packets.
+ * @version 0.1
+ * @date 2019-06-10
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * https://arrow.apache.org/docs/format/CDataInterface.html
+ * https://arrow.apache.org/docs/format/CDataInterface/PyCapsuleInterface.html
+ */
+
+#ifndef DISSPCAP_COLUMNAR_H
+#define DISSPCAP_COLUMNAR_H
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "packet.h"
+#include "pcap.h"
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+/**
+ * @brief Arrow C data interface schema (ABI stable).
+ */
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+/**
+ * @brief Arrow C data interface array (ABI stable).
+ */
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif
+
+namespace disspcap {
+
+/**
+ * @brief Validity bitmap of nullable column.
+ */
+struct validity_bitmap {
+    std::vector<uint8_t> bits;
+    int64_t null_count;
+};
+
+/**
+ * @brief Dictionary encoded string column.
+ *
+ * Values are looked up by binary key (e.g. raw address), so string
+ * is rendered only once per distinct value.
+ */
+struct dictionary_column {
+    validity_bitmap validity;
+    std::vector<int32_t> indices;
+    std::vector<int32_t> offsets; /**< Dictionary value offsets (Arrow utf8 layout). */
+    std::string data;             /**< Dictionary value bytes. */
+    std::unordered_map<std::string, int32_t> ids;
+};
+
+/**
+ * @brief Column buffers of batch.
+ */
+struct batch_columns {
+    int64_t length;
+    std::vector<int64_t> timestamp; /**< Microseconds since epoch. */
+    std::vector<uint32_t> packet_length;
+    dictionary_column source;
+    dictionary_column destination;
+    validity_bitmap protocol_validity;
+    std::vector<uint8_t> protocol;
+    validity_bitmap port_validity;
+    std::vector<uint16_t> source_port;
+    std::vector<uint16_t> destination_port;
+    dictionary_column dns_qname;
+    dictionary_column http_host;
+    dictionary_column http_uri;
+};
+
+/**
+ * @brief Builder of packet summary columns.
+ *
+ * Columns: timestamp, length, source, destination, protocol (IP protocol
+ * number), source_port, destination_port, dns_qname, http_host and
+ * http_uri. Strings are dictionary encoded. Exported arrays share column
+ * buffers with batch (no copy), appending after export copies them once.
+ */
+class PacketBatch {
+public:
+    PacketBatch();
+    void append(const Packet& packet);
+    unsigned int read(Pcap& pcap, unsigned int max_packets = 0);
+    void clear();
+    unsigned int size() const;
+    void export_batch(struct ArrowArray* array, struct ArrowSchema* schema) const;
+    void export_schema(struct ArrowSchema* schema) const;
+
+private:
+    std::shared_ptr<batch_columns> columns_;
+    std::string key_; /**< Dictionary key buffer reused between packets. */
+    batch_columns& writable();
+};
+
+/**
+ * @brief Field of fixed size packet record.
+ */
+struct record_field {
+    std::string name;
+    std::string format; /**< NumPy type string (native byte order). */
+    unsigned int offset;
+    unsigned int size;
+};
+
+/**
+ * @brief Builder of packed fixed size packet records (NumPy structured array layout).
+ *
+ * Fields: timestamp, length, payload_length, ip_version, source,
+ * destination, protocol, source_port and destination_port. Missing
+ * values are zeros (empty strings).
+ */
+class PacketRecords {
+public:
+    PacketRecords(const std::vector<std::string>& fields = std::vector<std::string>());
+    void append(const Packet& packet);
+    unsigned int read(Pcap& pcap, unsigned int max_packets = 0);
+    unsigned int size() const;
+    unsigned int itemsize() const;
+    const std::vector<record_field>& fields() const;
+    uint8_t* data();
+
+private:
+    std::vector<record_field> fields_;
+    std::vector<uint8_t> ids_; /**< Index of field in record_fields table. */
+    unsigned int itemsize_;
+    unsigned int size_;
+    std::vector<uint8_t> data_;
+};
+
+PacketBatch read_batch(const std::string& pcap_path);
+PacketRecords read_records(const std::string& pcap_path,
+                           const std::vector<std::string>& fields = std::vector<std::string>());
+}
+
+#endif
\ No newline at end of file
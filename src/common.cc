@@ -10,48 +10,54 @@
 
 #include "common.h"
 
-#include <unordered_map>
+#include <cstring>
 
+#include "flow.h"
 #include "packet.h"
 #include "pcap.h"
+#include "topk.h"
 
 namespace disspcap {
 
 /**
  * @brief Reads pcap and returns most common ip address.
  * 
+ * Addresses are counted as binary keys by TopK, so memory is bounded
+ * by capacity (result is exact up to that many distinct addresses).
+ * 
  * @param pcap_path Path to pcap.
+ * @param capacity Number of monitored addresses.
  * @return std::string Most common IP.
  */
-std::string most_common_ip(std::string pcap_path)
+std::string most_common_ip(std::string pcap_path, unsigned int capacity)
 {
     Pcap pcap(pcap_path);
-
-    std::unordered_map<std::string, int> addresses;
+    TopK addresses(capacity);
 
     std::unique_ptr<Packet> packet;
 
     while ((packet = pcap.next_packet()) != nullptr) {
         if (packet->ipv4()) {
-            ++addresses[packet->ipv4()->source()];
-            ++addresses[packet->ipv4()->destination()];
+            uint32_t source      = packet->ipv4()->raw_source();
+            uint32_t destination = packet->ipv4()->raw_destination();
+
+            addresses.add(&source, sizeof(source));
+            addresses.add(&destination, sizeof(destination));
         } else if (packet->ipv6()) {
-            ++addresses[packet->ipv6()->source()];
-            ++addresses[packet->ipv6()->destination()];
+            addresses.add(packet->ipv6()->raw_source(), IPV6_ADDR_LEN);
+            addresses.add(packet->ipv6()->raw_destination(), IPV6_ADDR_LEN);
         }
     }
 
-    std::string most_common_ip = "";
-    int most_common_val        = 0;
+    std::vector<topk_entry> top = addresses.top(1);
 
-    for (auto& ip : addresses) {
-        if (ip.second > most_common_val) {
-            most_common_val = ip.second;
-            most_common_ip  = ip.first;
-        }
+    if (top.empty()) {
+        return "";
     }
 
-    return most_common_ip;
+    const uint8_t* address = reinterpret_cast<const uint8_t*>(top[0].key.data());
+
+    return str_address(top[0].key.size() == IPV6_ADDR_LEN ? 6 : 4, address);
 }
 
 /**
@@ -70,4 +76,52 @@ std::string string_hexa(unsigned char number)
 
     return hexa;
 }
+
+/**
+ * @brief Finalization mix of 64-bit hash (MurmurHash3 fmix64).
+ * 
+ * @param h Value to mix.
+ * @return uint64_t Mixed value.
+ */
+static inline uint64_t mix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+/**
+ * @brief Hashes binary data (addresses, ports, tuples, names).
+ * 
+ * Consumes 8 bytes per step, so short binary keys
+ * cost only a couple of multiplications.
+ * 
+ * @param data Data to hash.
+ * @param length Data length.
+ * @param seed Hash seed.
+ * @return uint64_t 64-bit hash.
+ */
+uint64_t hash_bytes(const void* data, size_t length, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h       = seed ^ (length * 0x9e3779b97f4a7c15ULL);
+    uint64_t chunk;
+
+    while (length >= 8) {
+        std::memcpy(&chunk, p, 8);
+        h = (h ^ mix64(chunk)) * 0x9e3779b97f4a7c15ULL;
+        p += 8;
+        length -= 8;
+    }
+
+    chunk = 0;
+    std::memcpy(&chunk, p, length);
+    h ^= mix64(chunk);
+
+    return mix64(h);
+}
 }
\ No newline at end of file
@@ -11,12 +11,17 @@
 #ifndef DISSPCAP_COMMON_H_
 #define DISSPCAP_COMMON_H_
 
+#include <stddef.h>
+#include <stdint.h>
 #include <string>
 
+#include "topk.h"
+
 namespace disspcap {
 
-std::string most_common_ip(std::string pcap_path);
+std::string most_common_ip(std::string pcap_path, unsigned int capacity = TOPK_CAPACITY);
 std::string string_hexa(unsigned char);
+uint64_t hash_bytes(const void* data, size_t length, uint64_t seed = 0);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,785 @@
+/**
+ * @file decap.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Tunnel and encapsulation decoding.
+ * @version 0.1
+ * @date 2019-05-20
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * https://tools.ietf.org/html/rfc3032
+ * https://tools.ietf.org/html/rfc2784
+ * https://tools.ietf.org/html/rfc2890
+ * https://tools.ietf.org/html/rfc7348
+ * https://tools.ietf.org/html/draft-foschiano-erspan-03
+ * https://www.etsi.org/deliver/etsi_ts/129200_129299/129281/
+ * https://www.tcpdump.org/linktypes.html
+ * https://www.radiotap.org
+ */
+
+#include "decap.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+
+#include "ethernet.h"
+#include "ipv4.h"
+#include "ipv6.h"
+
+namespace disspcap {
+
+/**
+ * @brief Position of decapsulation walk.
+ */
+struct decap_cursor {
+    const uint8_t* data;
+    unsigned int length;
+    unsigned int offset;
+    uint8_t next; /**< ENCAP_* value of header at offset. */
+    decap_result* result;
+};
+
+/**
+ * @brief Reads 16-bit value in network byte order.
+ *
+ * @param p Pointer to data.
+ * @return uint16_t Value.
+ */
+static inline uint16_t read16(const uint8_t* p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+/**
+ * @brief Reads 32-bit value in network byte order.
+ *
+ * @param p Pointer to data.
+ * @return uint32_t Value.
+ */
+static inline uint32_t read32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/**
+ * @brief Records layer.
+ *
+ * @param cursor Walk position.
+ * @param type ENCAP_* value.
+ * @param offset Header offset.
+ * @param id Layer identifier.
+ * @return true Layer was recorded.
+ * @return false Depth limit reached - walk ends.
+ */
+static bool push_layer(decap_cursor& cursor, uint8_t type, unsigned int offset, uint32_t id)
+{
+    decap_result& result = *cursor.result;
+
+    if (result.depth >= ENCAP_MAX_DEPTH) {
+        cursor.next = ENCAP_NONE;
+        return false;
+    }
+
+    result.layers[result.depth].type   = type;
+    result.layers[result.depth].offset = offset;
+    result.layers[result.depth].id     = id;
+    ++result.depth;
+
+    return true;
+}
+
+/**
+ * @brief Maps Ethernet type to header which is walked.
+ *
+ * @param type Ethernet type.
+ * @return uint8_t ENCAP_* value, ENCAP_NONE if type is not walked.
+ */
+static uint8_t ether_type_encap(uint16_t type)
+{
+    switch (type) {
+    case ETH_8021Q:
+    case ETH_8021AD:
+    case ETH_QINQ:
+        return ENCAP_VLAN;
+    case ETH_MPLS:
+    case ETH_MPLS_MC:
+        return ENCAP_MPLS;
+    case ETH_IPv4:
+        return ENCAP_IPV4;
+    case ETH_IPv6:
+        return ENCAP_IPV6;
+    case ETH_TEB:
+        return ENCAP_ETHERNET;
+    default:
+        return ENCAP_NONE;
+    }
+}
+
+/**
+ * @brief Sets next header according to Ethernet type.
+ *
+ * Unknown types end walk - they are network layer of packet.
+ *
+ * @param cursor Walk position (offset of header with given type).
+ * @param type Ethernet type.
+ */
+static void dispatch_ether_type(decap_cursor& cursor, uint16_t type)
+{
+    cursor.result->network_offset = cursor.offset;
+    cursor.result->network_type   = type;
+    cursor.next                   = ether_type_encap(type);
+}
+
+/**
+ * @brief Sets next header according to IP version nibble (MPLS, GTP-U payload).
+ *
+ * @param cursor Walk position.
+ */
+static void dispatch_ip_version(decap_cursor& cursor)
+{
+    if (cursor.offset >= cursor.length) {
+        cursor.result->network_offset = cursor.offset;
+        cursor.result->network_type   = 0;
+        cursor.next                   = ENCAP_NONE;
+        return;
+    }
+
+    switch (cursor.data[cursor.offset] >> 4) {
+    case 4:
+        dispatch_ether_type(cursor, ETH_IPv4);
+        break;
+    case 6:
+        dispatch_ether_type(cursor, ETH_IPv6);
+        break;
+    default:
+        dispatch_ether_type(cursor, 0);
+    }
+}
+
+/**
+ * @brief Ethernet header.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_ethernet(decap_cursor& cursor)
+{
+    if (cursor.offset + ETH_LENGTH > cursor.length) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    unsigned int offset = cursor.offset;
+
+    if (!push_layer(cursor, ENCAP_ETHERNET, offset, 0)) {
+        return;
+    }
+
+    cursor.result->link_offset = offset;
+    cursor.offset += ETH_LENGTH;
+    dispatch_ether_type(cursor, read16(cursor.data + offset + 12));
+}
+
+/**
+ * @brief 802.1Q/802.1ad tag.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_vlan(decap_cursor& cursor)
+{
+    const uint8_t* tag = cursor.data + cursor.offset;
+
+    if (cursor.offset + VLAN_LEN > cursor.length || !push_layer(cursor, ENCAP_VLAN, cursor.offset, read16(tag) & 0x0fff)) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    cursor.offset += VLAN_LEN;
+    dispatch_ether_type(cursor, read16(tag + 2));
+}
+
+/**
+ * @brief MPLS label stack.
+ *
+ * Payload type is guessed from first nibble, 0 means pseudowire control
+ * word followed by Ethernet.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_mpls(decap_cursor& cursor)
+{
+    bool bottom = false;
+
+    while (!bottom) {
+        if (cursor.offset + 4 > cursor.length) {
+            cursor.next = ENCAP_NONE;
+            return;
+        }
+
+        uint32_t entry = read32(cursor.data + cursor.offset);
+
+        if (!push_layer(cursor, ENCAP_MPLS, cursor.offset, entry >> 12)) {
+            return;
+        }
+
+        bottom = entry & 0x100;
+        cursor.offset += 4;
+    }
+
+    if (cursor.offset < cursor.length && (cursor.data[cursor.offset] >> 4) == 0) {
+        /* pseudowire control word */
+        cursor.offset += 4;
+        cursor.next = ENCAP_ETHERNET;
+        return;
+    }
+
+    dispatch_ip_version(cursor);
+}
+
+/**
+ * @brief Continues into tunnel carried by IP if it is recognized.
+ *
+ * Otherwise the IP header is network layer of packet.
+ *
+ * @param cursor Walk position (at IP header).
+ * @param type ENCAP_IPV4 or ENCAP_IPV6.
+ * @param protocol Protocol carried by IP.
+ * @param offset Offset of IP payload.
+ */
+static void decap_ip_payload(decap_cursor& cursor, uint8_t type, uint8_t protocol, unsigned int offset)
+{
+    const uint8_t* payload = cursor.data + offset;
+    uint8_t next           = ENCAP_NONE;
+
+    if (protocol == IP_GRE && offset + 4 <= cursor.length && !(payload[1] & 0x07)) {
+        /* GRE version 0 (not PPTP) */
+        next = ENCAP_GRE;
+    } else if (protocol == IP_UDP && offset + 16 <= cursor.length) {
+        uint16_t port = read16(payload + 2);
+
+        if (port == UDP_PORT_VXLAN && (payload[8] & 0x08)) {
+            /* VNI flag set */
+            next = ENCAP_VXLAN;
+        } else if ((port == UDP_PORT_GTPU || read16(payload) == UDP_PORT_GTPU) && (payload[8] >> 5) == 1 &&
+                   (payload[8] & 0x10) && payload[9] == 0xff) {
+            /* GTPv1-U G-PDU */
+            next = ENCAP_GTPU;
+        }
+    }
+
+    if (next == ENCAP_NONE || !push_layer(cursor, type, cursor.offset, 0)) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    cursor.offset = offset;
+    cursor.next   = next;
+}
+
+/**
+ * @brief IPv4 header - continues only into GRE and UDP tunnels.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_ipv4(decap_cursor& cursor)
+{
+    const uint8_t* ip = cursor.data + cursor.offset;
+
+    if (cursor.offset + 20 > cursor.length) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    unsigned int header_len = (ip[0] & 0xf) * 4;
+
+    /* fragments are left to reassembly */
+    if (header_len < 20 || (read16(ip + 6) & 0x3fff)) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    decap_ip_payload(cursor, ENCAP_IPV4, ip[9], cursor.offset + header_len);
+}
+
+/**
+ * @brief IPv6 header - continues only into GRE and UDP tunnels.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_ipv6(decap_cursor& cursor)
+{
+    if (cursor.offset + IPV6_LEN > cursor.length) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    const ipv6_fragment_header* fragment;
+    const uint8_t* ip    = cursor.data + cursor.offset;
+    uint8_t next         = ip[6];
+    unsigned int start   = cursor.offset + IPV6_LEN;
+    unsigned int skipped = skip_ipv6_extensions(ip + IPV6_LEN, cursor.length - start, next, &fragment);
+
+    /* fragments are left to reassembly */
+    if (fragment) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    decap_ip_payload(cursor, ENCAP_IPV6, next, start + skipped);
+}
+
+/**
+ * @brief GRE header (version 0).
+ *
+ * Unknown payload protocol ends walk before GRE header is recorded, the
+ * outer IP header stays network layer of packet.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_gre(decap_cursor& cursor)
+{
+    const uint8_t* gre  = cursor.data + cursor.offset;
+    unsigned int length = 4;
+    uint32_t key        = 0;
+
+    uint16_t flags = read16(gre);
+    uint16_t type  = read16(gre + 2);
+
+    if (flags & 0x8000) {
+        /* checksum */
+        length += 4;
+    }
+
+    if (flags & 0x2000) {
+        if (cursor.offset + length + 4 > cursor.length) {
+            cursor.next = ENCAP_NONE;
+            return;
+        }
+
+        key = read32(gre + length);
+        length += 4;
+    }
+
+    if (flags & 0x1000) {
+        /* sequence number */
+        length += 4;
+    }
+
+    if (type != ETH_ERSPAN && type != ETH_ERSPAN3 && ether_type_encap(type) == ENCAP_NONE) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    if (!push_layer(cursor, ENCAP_GRE, cursor.offset, key)) {
+        return;
+    }
+
+    cursor.offset += length;
+
+    switch (type) {
+    case ETH_ERSPAN:
+        /* type I has no ERSPAN header (and no sequence number) */
+        cursor.next = (flags & 0x1000) ? ENCAP_ERSPAN : ENCAP_ETHERNET;
+        break;
+    case ETH_ERSPAN3:
+        cursor.next = ENCAP_ERSPAN;
+        break;
+    default:
+        dispatch_ether_type(cursor, type);
+    }
+}
+
+/**
+ * @brief ERSPAN type II/III header.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_erspan(decap_cursor& cursor)
+{
+    const uint8_t* erspan = cursor.data + cursor.offset;
+
+    if (cursor.offset + 12 > cursor.length) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    unsigned int version = erspan[0] >> 4;
+    unsigned int length  = 8;
+
+    if (version == 2) {
+        /* type III, optional platform specific subheader */
+        length = (erspan[11] & 0x01) ? 20 : 12;
+    }
+
+    if (!push_layer(cursor, ENCAP_ERSPAN, cursor.offset, read16(erspan + 2) & 0x03ff)) {
+        return;
+    }
+
+    cursor.offset += length;
+    cursor.next = ENCAP_ETHERNET;
+}
+
+/**
+ * @brief UDP + VXLAN header (validated by decap_ip_payload()).
+ *
+ * @param cursor Walk position (at UDP header).
+ */
+static void decap_vxlan(decap_cursor& cursor)
+{
+    const uint8_t* vxlan = cursor.data + cursor.offset + 8;
+
+    if (!push_layer(cursor, ENCAP_VXLAN, cursor.offset, read32(vxlan + 4) >> 8)) {
+        return;
+    }
+
+    cursor.offset += 16;
+    cursor.next = ENCAP_ETHERNET;
+}
+
+/**
+ * @brief UDP + GTP-U header (validated by decap_ip_payload()).
+ *
+ * @param cursor Walk position (at UDP header).
+ */
+static void decap_gtpu(decap_cursor& cursor)
+{
+    const uint8_t* gtp  = cursor.data + cursor.offset + 8;
+    unsigned int offset = cursor.offset + 8;
+    unsigned int length = 8;
+
+    if (gtp[0] & 0x07) {
+        /* sequence number, N-PDU number and next extension header type */
+        if (offset + 12 > cursor.length) {
+            cursor.next = ENCAP_NONE;
+            return;
+        }
+
+        uint8_t extension = gtp[11];
+        length            = 12;
+
+        /* extension headers - length in 4 byte units, type of next in last byte */
+        while (extension) {
+            if (offset + length >= cursor.length || !gtp[length]) {
+                cursor.next = ENCAP_NONE;
+                return;
+            }
+
+            unsigned int extension_len = gtp[length] * 4;
+
+            if (offset + length + extension_len > cursor.length) {
+                cursor.next = ENCAP_NONE;
+                return;
+            }
+
+            extension = gtp[length + extension_len - 1];
+            length += extension_len;
+        }
+    }
+
+    if (!push_layer(cursor, ENCAP_GTPU, cursor.offset, read32(gtp + 4))) {
+        return;
+    }
+
+    cursor.offset = offset + length;
+    dispatch_ip_version(cursor);
+}
+
+/**
+ * @brief Linux cooked capture v1 header.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_sll(decap_cursor& cursor)
+{
+    const uint8_t* sll = cursor.data + cursor.offset;
+
+    if (cursor.offset + 16 > cursor.length || !push_layer(cursor, ENCAP_SLL, cursor.offset, read16(sll))) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    cursor.offset += 16;
+    dispatch_ether_type(cursor, read16(sll + 14));
+}
+
+/**
+ * @brief Linux cooked capture v2 header.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_sll2(decap_cursor& cursor)
+{
+    const uint8_t* sll = cursor.data + cursor.offset;
+
+    if (cursor.offset + 20 > cursor.length || !push_layer(cursor, ENCAP_SLL2, cursor.offset, read32(sll + 4))) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    cursor.offset += 20;
+    dispatch_ether_type(cursor, read16(sll));
+}
+
+/**
+ * @brief BSD loopback header.
+ *
+ * Address family is in byte order of capturing host (DLT_NULL) or in
+ * network byte order (DLT_LOOP), both are accepted. IPv6 family differs
+ * between systems.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_null(decap_cursor& cursor)
+{
+    const uint8_t* header = cursor.data + cursor.offset;
+
+    if (cursor.offset + 4 > cursor.length) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    uint32_t family = read32(header);
+
+    if (family > 0xffff) {
+        family = header[0] | (header[1] << 8);
+    }
+
+    if (!push_layer(cursor, ENCAP_NULL, cursor.offset, family)) {
+        return;
+    }
+
+    cursor.offset += 4;
+
+    switch (family) {
+    case 2:
+        dispatch_ether_type(cursor, ETH_IPv4);
+        break;
+    case 10: /* Linux */
+    case 24: /* NetBSD, OpenBSD */
+    case 28: /* FreeBSD */
+    case 30: /* Darwin */
+        dispatch_ether_type(cursor, ETH_IPv6);
+        break;
+    default:
+        dispatch_ether_type(cursor, 0);
+    }
+}
+
+/**
+ * @brief Radiotap header (little endian length, followed by 802.11 frame).
+ *
+ * @param cursor Walk position.
+ */
+static void decap_radiotap(decap_cursor& cursor)
+{
+    const uint8_t* radiotap = cursor.data + cursor.offset;
+
+    if (cursor.offset + 8 > cursor.length || radiotap[0] != 0) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    unsigned int length = radiotap[2] | (radiotap[3] << 8);
+
+    if (length < 8 || !push_layer(cursor, ENCAP_RADIOTAP, cursor.offset, 0)) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    cursor.offset += length;
+    cursor.next = ENCAP_IEEE80211;
+}
+
+/**
+ * @brief 802.11 data frame followed by LLC/SNAP header.
+ *
+ * Management, control, null function and protected frames end walk.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_ieee80211(decap_cursor& cursor)
+{
+    const uint8_t* frame = cursor.data + cursor.offset;
+    unsigned int length  = 24;
+
+    if (cursor.offset + length > cursor.length || ((frame[0] >> 2) & 0x03) != 2 || (frame[0] & 0x40) ||
+        (frame[1] & 0x40)) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    if ((frame[1] & 0x03) == 0x03) {
+        /* ToDS and FromDS - fourth address */
+        length += 6;
+    }
+
+    if (frame[0] & 0x80) {
+        /* QoS control, HT control if order bit set */
+        length += (frame[1] & 0x80) ? 6 : 2;
+    }
+
+    const uint8_t* llc = frame + length;
+
+    if (cursor.offset + length + 8 > cursor.length || llc[0] != 0xaa || llc[1] != 0xaa || llc[2] != 0x03 ||
+        !push_layer(cursor, ENCAP_IEEE80211, cursor.offset, 0)) {
+        cursor.next = ENCAP_NONE;
+        return;
+    }
+
+    cursor.offset += length + 8;
+    dispatch_ether_type(cursor, read16(llc + 6));
+}
+
+/**
+ * @brief Raw IP - no link layer header.
+ *
+ * @param cursor Walk position.
+ */
+static void decap_raw(decap_cursor& cursor)
+{
+    dispatch_ip_version(cursor);
+}
+
+/**
+ * @brief Handlers indexed by ENCAP_* value.
+ */
+typedef void (*decap_handler)(decap_cursor&);
+
+static const decap_handler HANDLERS[ENCAP_KINDS] = {
+    nullptr,
+    decap_ethernet,
+    decap_vlan,
+    decap_mpls,
+    decap_ipv4,
+    decap_ipv6,
+    decap_gre,
+    decap_erspan,
+    decap_vxlan,
+    decap_gtpu,
+    decap_sll,
+    decap_sll2,
+    decap_null,
+    decap_radiotap,
+    decap_ieee80211,
+    decap_raw,
+};
+
+/**
+ * @brief Walks encapsulations in front of network layer.
+ *
+ * Starts at link layer header and iterates over VLAN tags, MPLS labels and
+ * GRE (incl. ERSPAN), VXLAN and GTP-U tunnels. Every recorded header is
+ * stored in result.layers, walk ends on first network layer which is not
+ * tunnel, on malformed data or when ENCAP_MAX_DEPTH is reached.
+ * Network offset is past the packet end if no network layer was found.
+ *
+ * @param data Packet data.
+ * @param length Packet length.
+ * @param result Filled with layers and position of network layer.
+ * @param link_type First header of packet (see link_layer()).
+ */
+void decapsulate(const uint8_t* data, unsigned int length, decap_result& result, uint8_t link_type)
+{
+    decap_cursor cursor;
+
+    cursor.data   = data;
+    cursor.length = length;
+    cursor.offset = 0;
+    cursor.next   = link_type < ENCAP_KINDS ? link_type : ENCAP_NONE;
+    cursor.result = &result;
+
+    result.depth          = 0;
+    result.link_offset    = 0;
+    result.network_offset = length + 1;
+    result.network_type   = 0;
+
+    while (cursor.next != ENCAP_NONE) {
+        HANDLERS[cursor.next](cursor);
+    }
+
+    /* malformed tunnel - network layer is the outer one, keep only layers in front of it */
+    while (result.depth && result.layers[result.depth - 1].offset >= result.network_offset) {
+        --result.depth;
+    }
+}
+
+/**
+ * @brief Maps capture data link type to first header of packets.
+ *
+ * Resolved once per capture, decapsulate() then starts directly at
+ * matching handler.
+ *
+ * @param datalink Data link type (pcap_datalink()).
+ * @return uint8_t ENCAP_* value, ENCAP_NONE if unsupported.
+ */
+uint8_t link_layer(int datalink)
+{
+    switch (datalink) {
+    case LINKTYPE_ETHERNET:
+        return ENCAP_ETHERNET;
+    case LINKTYPE_NULL:
+    case LINKTYPE_LOOP:
+        return ENCAP_NULL;
+    case LINKTYPE_RAW_DLT:
+    case LINKTYPE_RAW_OPENBSD:
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_IPV6:
+        return ENCAP_RAW;
+    case LINKTYPE_LINUX_SLL:
+        return ENCAP_SLL;
+    case LINKTYPE_LINUX_SLL2:
+        return ENCAP_SLL2;
+    case LINKTYPE_IEEE802_11:
+        return ENCAP_IEEE80211;
+    case LINKTYPE_IEEE802_11_RADIO:
+        return ENCAP_RADIOTAP;
+    default:
+        return ENCAP_NONE;
+    }
+}
+
+/**
+ * @brief Converts layer type to string.
+ *
+ * @param type ENCAP_* value.
+ * @return std::string Layer name.
+ */
+std::string str_encap(uint8_t type)
+{
+    switch (type) {
+    case ENCAP_ETHERNET:
+        return "Ethernet";
+    case ENCAP_VLAN:
+        return "VLAN";
+    case ENCAP_MPLS:
+        return "MPLS";
+    case ENCAP_IPV4:
+        return "IPv4";
+    case ENCAP_IPV6:
+        return "IPv6";
+    case ENCAP_GRE:
+        return "GRE";
+    case ENCAP_ERSPAN:
+        return "ERSPAN";
+    case ENCAP_VXLAN:
+        return "VXLAN";
+    case ENCAP_GTPU:
+        return "GTP-U";
+    case ENCAP_SLL:
+        return "SLL";
+    case ENCAP_SLL2:
+        return "SLL2";
+    case ENCAP_NULL:
+        return "Loopback";
+    case ENCAP_RADIOTAP:
+        return "Radiotap";
+    case ENCAP_IEEE80211:
+        return "802.11";
+    case ENCAP_RAW:
+        return "Raw IP";
+    default:
+        return "UNKNOWN";
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+/**
+ * @file decap.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Tunnel and encapsulation decoding.
+ * @version 0.1
+ * @date 2019-05-20
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * https://tools.ietf.org/html/rfc3032
+ * https://tools.ietf.org/html/rfc2784
+ * https://tools.ietf.org/html/rfc2890
+ * https://tools.ietf.org/html/rfc7348
+ * https://tools.ietf.org/html/draft-foschiano-erspan-03
+ * https://www.etsi.org/deliver/etsi_ts/129200_129299/129281/
+ * https://www.tcpdump.org/linktypes.html
+ * https://www.radiotap.org
+ */
+
+#ifndef DISSPCAP_DECAP_H
+#define DISSPCAP_DECAP_H
+
+#include <stdint.h>
+#include <string>
+
+namespace disspcap {
+
+const unsigned int ENCAP_MAX_DEPTH = 16; /**< Maximum number of recorded layers. */
+
+const uint8_t ENCAP_NONE      = 0;  /**< End of walk. */
+const uint8_t ENCAP_ETHERNET  = 1;  /**< Ethernet header. */
+const uint8_t ENCAP_VLAN      = 2;  /**< 802.1Q/802.1ad tag, id is VLAN ID. */
+const uint8_t ENCAP_MPLS      = 3;  /**< MPLS label stack entry, id is label. */
+const uint8_t ENCAP_IPV4      = 4;  /**< Outer IPv4 header. */
+const uint8_t ENCAP_IPV6      = 5;  /**< Outer IPv6 header. */
+const uint8_t ENCAP_GRE       = 6;  /**< GRE header, id is key (0 if none). */
+const uint8_t ENCAP_ERSPAN    = 7;  /**< ERSPAN header, id is session ID. */
+const uint8_t ENCAP_VXLAN     = 8;  /**< UDP + VXLAN header, id is VNI. */
+const uint8_t ENCAP_GTPU      = 9;  /**< UDP + GTP-U header, id is TEID. */
+const uint8_t ENCAP_SLL       = 10; /**< Linux cooked capture v1, id is packet type. */
+const uint8_t ENCAP_SLL2      = 11; /**< Linux cooked capture v2, id is interface index. */
+const uint8_t ENCAP_NULL      = 12; /**< BSD loopback, id is address family. */
+const uint8_t ENCAP_RADIOTAP  = 13; /**< Radiotap header. */
+const uint8_t ENCAP_IEEE80211 = 14; /**< 802.11 data frame + LLC/SNAP. */
+const uint8_t ENCAP_RAW       = 15; /**< Raw IP, not recorded as layer. */
+const uint8_t ENCAP_KINDS     = 16;
+
+const int LINKTYPE_NULL             = 0;   /**< BSD loopback, host byte order. */
+const int LINKTYPE_ETHERNET         = 1;   /**< Ethernet. */
+const int LINKTYPE_RAW_DLT          = 12;  /**< Raw IP (DLT_RAW on most platforms). */
+const int LINKTYPE_RAW_OPENBSD      = 14;  /**< Raw IP (DLT_RAW on OpenBSD). */
+const int LINKTYPE_RAW              = 101; /**< Raw IP. */
+const int LINKTYPE_IEEE802_11       = 105; /**< 802.11 w/o radio information. */
+const int LINKTYPE_LOOP             = 108; /**< OpenBSD loopback, network byte order. */
+const int LINKTYPE_LINUX_SLL        = 113; /**< Linux cooked capture v1. */
+const int LINKTYPE_IEEE802_11_RADIO = 127; /**< Radiotap + 802.11. */
+const int LINKTYPE_IPV4             = 228; /**< Raw IPv4. */
+const int LINKTYPE_IPV6             = 229; /**< Raw IPv6. */
+const int LINKTYPE_LINUX_SLL2       = 276; /**< Linux cooked capture v2. */
+
+const uint16_t UDP_PORT_VXLAN = 4789; /**< VXLAN destination port. */
+const uint16_t UDP_PORT_GTPU  = 2152; /**< GTP-U port. */
+
+const uint8_t IP_GRE = 0x2F; /**< Generic Routing Encapsulation. */
+
+/**
+ * @brief One header in front of dissected network layer.
+ */
+struct encap_layer {
+    uint8_t type;    /**< ENCAP_* value. */
+    uint16_t offset; /**< Offset of header in packet. */
+    uint32_t id;     /**< VLAN ID, MPLS label, GRE key, session ID, VNI or TEID. */
+};
+
+/**
+ * @brief Result of decapsulation - fixed size, no allocation.
+ */
+struct decap_result {
+    encap_layer layers[ENCAP_MAX_DEPTH];
+    unsigned int depth;
+    unsigned int link_offset;    /**< Innermost Ethernet header. */
+    unsigned int network_offset; /**< Network layer. */
+    uint16_t network_type;       /**< Ethernet type of network layer (0 if unknown). */
+};
+
+void decapsulate(const uint8_t* data, unsigned int length, decap_result& result, uint8_t link_type = ENCAP_ETHERNET);
+uint8_t link_layer(int datalink);
+std::string str_encap(uint8_t type);
+}
+
+#endif
\ No newline at end of file
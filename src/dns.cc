@@ -17,7 +17,10 @@
 #include "dns.h"
 
 #include <arpa/inet.h>
-#include <memory>
+#include <cstring>
+#include <ctime>
+
+#include "common.h"
 
 namespace disspcap {
 
@@ -28,11 +31,18 @@ namespace disspcap {
  * @param data_length Data length.
  */
 DNS::DNS(uint8_t* data, int data_length)
-    : incomplete_{ false }
+    : id_{ 0 }
+    , qr_{ 0 }
+    , rcode_{ 0 }
+    , question_count_{ 0 }
+    , answer_count_{ 0 }
+    , authority_count_{ 0 }
+    , additional_count_{ 0 }
+    , incomplete_{ false }
     , raw_header_{ reinterpret_cast<dns_header*>(data) }
-    , ptr_{ data }
     , base_ptr_{ data }
-    , end_ptr_{ data + data_length }
+    , length_{ data_length > 0 ? static_cast<unsigned int>(data_length) : 0 }
+    , rendered_{ 0 }
 {
     this->parse();
 }
@@ -48,6 +58,16 @@ bool DNS::is_incomplete() const
     return this->incomplete_;
 }
 
+/**
+ * @brief Getter of message ID.
+ * 
+ * @return unsigned int 16-bit identifier shared by query and response.
+ */
+unsigned int DNS::id() const
+{
+    return this->id_;
+}
+
 /**
  * @brief Getter of query x response value.
  * 
@@ -58,6 +78,16 @@ unsigned int DNS::qr() const
     return this->qr_;
 }
 
+/**
+ * @brief Getter of response code.
+ * 
+ * @return unsigned int Response code (0 NOERROR, 2 SERVFAIL, 3 NXDOMAIN, ...).
+ */
+unsigned int DNS::rcode() const
+{
+    return this->rcode_;
+}
+
 /**
  * @brief Getter of number of entries in question section.
  * 
@@ -105,7 +135,7 @@ unsigned int DNS::additional_count() const
  */
 const std::vector<std::string>& DNS::questions() const
 {
-    return this->questions_;
+    return this->section(DNS_SECTION_QUESTION);
 }
 
 /**
@@ -115,7 +145,7 @@ const std::vector<std::string>& DNS::questions() const
  */
 const std::vector<std::string>& DNS::answers() const
 {
-    return this->answers_;
+    return this->section(DNS_SECTION_ANSWER);
 }
 
 /**
@@ -125,7 +155,7 @@ const std::vector<std::string>& DNS::answers() const
  */
 const std::vector<std::string>& DNS::authoritatives() const
 {
-    return this->authoritatives_;
+    return this->section(DNS_SECTION_AUTHORITY);
 }
 
 /**
@@ -135,181 +165,469 @@ const std::vector<std::string>& DNS::authoritatives() const
  */
 const std::vector<std::string>& DNS::additionals() const
 {
-    return this->additionals_;
+    return this->section(DNS_SECTION_ADDITIONAL);
 }
 
 /**
- * @brief Parses DNS.
+ * @brief Getter of all questions and resource records in message order.
+ * 
+ * @return const std::vector<dns_record>& Parsed records.
  */
-void DNS::parse()
+const std::vector<dns_record>& DNS::records() const
 {
-    /* malform/incomplete packet check */
-    if (end_ptr_ - ptr_ < DNS_HDR_LEN) {
-        this->incomplete_ = true;
-        return;
-    }
+    return this->records_;
+}
 
-    /* header */
-    this->qr_               = this->raw_header_->qr__opcode__aa__tc__rd__ra >> 7;
-    this->question_count_   = ntohs(this->raw_header_->qdcount);
-    this->answer_count_     = ntohs(this->raw_header_->ancount);
-    this->authority_count_  = ntohs(this->raw_header_->nscount);
-    this->additional_count_ = ntohs(this->raw_header_->arcount);
+/**
+ * @brief Decodes owner name of record.
+ * 
+ * @param record Record of this message.
+ * @return std::string Domain name.
+ */
+std::string DNS::name(const dns_record& record) const
+{
+    return this->parse_name(record.name_offset);
+}
 
-    /* skip header */
-    ptr_ = base_ptr_ + DNS_HDR_LEN;
+/**
+ * @brief Hashes owner name of record without decoding it.
+ * 
+ * Labels are hashed in wire form (compression pointers followed), ASCII
+ * letters are lower-cased, so differently cased or compressed copies of
+ * the same name have the same hash.
+ * 
+ * @param record Record of this message.
+ * @return uint64_t Hash of owner name.
+ */
+uint64_t DNS::name_hash(const dns_record& record) const
+{
+    uint8_t name[256];
+    unsigned int length   = 0;
+    unsigned int offset   = record.name_offset;
+    unsigned int watchdog = 0;
 
-    /* parse questions */
-    for (unsigned int i = 0; i < this->question_count_; ++i) {
-        std::string ans = this->parse_name();
+    while (offset < this->length_ && this->base_ptr_[offset] && ++watchdog <= 256) {
+        unsigned int len = this->base_ptr_[offset];
 
-        /* end during name read */
-        if (this->incomplete_) {
-            return;
+        if (len >= 0xc0) {
+            if (offset + 2 > this->length_) {
+                break;
+            }
+
+            offset = ((len << 8) | this->base_ptr_[offset + 1]) & 16383;
+            continue;
         }
 
-        struct dns_question* question = reinterpret_cast<dns_question*>(ptr_);
+        if (offset + 1 + len > this->length_ || length + 1 + len > sizeof(name)) {
+            break;
+        }
+
+        name[length++] = len;
 
-        /* incomplete packet check */
-        if (ptr_ + DNS_QUESTION_LEN > end_ptr_) {
-            this->incomplete_ = true;
-            return;
+        for (unsigned int i = 1; i <= len; ++i) {
+            uint8_t c      = this->base_ptr_[offset + i];
+            name[length++] = (c >= 'A' && c <= 'Z') ? c | 0x20 : c;
         }
 
-        ans += " " + this->parse_type(ntohs(question->type));
-        ptr_ += sizeof(struct dns_question);
+        offset += len + 1;
+    }
+
+    return hash_bytes(name, length);
+}
 
-        this->questions_.push_back(ans);
+/**
+ * @brief Copies owner name of record in wire form (labels and terminating zero).
+ * 
+ * Copy ends at compression pointer, so only names which are not compressed
+ * (e.g. first question) are complete.
+ * 
+ * @param record Record of this message.
+ * @return std::string Encoded name.
+ */
+std::string DNS::wire_name(const dns_record& record) const
+{
+    unsigned int offset = record.name_offset;
+
+    /* labels were checked by skip_name() while parsing */
+    while (this->base_ptr_[offset] && this->base_ptr_[offset] < 0xc0) {
+        offset += this->base_ptr_[offset] + 1;
     }
 
-    /* parse answers */
-    for (unsigned int i = 0; i < this->answer_count_; ++i) {
-        std::string ans = this->parse_name();
+    std::string name(reinterpret_cast<const char*>(this->base_ptr_ + record.name_offset), offset - record.name_offset);
+    name += '\0';
 
-        /* end during name read */
-        if (this->incomplete_) {
-            return;
-        }
+    return name;
+}
 
-        struct dns_rr* rr = reinterpret_cast<dns_rr*>(ptr_);
+/**
+ * @brief Interns owner name of record.
+ * 
+ * @param record Record of this message.
+ * @param table Interning table (global one by default).
+ * @return uint32_t Compact ID of owner name within table.
+ */
+uint32_t DNS::name_id(const dns_record& record, DNSNameTable& table) const
+{
+    return table.intern(this->parse_name(record.name_offset));
+}
 
-        /* incomplete packet check */
-        if (ptr_ + DNS_RR_LEN > end_ptr_) {
-            this->incomplete_ = true;
-            return;
-        }
+/**
+ * @brief Getter of record data.
+ * 
+ * @param record Record of this message.
+ * @return const uint8_t* Pointer to rdata (record.rdata_length bytes).
+ */
+const uint8_t* DNS::rdata(const dns_record& record) const
+{
+    return this->base_ptr_ + record.rdata_offset;
+}
+
+/**
+ * @brief Decodes A record.
+ * 
+ * @param record Record of this message.
+ * @param address Filled with IPv4 address (network byte order).
+ * @return true Record is valid A record.
+ * @return false Otherwise.
+ */
+bool DNS::a(const dns_record& record, uint32_t& address) const
+{
+    if (record.type != DNS_TYPE_A || record.rdata_length < 4) {
+        return false;
+    }
 
-        ans += " " + this->parse_type(ntohs(rr->type));
-        ptr_ += sizeof(struct dns_rr);
-        ans += " " + this->parse_rdata(ntohs(rr->type), ntohs(rr->rdlength));
+    memcpy(&address, this->rdata(record), 4);
 
-        this->answers_.push_back(ans);
+    return true;
+}
+
+/**
+ * @brief Decodes AAAA record.
+ * 
+ * @param record Record of this message.
+ * @param address Buffer of 16 bytes filled with IPv6 address.
+ * @return true Record is valid AAAA record.
+ * @return false Otherwise.
+ */
+bool DNS::aaaa(const dns_record& record, uint8_t* address) const
+{
+    if (record.type != DNS_TYPE_AAAA || record.rdata_length < 16) {
+        return false;
     }
 
-    /* parse authoritative servers */
-    for (unsigned int i = 0; i < this->authority_count_; ++i) {
-        std::string ans = this->parse_name();
+    memcpy(address, this->rdata(record), 16);
 
-        /* end during name read */
-        if (this->incomplete_) {
-            return;
-        }
+    return true;
+}
+
+/**
+ * @brief Decodes MX record.
+ * 
+ * @param record Record of this message.
+ * @param mx Filled with preference and exchange.
+ * @return true Record is valid MX record.
+ * @return false Otherwise.
+ */
+bool DNS::mx(const dns_record& record, dns_mx_data& mx) const
+{
+    if (record.type != DNS_TYPE_MX || record.rdata_length < 3) {
+        return false;
+    }
+
+    const uint8_t* data = this->rdata(record);
+
+    mx.preference = (data[0] << 8) | data[1];
+    mx.exchange   = this->parse_name(record.rdata_offset + 2);
+
+    return true;
+}
+
+/**
+ * @brief Decodes SOA record.
+ * 
+ * @param record Record of this message.
+ * @param soa Filled with SOA fields.
+ * @return true Record is valid SOA record.
+ * @return false Otherwise.
+ */
+bool DNS::soa(const dns_record& record, dns_soa_data& soa) const
+{
+    if (record.type != DNS_TYPE_SOA) {
+        return false;
+    }
+
+    unsigned int end     = record.rdata_offset + record.rdata_length;
+    unsigned int rname   = this->skip_name(record.rdata_offset);
+    unsigned int numbers = rname ? this->skip_name(rname) : 0;
+
+    if (!numbers || numbers + sizeof(struct dns_soa) > end) {
+        return false;
+    }
+
+    const struct dns_soa* soa_ptr = reinterpret_cast<const dns_soa*>(this->base_ptr_ + numbers);
+
+    soa.mname   = this->parse_name(record.rdata_offset);
+    soa.rname   = this->parse_name(rname);
+    soa.serial  = ntohl(soa_ptr->serial);
+    soa.refresh = ntohl(soa_ptr->refresh);
+    soa.retry   = ntohl(soa_ptr->retry);
+    soa.expire  = ntohl(soa_ptr->expire);
+    soa.minimum = ntohl(soa_ptr->minimum);
+
+    return true;
+}
+
+/**
+ * @brief Decodes RRSIG record.
+ * 
+ * @param record Record of this message.
+ * @param rrsig Filled with RRSIG fields, signature points into message.
+ * @return true Record is valid RRSIG record.
+ * @return false Otherwise.
+ */
+bool DNS::rrsig(const dns_record& record, dns_rrsig_data& rrsig) const
+{
+    if (record.type != DNS_TYPE_RRSIG || record.rdata_length < sizeof(struct dns_rssig)) {
+        return false;
+    }
+
+    unsigned int end    = record.rdata_offset + record.rdata_length;
+    unsigned int signer = record.rdata_offset + sizeof(struct dns_rssig);
+    unsigned int key    = this->skip_name(signer);
+
+    if (!key || key > end) {
+        return false;
+    }
+
+    const struct dns_rssig* rssig_ptr = reinterpret_cast<const dns_rssig*>(this->rdata(record));
+
+    rrsig.type_covered         = ntohs(rssig_ptr->type_covered);
+    rrsig.algorithm            = rssig_ptr->algorithm;
+    rrsig.labels               = rssig_ptr->labels;
+    rrsig.original_ttl         = ntohl(rssig_ptr->original_ttl);
+    rrsig.signature_expiration = ntohl(rssig_ptr->signature_expiration);
+    rrsig.signature_inception  = ntohl(rssig_ptr->signature_incepition);
+    rrsig.key_tag              = ntohs(rssig_ptr->key_tag);
+    rrsig.signer               = this->parse_name(signer);
+    rrsig.signature            = this->base_ptr_ + key;
+    rrsig.signature_length     = end - key;
+
+    return true;
+}
+
+/**
+ * @brief Renders record in text form (name, type and data).
+ * 
+ * @param record Record of this message.
+ * @return std::string Same representation as in questions(), answers(), ...
+ */
+std::string DNS::text(const dns_record& record) const
+{
+    const std::string& name = this->parse_name(record.name_offset);
+    std::string text;
+
+    /* name, type and short rdata (addresses) without reallocation */
+    text.reserve(name.length() + 64);
+    text += name;
+    text += ' ';
+    text += this->parse_type(record.type);
+
+    if (record.section != DNS_SECTION_QUESTION) {
+        text += ' ';
+        text += this->parse_rdata(record);
+    }
+
+    return text;
+}
+
+/**
+ * @brief Renders one section, result is cached.
+ * 
+ * @param section Section identifier (DNS_SECTION_*).
+ * @return const std::vector<std::string>& Rendered records of section.
+ */
+const std::vector<std::string>& DNS::section(uint8_t section) const
+{
+    std::vector<std::string>& rendered = this->sections_[section];
 
-        struct dns_rr* rr = reinterpret_cast<dns_rr*>(ptr_);
+    if (this->rendered_ & (1u << section)) {
+        return rendered;
+    }
 
-        /* incomplete packet check */
-        if (ptr_ + DNS_RR_LEN > end_ptr_) {
-            this->incomplete_ = true;
-            return;
+    for (const dns_record& record : this->records_) {
+        if (record.section == section) {
+            rendered.push_back(this->text(record));
         }
+    }
 
-        ans += " " + this->parse_type(ntohs(rr->type));
-        ptr_ += sizeof(struct dns_rr);
-        ans += " " + this->parse_rdata(ntohs(rr->type), ntohs(rr->rdlength));
+    this->rendered_ |= 1u << section;
 
-        this->authoritatives_.push_back(ans);
+    return rendered;
+}
+
+/**
+ * @brief Parses DNS - only structure, names and rdata are decoded on demand.
+ */
+void DNS::parse()
+{
+    /* malform/incomplete packet check */
+    if (this->length_ < DNS_HDR_LEN) {
+        this->incomplete_ = true;
+        return;
     }
 
-    /* parse additionals rrs */
-    for (unsigned int i = 0; i < this->additional_count_; ++i) {
-        std::string ans = this->parse_name();
+    /* header */
+    this->id_               = ntohs(this->raw_header_->id);
+    this->qr_               = this->raw_header_->qr__opcode__aa__tc__rd__ra >> 7;
+    this->rcode_            = this->raw_header_->z__rcode & 0xf;
+    this->question_count_   = ntohs(this->raw_header_->qdcount);
+    this->answer_count_     = ntohs(this->raw_header_->ancount);
+    this->authority_count_  = ntohs(this->raw_header_->nscount);
+    this->additional_count_ = ntohs(this->raw_header_->arcount);
+
+    const unsigned int counts[4] = { this->question_count_,
+                                     this->answer_count_,
+                                     this->authority_count_,
+                                     this->additional_count_ };
+
+    /* skip header */
+    unsigned int offset = DNS_HDR_LEN;
+
+    for (uint8_t section = DNS_SECTION_QUESTION; section <= DNS_SECTION_ADDITIONAL; ++section) {
+        for (unsigned int i = 0; i < counts[section]; ++i) {
+            dns_record record;
+            unsigned int end = this->skip_name(offset);
+
+            /* end during name read */
+            if (!end) {
+                this->incomplete_ = true;
+                return;
+            }
+
+            record.section      = section;
+            record.name_offset  = offset;
+            record.ttl          = 0;
+            record.rdata_offset = 0;
+            record.rdata_length = 0;
+
+            if (section == DNS_SECTION_QUESTION) {
+                /* incomplete packet check */
+                if (end + DNS_QUESTION_LEN > this->length_) {
+                    this->incomplete_ = true;
+                    return;
+                }
+
+                const struct dns_question* question = reinterpret_cast<const dns_question*>(this->base_ptr_ + end);
+
+                record.type     = ntohs(question->type);
+                record.rr_class = ntohs(question->rr_class);
+                offset          = end + DNS_QUESTION_LEN;
+            } else {
+                /* incomplete packet check */
+                if (end + DNS_RR_LEN > this->length_) {
+                    this->incomplete_ = true;
+                    return;
+                }
+
+                const struct dns_rr* rr = reinterpret_cast<const dns_rr*>(this->base_ptr_ + end);
+
+                record.type         = ntohs(rr->type);
+                record.rr_class     = ntohs(rr->rr_class);
+                record.ttl          = ntohl(rr->ttl);
+                record.rdata_offset = end + DNS_RR_LEN;
+                record.rdata_length = ntohs(rr->rdlength);
+                offset              = record.rdata_offset + record.rdata_length;
+
+                /* rdata beyond end of message */
+                if (offset > this->length_) {
+                    this->incomplete_ = true;
+                    return;
+                }
+            }
 
-        /* end during name read */
-        if (this->incomplete_) {
-            return;
+            this->records_.push_back(record);
         }
+    }
+}
 
-        struct dns_rr* rr = reinterpret_cast<dns_rr*>(ptr_);
+/**
+ * @brief Finds end of domain name without decoding it.
+ * 
+ * @param offset Offset of name in message.
+ * @return unsigned int Offset right behind name, 0 for malformed name.
+ */
+unsigned int DNS::skip_name(unsigned int offset) const
+{
+    while (offset < this->length_) {
+        unsigned int len = this->base_ptr_[offset];
 
-        /* incomplete packet check */
-        if (ptr_ + DNS_RR_LEN > end_ptr_) {
-            this->incomplete_ = true;
-            return;
+        if (len == 0) {
+            return offset + 1;
         }
 
-        ans += " " + this->parse_type(ntohs(rr->type));
-        ptr_ += sizeof(struct dns_rr);
-        ans += " " + this->parse_rdata(ntohs(rr->type), ntohs(rr->rdlength));
+        if (len >= 0xc0) {
+            /* pointer terminates name */
+            return offset + 2 <= this->length_ ? offset + 2 : 0;
+        }
 
-        this->additionals_.push_back(ans);
+        offset += len + 1;
     }
+
+    return 0;
 }
 
 /**
- * @brief Parses domain names.
+ * @brief Parses domain names, result is memoized by offset.
  * 
- * @return std::string String representation of domain name.
+ * Compression pointer to already decoded name reuses it instead of
+ * following labels again.
+ * 
+ * @param offset Offset of name in message.
+ * @return const std::string& String representation of domain name.
  */
-std::string DNS::parse_name(uint8_t* ptr)
+const std::string& DNS::parse_name(unsigned int offset) const
 {
-    std::string name = "";
-    uint8_t* p;
-    uint8_t* end_p = nullptr;
+    auto cached = this->names_.find(offset);
 
-    if (!ptr) {
-        p = this->ptr_;
-    } else {
-        p = ptr;
+    if (cached != this->names_.end()) {
+        return cached->second;
     }
 
+    std::string& name = this->names_[offset];
+
     unsigned int len      = 0;
-    unsigned int i        = 0;
     unsigned int watchdog = 0;
 
     /* name ends w/ 0x00 */
-    while (*p) {
-        if (p >= this->end_ptr_) {
-            this->incomplete_ = true;
-            return name;
-        }
-
-        len = *p;
+    while (offset < this->length_ && this->base_ptr_[offset]) {
+        len = this->base_ptr_[offset];
 
         if (len < 0xc0) {
             /* is string part */
-            ++p;
-
-            for (i = 0; i < len; i++) {
-                name += *p;
-                ++p;
+            if (offset + 1 + len > this->length_) {
+                break;
             }
 
+            name.append(reinterpret_cast<const char*>(this->base_ptr_ + offset + 1), len);
             name += ".";
+            offset += len + 1;
         } else {
             /* is offset */
-            uint16_t offset = *p;
+            if (offset + 2 > this->length_) {
+                break;
+            }
 
-            offset <<= 8;
-            ++p;
-            offset += *p;
-            offset &= 16383;
+            offset = ((len << 8) | this->base_ptr_[offset + 1]) & 16383;
 
-            /* is endbyte - offset only backwards */
-            if (!end_p) {
-                end_p = p + 1;
-            }
+            /* suffix already decoded */
+            cached = this->names_.find(offset);
 
-            p = base_ptr_ + offset;
+            if (cached != this->names_.end() && &cached->second != &name) {
+                if (cached->second != ".") {
+                    name += cached->second + ".";
+                }
+                break;
+            }
         }
 
         /* infinite loop watchdog - pointers */
@@ -318,15 +636,6 @@ std::string DNS::parse_name(uint8_t* ptr)
         }
     }
 
-    /* no offset pointers were encountered */
-    if (!end_p) {
-        end_p = p + 1;
-    }
-
-    if (!ptr) {
-        ptr_ = end_p;
-    }
-
     if (name.length() == 0) {
         name += ".";
     } else {
@@ -340,9 +649,9 @@ std::string DNS::parse_name(uint8_t* ptr)
  * @brief Parses type.
  * 
  * @param type Type of RR.
- * @return std::string String representation of type. (e.g. A, MX, NS)
+ * @return const char* Static string representation of type. (e.g. A, MX, NS)
  */
-std::string DNS::parse_type(uint16_t type)
+const char* DNS::parse_type(uint16_t type) const
 {
     switch (type) {
     case 1:
@@ -401,259 +710,217 @@ std::string DNS::parse_type(uint16_t type)
 }
 
 /**
- * @brief Parses data of resource record.
+ * @brief Renders data of resource record.
  * 
- * @param type Type of RR.
+ * @param record Record of this message.
  * @return std::string String representation of data.
  */
-std::string DNS::parse_rdata(uint16_t type, uint16_t length)
+std::string DNS::parse_rdata(const dns_record& record) const
 {
     const char hex_arr[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
 
     std::string data = "";
-    std::string tmp  = "";
 
-    struct in_addr ipv4_addr;
-    struct in6_addr ipv6_addr;
-    struct dns_soa* soa_ptr;
-    struct dns_rssig* rssig_ptr;
-    struct dns_ds* ds_ptr;
-    struct dns_dnskey* dnskey_ptr;
-
-    time_t time_tmp;
-    char time_buf[sizeof "2011-10-08T07:07:09Z"];
+    const uint8_t* ptr = this->rdata(record);
+    unsigned int end   = record.rdata_offset + record.rdata_length;
 
     char ipv4_buf[INET_ADDRSTRLEN];
     char ipv6_buf[INET6_ADDRSTRLEN];
-    uint32_t ip_addr = 0;
+    uint8_t ipv6_addr[16];
+    uint32_t ipv4_addr;
+
+    time_t time_tmp;
+    char time_buf[sizeof "2011-10-08T07:07:09Z"];
 
-    uint8_t* bkup;
+    const struct dns_ds* ds_ptr;
+    const struct dns_dnskey* dnskey_ptr;
 
-    unsigned int tmp_length;
-    int16_t preference;
+    dns_mx_data mx;
+    dns_soa_data soa;
+    dns_rrsig_data rrsig;
+    unsigned int skip;
 
-    switch (type) {
-    case 1:
-        /* A */
-        for (int i = 0; i < 4; i++) {
-            ip_addr += ptr_[i];
-            if (i != 3)
-                ip_addr = ip_addr << 8;
+    switch (record.type) {
+    case DNS_TYPE_A:
+        if (!this->a(record, ipv4_addr)) {
+            break;
         }
-        ip_addr = ntohl(ip_addr);
 
         /* convert ip */
-        ipv4_addr.s_addr = ip_addr;
         if (inet_ntop(AF_INET, &ipv4_addr, ipv4_buf, INET_ADDRSTRLEN) == nullptr) {
-            data = "INVALID IP";
-        } else {
-            data = std::string(ipv4_buf);
+            return "INVALID IP";
         }
 
-        ptr_ += length;
-        return data;
+        return std::string(ipv4_buf);
 
-    case 2:
-        /* NS */
-        data = this->parse_name(ptr_);
-        ptr_ += length;
-        return data;
+    case DNS_TYPE_NS:
+    case DNS_TYPE_CNAME:
+    case DNS_TYPE_PTR:
+        return this->parse_name(record.rdata_offset);
 
-    case 5:
-        /* CNAME */
-        data = this->parse_name(ptr_);
-        ptr_ += length;
-        return data;
+    case DNS_TYPE_SOA:
+        if (!this->soa(record, soa)) {
+            break;
+        }
 
-    case 6:
-        /* SOA */
-        bkup = ptr_;
-        tmp  = this->parse_name(); /* mname */
-        data += '"' + tmp + " ";
-        tmp = this->parse_name(); /* rname */
-        data += tmp + " ";
-
-        soa_ptr = reinterpret_cast<dns_soa*>(ptr_);
-
-        data += std::to_string(ntohl(soa_ptr->serial)) + " ";
-        data += std::to_string(ntohl(soa_ptr->refresh)) + " ";
-        data += std::to_string(ntohl(soa_ptr->retry)) + " ";
-        data += std::to_string(ntohl(soa_ptr->expire)) + " ";
-        data += std::to_string(ntohl(soa_ptr->minimum));
+        data += '"' + soa.mname + " ";
+        data += soa.rname + " ";
+        data += std::to_string(soa.serial) + " ";
+        data += std::to_string(soa.refresh) + " ";
+        data += std::to_string(soa.retry) + " ";
+        data += std::to_string(soa.expire) + " ";
+        data += std::to_string(soa.minimum);
         data += '"';
 
-        ptr_ = bkup + length;
-
-        return data;
-
-    case 12:
-        /* PTR */
-        data = this->parse_name(); /* ptrdname */
         return data;
 
-    case 15:
-        /* MX */
-        bkup = ptr_;
-
-        /* load prefernce */
-        preference = ptr_[0];
-        preference <<= 8;
-        preference += ptr_[1];
+    case DNS_TYPE_MX:
+        if (!this->mx(record, mx)) {
+            break;
+        }
 
-        data = std::to_string(preference) + " ";
-        ptr_ += 2;
-        data += this->parse_name();
+        /* preference was always printed as signed */
+        data = std::to_string(static_cast<int16_t>(mx.preference)) + " ";
+        data += mx.exchange;
 
-        ptr_ = bkup + length;
         return data;
 
-    case 28:
-        /* AAAA */
-        for (unsigned int i = 0; i < 16; ++i) {
-            ipv6_addr.__in6_u.__u6_addr8[i] = ptr_[i];
+    case DNS_TYPE_AAAA:
+        if (!this->aaaa(record, ipv6_addr)) {
+            break;
         }
 
         /* convert ip */
-        if (inet_ntop(AF_INET6, &ipv6_addr, ipv6_buf, INET6_ADDRSTRLEN) == nullptr) {
-            data = "INVALID IPv6";
-        } else {
-            data = std::string(ipv6_buf);
+        if (inet_ntop(AF_INET6, ipv6_addr, ipv6_buf, INET6_ADDRSTRLEN) == nullptr) {
+            return "INVALID IPv6";
         }
 
-        ptr_ += length;
-        return data;
-
-    case 43:
-        /* DS */
-        bkup   = ptr_;
-        ds_ptr = reinterpret_cast<dns_ds*>(ptr_);
-        data   = '"' + std::to_string(ntohs(ds_ptr->key_tag)) + " ";
+        return std::string(ipv6_buf);
 
-        data += this->parse_dnssec_algorithm(ds_ptr->algorithm) + " ";
-        data += this->parse_digest_type(ds_ptr->digest_type) + " ";
+    case DNS_TYPE_DS:
+        if (record.rdata_length < sizeof(struct dns_ds)) {
+            break;
+        }
 
-        ptr_ += sizeof(struct dns_ds);
+        ds_ptr = reinterpret_cast<const dns_ds*>(ptr);
+        data   = '"' + std::to_string(ntohs(ds_ptr->key_tag)) + " ";
 
-        tmp_length = length - (ptr_ - bkup);
+        data += this->parse_dnssec_algorithm(ds_ptr->algorithm);
+        data += " ";
+        data += this->parse_digest_type(ds_ptr->digest_type);
+        data += " ";
 
-        for (unsigned int i = 0; i < tmp_length; ++i) {
-            data += hex_arr[ptr_[i] / 16];
-            data += hex_arr[ptr_[i] % 16];
+        for (unsigned int i = sizeof(struct dns_ds); i < record.rdata_length; ++i) {
+            data += hex_arr[ptr[i] / 16];
+            data += hex_arr[ptr[i] % 16];
         }
 
         data += '"';
 
-        ptr_ = bkup + length;
         return data;
 
-    case 46:
-        /* RSSIG */
-        bkup = ptr_;
-
-        rssig_ptr = reinterpret_cast<dns_rssig*>(ptr_);
-
-        tmp = this->parse_type(ntohs(rssig_ptr->type_covered));
-        data += '"' + tmp + " ";
-
-        tmp = this->parse_dnssec_algorithm(rssig_ptr->algorithm);
-        data += tmp + " ";
-
-        data += std::to_string(rssig_ptr->labels) + " ";
-        data += std::to_string(ntohl(rssig_ptr->original_ttl)) + " ";
+    case DNS_TYPE_RRSIG:
+        if (!this->rrsig(record, rrsig)) {
+            break;
+        }
 
-        time_tmp = ntohl(rssig_ptr->signature_expiration);
+        data += '"';
+        data += this->parse_type(rrsig.type_covered);
+        data += " ";
+        data += this->parse_dnssec_algorithm(rrsig.algorithm);
+        data += " ";
+        data += std::to_string(rrsig.labels) + " ";
+        data += std::to_string(rrsig.original_ttl) + " ";
+
+        time_tmp = rrsig.signature_expiration;
         strftime(time_buf, sizeof(time_buf), "%FT%T", localtime(&time_tmp));
         data += std::string(time_buf) + " ";
 
-        time_tmp = ntohl(rssig_ptr->signature_incepition);
+        time_tmp = rrsig.signature_inception;
         strftime(time_buf, sizeof(time_buf), "%FT%T", localtime(&time_tmp));
         data += std::string(time_buf) + " ";
 
-        data += std::to_string(ntohs(rssig_ptr->key_tag)) + " ";
-        ptr_ += sizeof(struct dns_rssig);
-
-        data += this->parse_name() + " ";
+        data += std::to_string(rrsig.key_tag) + " ";
+        data += rrsig.signer + " ";
 
-        tmp_length = length - (ptr_ - bkup);
-
-        for (unsigned int i = 0; i < tmp_length; ++i) {
-            data += hex_arr[ptr_[i] / 16];
-            data += hex_arr[ptr_[i] % 16];
+        for (unsigned int i = 0; i < rrsig.signature_length; ++i) {
+            data += hex_arr[rrsig.signature[i] / 16];
+            data += hex_arr[rrsig.signature[i] % 16];
         }
 
         data += '"';
 
-        ptr_ = bkup + length;
         return data;
 
-    case 47:
-        /* NSEC */
-        bkup = ptr_;
+    case DNS_TYPE_NSEC:
+        skip = this->skip_name(record.rdata_offset);
 
-        data = '"' + this->parse_name() + " ";
+        if (!skip || skip > end) {
+            break;
+        }
 
-        tmp_length = length - (ptr_ - bkup);
+        data = '"' + this->parse_name(record.rdata_offset) + " ";
 
-        for (unsigned int i = 0; i < tmp_length; ++i) {
-            data += hex_arr[ptr_[i] / 16];
-            data += hex_arr[ptr_[i] % 16];
+        for (unsigned int i = skip; i < end; ++i) {
+            data += hex_arr[this->base_ptr_[i] / 16];
+            data += hex_arr[this->base_ptr_[i] % 16];
         }
 
         data += '"';
 
-        ptr_ = bkup + length;
         return data;
 
-    case 48:
-        /* DNSKEY */
-        bkup       = ptr_;
-        dnskey_ptr = reinterpret_cast<dns_dnskey*>(ptr_);
+    case DNS_TYPE_DNSKEY:
+        if (record.rdata_length < sizeof(struct dns_dnskey)) {
+            break;
+        }
+
+        dnskey_ptr = reinterpret_cast<const dns_dnskey*>(ptr);
 
         data += "\"0x";
 
         /* flags */
         for (unsigned int i = 0; i < 2; ++i) {
-            data += hex_arr[ptr_[i] / 16];
-            data += hex_arr[ptr_[i] % 16];
+            data += hex_arr[ptr[i] / 16];
+            data += hex_arr[ptr[i] % 16];
         }
 
         /* protocol and algorithm */
         data += " " + std::to_string(dnskey_ptr->protocol);
-        data += " " + this->parse_dnssec_algorithm(dnskey_ptr->algorithm) + " ";
-
-        ptr_ += sizeof(struct dns_dnskey);
-
-        tmp_length = length - (ptr_ - bkup);
+        data += " ";
+        data += this->parse_dnssec_algorithm(dnskey_ptr->algorithm);
+        data += " ";
 
         /* public key */
-        for (unsigned int i = 0; i < tmp_length; ++i) {
-            data += hex_arr[ptr_[i] / 16];
-            data += hex_arr[ptr_[i] % 16];
+        for (unsigned int i = sizeof(struct dns_dnskey); i < record.rdata_length; ++i) {
+            data += hex_arr[ptr[i] / 16];
+            data += hex_arr[ptr[i] % 16];
         }
 
         data += '"';
 
-        ptr_ = bkup + length;
         return data;
 
     default:
-        for (unsigned int i = 0; i < length; ++i) {
-            data += hex_arr[ptr_[i] / 16];
-            data += hex_arr[ptr_[i] % 16];
-        }
+        break;
+    }
 
-        ptr_ += length;
-        return data;
+    /* unknown or malformed data */
+    for (unsigned int i = 0; i < record.rdata_length; ++i) {
+        data += hex_arr[ptr[i] / 16];
+        data += hex_arr[ptr[i] % 16];
     }
+
+    return data;
 }
 
 /**
  * @brief Parses DNSSEC algorithm field.
  * 
  * @param algorithm 8-bit algorithm field.
- * @return std::string String representation of algorithm.
+ * @return const char* Static string representation of algorithm.
  */
-std::string DNS::parse_dnssec_algorithm(uint8_t algorithm)
+const char* DNS::parse_dnssec_algorithm(uint8_t algorithm) const
 {
     switch (algorithm) {
     case 1:
@@ -699,9 +966,9 @@ std::string DNS::parse_dnssec_algorithm(uint8_t algorithm)
  * @brief Parses DS digest type.
  * 
  * @param digest_type 8-bit digest type.
- * @return std::string 
+ * @return const char* Static string representation of digest type.
  */
-std::string DNS::parse_digest_type(uint8_t digest_type)
+const char* DNS::parse_digest_type(uint8_t digest_type) const
 {
     switch (digest_type) {
     case 1:
@@ -716,4 +983,103 @@ std::string DNS::parse_digest_type(uint8_t digest_type)
         return "UNKNOWN";
     }
 }
+
+/**
+ * @brief Interns domain name.
+ * 
+ * @param name Domain name.
+ * @return uint32_t ID of name (existing or newly assigned).
+ */
+uint32_t DNSNameTable::intern(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    auto it = this->ids_.find(name);
+
+    if (it != this->ids_.end()) {
+        return it->second;
+    }
+
+    uint32_t id = this->names_.size();
+
+    this->names_.push_back(name);
+    this->ids_.emplace(name, id);
+
+    return id;
+}
+
+/**
+ * @brief Translates ID back to name.
+ * 
+ * @param id ID returned by intern().
+ * @return std::string Domain name or empty string for unknown ID.
+ */
+std::string DNSNameTable::lookup(uint32_t id) const
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (id >= this->names_.size()) {
+        return "";
+    }
+
+    return this->names_[id];
+}
+
+/**
+ * @brief Looks up ID of name without interning it.
+ * 
+ * @param name Domain name.
+ * @param id Filled with ID if name is known.
+ * @return true Name is interned.
+ * @return false Otherwise.
+ */
+bool DNSNameTable::find(const std::string& name, uint32_t& id) const
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    auto it = this->ids_.find(name);
+
+    if (it == this->ids_.end()) {
+        return false;
+    }
+
+    id = it->second;
+
+    return true;
+}
+
+/**
+ * @brief Getter of number of interned names.
+ * 
+ * @return size_t Number of names.
+ */
+size_t DNSNameTable::size() const
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    return this->names_.size();
+}
+
+/**
+ * @brief Drops all names, previously returned IDs become invalid.
+ */
+void DNSNameTable::clear()
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->ids_.clear();
+    this->names_.clear();
+}
+
+/**
+ * @brief Getter of process-wide table.
+ * 
+ * @return DNSNameTable& Global table.
+ */
+DNSNameTable& DNSNameTable::global()
+{
+    static DNSNameTable table;
+
+    return table;
+}
 }
@@ -14,8 +14,11 @@
 #ifndef DISSPCAP_DNS_H
 #define DISSPCAP_DNS_H
 
+#include <deque>
+#include <mutex>
 #include <stdint.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace disspcap {
@@ -24,6 +27,23 @@ const uint8_t DNS_HDR_LEN      = 12; /**< DNS header length. */
 const uint8_t DNS_QUESTION_LEN = 4;  /**< DNS question header length. */
 const uint8_t DNS_RR_LEN       = 10; /**< DNS resource record header length. */
 
+const uint8_t DNS_SECTION_QUESTION   = 0; /**< Question section. */
+const uint8_t DNS_SECTION_ANSWER     = 1; /**< Answer section. */
+const uint8_t DNS_SECTION_AUTHORITY  = 2; /**< Authority section. */
+const uint8_t DNS_SECTION_ADDITIONAL = 3; /**< Additional section. */
+
+const uint16_t DNS_TYPE_A      = 1;  /**< IPv4 address. */
+const uint16_t DNS_TYPE_NS     = 2;  /**< Authoritative name server. */
+const uint16_t DNS_TYPE_CNAME  = 5;  /**< Canonical name. */
+const uint16_t DNS_TYPE_SOA    = 6;  /**< Start of authority. */
+const uint16_t DNS_TYPE_PTR    = 12; /**< Domain name pointer. */
+const uint16_t DNS_TYPE_MX     = 15; /**< Mail exchange. */
+const uint16_t DNS_TYPE_AAAA   = 28; /**< IPv6 address. */
+const uint16_t DNS_TYPE_DS     = 43; /**< Delegation signer. */
+const uint16_t DNS_TYPE_RRSIG  = 46; /**< DNSSEC signature. */
+const uint16_t DNS_TYPE_NSEC   = 47; /**< Next secure record. */
+const uint16_t DNS_TYPE_DNSKEY = 48; /**< DNSSEC key. */
+
 /**
  * @brief DNS header part struct.
  */
@@ -97,14 +117,95 @@ struct dns_dnskey {
     uint8_t algorithm;
 } __attribute__((packed));
 
+/**
+ * @brief Question or resource record - offsets into DNS message.
+ * 
+ * Questions have zero TTL and empty rdata.
+ */
+struct dns_record {
+    uint8_t section;
+    uint16_t type;
+    uint16_t rr_class;
+    uint32_t ttl;
+    uint16_t name_offset;
+    uint16_t rdata_offset;
+    uint16_t rdata_length;
+};
+
+/**
+ * @brief Decoded MX rdata.
+ */
+struct dns_mx_data {
+    unsigned int preference;
+    std::string exchange;
+};
+
+/**
+ * @brief Decoded SOA rdata.
+ */
+struct dns_soa_data {
+    std::string mname;
+    std::string rname;
+    uint32_t serial;
+    uint32_t refresh;
+    uint32_t retry;
+    uint32_t expire;
+    uint32_t minimum;
+};
+
+/**
+ * @brief Decoded RRSIG rdata.
+ */
+struct dns_rrsig_data {
+    uint16_t type_covered;
+    uint8_t algorithm;
+    uint8_t labels;
+    uint32_t original_ttl;
+    uint32_t signature_expiration;
+    uint32_t signature_inception;
+    uint16_t key_tag;
+    std::string signer;
+    const uint8_t* signature;
+    unsigned int signature_length;
+};
+
+/**
+ * @brief Thread-safe table assigning compact IDs to domain names.
+ * 
+ * IDs are dense (0, 1, 2, ...) and never released, so the table only
+ * grows. Use global() for process-wide table shared by all messages.
+ */
+class DNSNameTable {
+public:
+    uint32_t intern(const std::string& name);
+    std::string lookup(uint32_t id) const;
+    bool find(const std::string& name, uint32_t& id) const;
+    size_t size() const;
+    void clear();
+    static DNSNameTable& global();
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::deque<std::string> names_;
+};
+
 /**
  * @brief DNS class holding DNS related information.
+ * 
+ * Parsing only records structure of message (dns_record), names and rdata
+ * are decoded on demand. String getters (questions(), answers(), ...) render
+ * their section on first use. Decoded names are memoized by offset, so every
+ * compression pointer target is decompressed once per message.
+ * Data passed to constructor must outlive object.
  */
 class DNS {
 public:
     DNS(uint8_t* data, int data_length);
     bool is_incomplete() const;
+    unsigned int id() const;
     unsigned int qr() const;
+    unsigned int rcode() const;
     unsigned int question_count() const;
     unsigned int answer_count() const;
     unsigned int authority_count() const;
@@ -113,28 +214,43 @@ public:
     const std::vector<std::string>& answers() const;
     const std::vector<std::string>& authoritatives() const;
     const std::vector<std::string>& additionals() const;
+    const std::vector<dns_record>& records() const;
+    std::string name(const dns_record& record) const;
+    uint64_t name_hash(const dns_record& record) const;
+    std::string wire_name(const dns_record& record) const;
+    uint32_t name_id(const dns_record& record, DNSNameTable& table = DNSNameTable::global()) const;
+    const uint8_t* rdata(const dns_record& record) const;
+    bool a(const dns_record& record, uint32_t& address) const;
+    bool aaaa(const dns_record& record, uint8_t* address) const;
+    bool mx(const dns_record& record, dns_mx_data& mx) const;
+    bool soa(const dns_record& record, dns_soa_data& soa) const;
+    bool rrsig(const dns_record& record, dns_rrsig_data& rrsig) const;
+    std::string text(const dns_record& record) const;
 
 private:
+    unsigned int id_;
     unsigned int qr_;
+    unsigned int rcode_;
     unsigned int question_count_;
     unsigned int answer_count_;
     unsigned int authority_count_;
     unsigned int additional_count_;
     bool incomplete_;
     struct dns_header* raw_header_;
-    uint8_t* ptr_;
     uint8_t* base_ptr_;
-    uint8_t* end_ptr_;
-    std::vector<std::string> questions_;
-    std::vector<std::string> answers_;
-    std::vector<std::string> authoritatives_;
-    std::vector<std::string> additionals_;
+    unsigned int length_;
+    std::vector<dns_record> records_;
+    mutable unsigned int rendered_;
+    mutable std::vector<std::string> sections_[4];
+    mutable std::unordered_map<uint16_t, std::string> names_;
     void parse();
-    std::string parse_name(uint8_t* ptr = nullptr);
-    std::string parse_type(uint16_t type);
-    std::string parse_rdata(uint16_t type, uint16_t length);
-    std::string parse_dnssec_algorithm(uint8_t algorithm);
-    std::string parse_digest_type(uint8_t digest_type);
+    const std::vector<std::string>& section(uint8_t section) const;
+    unsigned int skip_name(unsigned int offset) const;
+    const std::string& parse_name(unsigned int offset) const;
+    const char* parse_type(uint16_t type) const;
+    std::string parse_rdata(const dns_record& record) const;
+    const char* parse_dnssec_algorithm(uint8_t algorithm) const;
+    const char* parse_digest_type(uint8_t digest_type) const;
 };
 }
 
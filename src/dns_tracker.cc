@@ -0,0 +1,309 @@
+/**
+ * @file dns_tracker.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief DNS query/response matching and resolution latency.
+ * @version 0.1
+ * @date 2019-05-06
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#include "dns_tracker.h"
+
+#include <cstring>
+
+#include "common.h"
+
+namespace disspcap {
+
+/**
+ * @brief Compares two query keys.
+ * 
+ * @param other Key to compare with.
+ * @return true Keys are equal.
+ * @return false Keys differ.
+ */
+bool dns_query_key::operator==(const dns_query_key& other) const
+{
+    return std::memcmp(this, &other, sizeof(dns_query_key)) == 0;
+}
+
+/**
+ * @brief Hashes query key.
+ * 
+ * @param key Query key.
+ * @return size_t Hash value.
+ */
+size_t dns_query_key_hash::operator()(const dns_query_key& key) const
+{
+    return hash_bytes(&key, sizeof(dns_query_key));
+}
+
+/**
+ * @brief Compares two resolver keys.
+ * 
+ * @param other Key to compare with.
+ * @return true Keys are equal.
+ * @return false Keys differ.
+ */
+bool dns_resolver_key::operator==(const dns_resolver_key& other) const
+{
+    return std::memcmp(this, &other, sizeof(dns_resolver_key)) == 0;
+}
+
+/**
+ * @brief Hashes resolver key.
+ * 
+ * @param key Resolver key.
+ * @return size_t Hash value.
+ */
+size_t dns_resolver_key_hash::operator()(const dns_resolver_key& key) const
+{
+    return hash_bytes(&key, sizeof(dns_resolver_key));
+}
+
+/**
+ * @brief Renders question kept in wire form, same as DNS::text() of query.
+ * 
+ * @param name Question name in wire form (DNS::wire_name()).
+ * @param type Question type.
+ * @param rr_class Question class.
+ * @return std::string Question (e.g. "example.com A").
+ */
+static std::string render_question(const std::string& name, uint16_t type, uint16_t rr_class)
+{
+    std::string message(DNS_HDR_LEN, '\0');
+
+    /* message with single question */
+    message[5] = 1;
+    message += name;
+    message += static_cast<char>(type >> 8);
+    message += static_cast<char>(type & 0xff);
+    message += static_cast<char>(rr_class >> 8);
+    message += static_cast<char>(rr_class & 0xff);
+
+    DNS dns(reinterpret_cast<uint8_t*>(&message[0]), message.length());
+
+    return dns.records().empty() ? "" : dns.text(dns.records()[0]);
+}
+
+/**
+ * @brief Construct a new DNSTracker object.
+ * 
+ * @param max_pending Maximum number of outstanding queries.
+ * @param timeout Time (seconds) after which query is considered unanswered.
+ */
+DNSTracker::DNSTracker(unsigned int max_pending, double timeout)
+    : max_pending_{ max_pending }
+    , timeout_{ timeout }
+    , unmatched_responses_{ 0 }
+    , evicted_queries_{ 0 }
+{
+    this->pending_.reserve(max_pending);
+}
+
+/**
+ * @brief Processes packet - stores queries, matches responses.
+ * 
+ * @param packet Dissected packet.
+ */
+void DNSTracker::process(const Packet& packet)
+{
+    const DNS* dns = packet.dns();
+    dns_query_key key;
+
+    if (!dns || dns->records().empty() || dns->records()[0].section != DNS_SECTION_QUESTION ||
+        !make_flow_key(packet, key.flow)) {
+        return;
+    }
+
+    /* question is matched in wire form, text is rendered only for finished transactions */
+    double now                 = packet.timestamp();
+    const dns_record& question = dns->records()[0];
+
+    key.id             = dns->id();
+    key.question_type  = question.type;
+    key.question_class = question.rr_class;
+    key.question_hash  = dns->name_hash(question);
+
+    this->expire(now);
+
+    if (dns->qr() == 0) {
+        /* query - retransmissions keep the original query time */
+        if (this->pending_.find(key) != this->pending_.end()) {
+            return;
+        }
+
+        if (this->pending_.size() >= this->max_pending_ && !this->order_.empty()) {
+            ++this->evicted_queries_;
+            this->pop_oldest();
+        }
+
+        dns_pending_query query;
+        query.question   = dns->wire_name(question);
+        query.query_time = now;
+        query.position   = this->order_.insert(this->order_.end(), key);
+
+        this->pending_.insert(std::make_pair(key, query));
+        return;
+    }
+
+    /* response - look up query sent in opposite direction */
+    key.flow = key.flow.reversed();
+    auto it  = this->pending_.find(key);
+
+    if (it == this->pending_.end()) {
+        ++this->unmatched_responses_;
+        return;
+    }
+
+    this->transactions_.emplace_back();
+    dns_transaction& transaction = this->transactions_.back();
+
+    transaction.flow       = key.flow;
+    transaction.id         = key.id;
+    transaction.question   = dns->text(question);
+    transaction.answered   = true;
+    transaction.rcode      = dns->rcode();
+    transaction.query_time = it->second.query_time;
+    transaction.latency    = now - it->second.query_time;
+
+    for (const dns_record& record : dns->records()) {
+        if (record.section == DNS_SECTION_ANSWER) {
+            transaction.answers.push_back(dns->text(record));
+        }
+    }
+
+    dns_resolver_key resolver;
+    resolver.family = key.flow.family;
+    std::memcpy(resolver.address, key.flow.destination, FLOW_ADDR_LEN);
+
+    this->latencies_[resolver].add(transaction.latency);
+    this->order_.erase(it->second.position);
+    this->pending_.erase(it);
+}
+
+/**
+ * @brief Reports queries older than timeout as unanswered.
+ * 
+ * @param now Current time (seconds since epoch).
+ */
+void DNSTracker::expire(double now)
+{
+    while (!this->order_.empty()) {
+        if (now - this->pending_.find(this->order_.front())->second.query_time <= this->timeout_) {
+            break;
+        }
+
+        this->pop_oldest();
+    }
+}
+
+/**
+ * @brief Reports all outstanding queries as unanswered (e.g. at the end of pcap).
+ */
+void DNSTracker::flush()
+{
+    while (!this->order_.empty()) {
+        this->pop_oldest();
+    }
+}
+
+/**
+ * @brief Reports oldest outstanding query as unanswered and removes it.
+ */
+void DNSTracker::pop_oldest()
+{
+    auto it = this->pending_.find(this->order_.front());
+
+    this->record_unanswered(it->first, it->second);
+    this->order_.pop_front();
+    this->pending_.erase(it);
+}
+
+/**
+ * @brief Emits transaction of unanswered query.
+ * 
+ * @param key Query key.
+ * @param query Query information.
+ */
+void DNSTracker::record_unanswered(const dns_query_key& key, const dns_pending_query& query)
+{
+    this->transactions_.emplace_back();
+    dns_transaction& transaction = this->transactions_.back();
+
+    transaction.flow       = key.flow;
+    transaction.id         = key.id;
+    transaction.question   = render_question(query.question, key.question_type, key.question_class);
+    transaction.answered   = false;
+    transaction.rcode      = 0;
+    transaction.query_time = query.query_time;
+    transaction.latency    = 0;
+}
+
+/**
+ * @brief Getter of finished transactions.
+ * 
+ * @return const std::vector<dns_transaction>& Transactions in completion order.
+ */
+const std::vector<dns_transaction>& DNSTracker::transactions() const
+{
+    return this->transactions_;
+}
+
+/**
+ * @brief Drops already consumed transactions.
+ */
+void DNSTracker::clear_transactions()
+{
+    this->transactions_.clear();
+}
+
+/**
+ * @brief Getter of resolution latencies.
+ * 
+ * Addresses are formatted here, once per resolver, not per response.
+ * 
+ * @return std::unordered_map<std::string, LatencyHistogram> Resolver address -> latencies.
+ */
+std::unordered_map<std::string, LatencyHistogram> DNSTracker::latencies() const
+{
+    std::unordered_map<std::string, LatencyHistogram> latencies;
+
+    for (const auto& resolver : this->latencies_) {
+        latencies.insert(std::make_pair(str_address(resolver.first.family, resolver.first.address), resolver.second));
+    }
+
+    return latencies;
+}
+
+/**
+ * @brief Getter of number of outstanding queries.
+ * 
+ * @return unsigned int Number of queries.
+ */
+unsigned int DNSTracker::pending_count() const
+{
+    return this->pending_.size();
+}
+
+/**
+ * @brief Getter of number of responses without matching query.
+ * 
+ * @return uint64_t Number of responses.
+ */
+uint64_t DNSTracker::unmatched_responses() const
+{
+    return this->unmatched_responses_;
+}
+
+/**
+ * @brief Getter of number of queries evicted due to full table.
+ * 
+ * @return uint64_t Number of queries.
+ */
+uint64_t DNSTracker::evicted_queries() const
+{
+    return this->evicted_queries_;
+}
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+/**
+ * @file dns_tracker.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief DNS query/response matching and resolution latency.
+ * @version 0.1
+ * @date 2019-05-06
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_DNS_TRACKER_H
+#define DISSPCAP_DNS_TRACKER_H
+
+#include <list>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow.h"
+#include "histogram.h"
+#include "packet.h"
+
+namespace disspcap {
+
+const unsigned int DNS_TRACKER_MAX_PENDING = 262144; /**< Default size of pending queries table. */
+const double DNS_TRACKER_TIMEOUT           = 5;      /**< Default query timeout (seconds). */
+
+/**
+ * @brief Finished DNS transaction (query + response or timeout).
+ */
+struct dns_transaction {
+    flow_key flow;                    /**< Client -> server. */
+    unsigned int id;
+    std::string question;             /**< First question (e.g. "example.com A"). */
+    bool answered;
+    unsigned int rcode;
+    double query_time;
+    double latency;                   /**< Seconds, 0 if not answered. */
+    std::vector<std::string> answers;
+};
+
+/**
+ * @brief Key of outstanding query.
+ */
+struct dns_query_key {
+    flow_key flow;
+    uint16_t id;
+    uint16_t question_type;
+    uint16_t question_class;
+    uint64_t question_hash; /**< DNS::name_hash() of question name. */
+    bool operator==(const dns_query_key& other) const;
+} __attribute__((packed));
+
+/**
+ * @brief Hash functor of dns_query_key.
+ */
+struct dns_query_key_hash {
+    size_t operator()(const dns_query_key& key) const;
+};
+
+/**
+ * @brief Address of resolver.
+ */
+struct dns_resolver_key {
+    uint8_t family;
+    uint8_t address[FLOW_ADDR_LEN];
+    bool operator==(const dns_resolver_key& other) const;
+} __attribute__((packed));
+
+/**
+ * @brief Hash functor of dns_resolver_key.
+ */
+struct dns_resolver_key_hash {
+    size_t operator()(const dns_resolver_key& key) const;
+};
+
+/**
+ * @brief Outstanding query.
+ */
+struct dns_pending_query {
+    std::string question; /**< Question name in wire form, rendered only if reported unanswered. */
+    double query_time;
+    std::list<dns_query_key>::iterator position; /**< Entry in timeout queue. */
+};
+
+/**
+ * @brief Matches DNS responses with queries.
+ * 
+ * Queries are keyed by (client, server, ports, DNS id, question), the table
+ * is bounded - oldest queries are evicted (reported as unanswered) when full.
+ */
+class DNSTracker {
+public:
+    DNSTracker(unsigned int max_pending = DNS_TRACKER_MAX_PENDING, double timeout = DNS_TRACKER_TIMEOUT);
+    void process(const Packet& packet);
+    void expire(double now);
+    void flush();
+    const std::vector<dns_transaction>& transactions() const;
+    void clear_transactions();
+    std::unordered_map<std::string, LatencyHistogram> latencies() const;
+    unsigned int pending_count() const;
+    uint64_t unmatched_responses() const;
+    uint64_t evicted_queries() const;
+
+private:
+    std::unordered_map<dns_query_key, dns_pending_query, dns_query_key_hash> pending_;
+    std::list<dns_query_key> order_; /**< Keys of outstanding queries, oldest first. */
+    std::vector<dns_transaction> transactions_;
+    std::unordered_map<dns_resolver_key, LatencyHistogram, dns_resolver_key_hash> latencies_;
+    unsigned int max_pending_;
+    double timeout_;
+    uint64_t unmatched_responses_;
+    uint64_t evicted_queries_;
+    void pop_oldest();
+    void record_unanswered(const dns_query_key& key, const dns_pending_query& query);
+};
+}
+
+#endif
\ No newline at end of file
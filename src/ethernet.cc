@@ -9,6 +9,7 @@
  */
 
 #include "ethernet.h"
+#include "decap.h"
 
 #include <arpa/inet.h>
 
@@ -25,6 +26,23 @@ Ethernet::Ethernet(uint8_t* data)
     this->parse();
 }
 
+/**
+ * @brief Construct a new Ethernet:: Ethernet object with already known
+ * network layer (e.g. behind VLAN tags and MPLS labels, see decapsulate()).
+ * 
+ * @param data Packets data.
+ * @param type Ethernet type of network layer.
+ * @param payload Pointer to network layer.
+ */
+Ethernet::Ethernet(uint8_t* data, uint16_t type, uint8_t* payload)
+    : raw_header_{ reinterpret_cast<ethernet_header*>(data) }
+    , payload_{ payload }
+{
+    this->source_      = str_mac(this->raw_header_->source);
+    this->destination_ = str_mac(this->raw_header_->destination);
+    this->set_type(type);
+}
+
 /**
  * @brief Getter of destination value.
  * 
@@ -55,6 +73,16 @@ const std::string& Ethernet::type() const
     return this->type_;
 }
 
+/**
+ * @brief Getter of numeric type value.
+ * 
+ * @return unsigned int Ethernet type of payload (behind VLAN tags).
+ */
+unsigned int Ethernet::ether_type() const
+{
+    return this->ether_type_;
+}
+
 /**
  * @brief Returns pointer to data where next_header / payload begins.
  * 
@@ -79,34 +107,31 @@ void Ethernet::parse()
     /* set payload pointer */
     this->payload_ = reinterpret_cast<uint8_t*>(this->raw_header_) + ETH_LENGTH;
 
-    /* next header type */
-    switch (ntohs(this->raw_header_->type)) {
-    case ETH_IPv4:
-        this->type_ = "IPv4";
-        break;
-    case ETH_IPv6:
-        this->type_ = "IPv6";
-        break;
-    case ETH_ARP:
-        this->type_ = "ARP";
-        break;
-    case ETH_8021Q:
-        this->handle_vlan();
-        break;
-    default:
-        this->type_ = "UNKNOWN";
+    uint16_t type     = ntohs(this->raw_header_->type);
+    unsigned int tags = 0;
+
+    /* skip 802.1Q/802.1ad tags, stacked tags are limited as decapsulate() layers */
+    while ((type == ETH_8021Q || type == ETH_8021AD || type == ETH_QINQ) && tags < ENCAP_MAX_DEPTH) {
+        struct vlan_header_8021q* vlan = reinterpret_cast<struct vlan_header_8021q*>(this->payload_);
+
+        type = ntohs(vlan->type);
+        this->payload_ += VLAN_LEN;
+        ++tags;
     }
+
+    this->set_type(type);
 }
 
 /**
- * @brief 802.1Q VLAN handler.
+ * @brief Sets type of payload.
+ * 
+ * @param type Ethernet type value.
  */
-void Ethernet::handle_vlan()
+void Ethernet::set_type(uint16_t type)
 {
-    struct vlan_header_8021q* vlan = reinterpret_cast<struct vlan_header_8021q*>(this->payload_);
-    this->payload_ += VLAN_LEN;
+    this->ether_type_ = type;
 
-    switch (ntohs(vlan->type)) {
+    switch (type) {
     case ETH_IPv4:
         this->type_ = "IPv4";
         break;
@@ -116,9 +141,6 @@ void Ethernet::handle_vlan()
     case ETH_ARP:
         this->type_ = "ARP";
         break;
-    case ETH_8021Q:
-        this->handle_vlan();
-        break;
     default:
         this->type_ = "UNKNOWN";
     }
@@ -20,10 +20,17 @@ const int ETH_LENGTH   = 14; /**< Ethernet header length. */
 const int ETH_ADDR_LEN = 6;  /**< MAC address length. */
 const int VLAN_LEN     = 4;  /**< VLAN - 802.1Q header length. */
 
-const uint16_t ETH_IPv4  = 0x0800; /**< Ethernet IPv4 type value. */
-const uint16_t ETH_IPv6  = 0x86DD; /**< Ethernet IPv6 type value. */
-const uint16_t ETH_ARP   = 0x0806; /**< Ethernet ARP type value. */
-const uint16_t ETH_8021Q = 0x8100; /**< Ethernet 802.1Q type value. */
+const uint16_t ETH_IPv4    = 0x0800; /**< Ethernet IPv4 type value. */
+const uint16_t ETH_IPv6    = 0x86DD; /**< Ethernet IPv6 type value. */
+const uint16_t ETH_ARP     = 0x0806; /**< Ethernet ARP type value. */
+const uint16_t ETH_8021Q   = 0x8100; /**< Ethernet 802.1Q type value. */
+const uint16_t ETH_8021AD  = 0x88A8; /**< Ethernet 802.1ad (QinQ service tag) type value. */
+const uint16_t ETH_QINQ    = 0x9100; /**< Ethernet legacy QinQ type value. */
+const uint16_t ETH_MPLS    = 0x8847; /**< Ethernet MPLS unicast type value. */
+const uint16_t ETH_MPLS_MC = 0x8848; /**< Ethernet MPLS multicast type value. */
+const uint16_t ETH_TEB     = 0x6558; /**< Transparent Ethernet bridging (GRE). */
+const uint16_t ETH_ERSPAN  = 0x88BE; /**< ERSPAN type I/II (GRE). */
+const uint16_t ETH_ERSPAN3 = 0x22EB; /**< ERSPAN type III (GRE). */
 
 std::string str_mac(uint8_t*);
 
@@ -50,19 +57,22 @@ struct vlan_header_8021q {
 class Ethernet {
 public:
     Ethernet(uint8_t* data);
+    Ethernet(uint8_t* data, uint16_t type, uint8_t* payload);
     const std::string& destination() const;
     const std::string& source() const;
     const std::string& type() const;
+    unsigned int ether_type() const;
     uint8_t* payload() const;
 
 private:
     std::string destination_;
     std::string source_;
     std::string type_;
+    uint16_t ether_type_;
     struct ethernet_header* raw_header_;
     uint8_t* payload_;
     void parse();
-    void handle_vlan();
+    void set_type(uint16_t type);
 };
 }
 
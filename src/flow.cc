@@ -0,0 +1,121 @@
+/**
+ * @file flow.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Flow (connection) identification.
+ * @version 0.1
+ * @date 2019-05-02
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#include "flow.h"
+
+#include <arpa/inet.h>
+#include <cstring>
+
+#include "common.h"
+
+namespace disspcap {
+
+/**
+ * @brief Returns key of the opposite direction of flow.
+ * 
+ * @return flow_key Key with swapped source and destination.
+ */
+flow_key flow_key::reversed() const
+{
+    flow_key key;
+
+    key.family           = this->family;
+    key.protocol         = this->protocol;
+    key.source_port      = this->destination_port;
+    key.destination_port = this->source_port;
+    std::memcpy(key.source, this->destination, FLOW_ADDR_LEN);
+    std::memcpy(key.destination, this->source, FLOW_ADDR_LEN);
+
+    return key;
+}
+
+/**
+ * @brief Compares two flow keys.
+ * 
+ * @param other Key to compare with.
+ * @return true Same flow and direction.
+ * @return false Different flow.
+ */
+bool flow_key::operator==(const flow_key& other) const
+{
+    return std::memcmp(this, &other, sizeof(flow_key)) == 0;
+}
+
+/**
+ * @brief Hashes flow key.
+ * 
+ * @param key Flow key.
+ * @return size_t Hash value.
+ */
+size_t flow_key_hash::operator()(const flow_key& key) const
+{
+    return hash_bytes(&key, sizeof(flow_key));
+}
+
+/**
+ * @brief Fills flow key from packet's IP and transport headers.
+ * 
+ * @param packet Dissected packet.
+ * @param key Key to fill.
+ * @return true Packet has IP and TCP/UDP headers.
+ * @return false Packet cannot be identified as a flow.
+ */
+bool make_flow_key(const Packet& packet, flow_key& key)
+{
+    std::memset(&key, 0, sizeof(flow_key));
+
+    if (packet.ipv4()) {
+        uint32_t source      = packet.ipv4()->raw_source();
+        uint32_t destination = packet.ipv4()->raw_destination();
+
+        key.family = 4;
+        std::memcpy(key.source, &source, 4);
+        std::memcpy(key.destination, &destination, 4);
+    } else if (packet.ipv6()) {
+        key.family = 6;
+        std::memcpy(key.source, packet.ipv6()->raw_source(), FLOW_ADDR_LEN);
+        std::memcpy(key.destination, packet.ipv6()->raw_destination(), FLOW_ADDR_LEN);
+    } else {
+        return false;
+    }
+
+    if (packet.tcp()) {
+        key.protocol         = IP_TCP;
+        key.source_port      = packet.tcp()->source_port();
+        key.destination_port = packet.tcp()->destination_port();
+    } else if (packet.udp()) {
+        key.protocol         = IP_UDP;
+        key.source_port      = packet.udp()->source_port();
+        key.destination_port = packet.udp()->destination_port();
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Converts binary address to string.
+ * 
+ * @param family 4 for IPv4, 6 for IPv6.
+ * @param address Address bytes (network byte order).
+ * @return std::string String representation of address.
+ */
+std::string str_address(uint8_t family, const uint8_t* address)
+{
+    char buf[INET6_ADDRSTRLEN];
+
+    if (inet_ntop(family == 4 ? AF_INET : AF_INET6, address, buf, INET6_ADDRSTRLEN) == nullptr) {
+        return "INVALID";
+    }
+
+    return std::string(buf);
+}
+}
\ No newline at end of file
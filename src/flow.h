@@ -0,0 +1,51 @@
+/**
+ * @file flow.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Flow (connection) identification.
+ * @version 0.1
+ * @date 2019-05-02
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_FLOW_H
+#define DISSPCAP_FLOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "packet.h"
+
+namespace disspcap {
+
+const uint8_t FLOW_ADDR_LEN = 16; /**< Address storage length (fits IPv6). */
+
+/**
+ * @brief Binary 5-tuple identifying a flow.
+ * 
+ * IPv4 addresses are stored in the first 4 bytes of address fields.
+ */
+struct flow_key {
+    uint8_t family;
+    uint8_t protocol;
+    uint16_t source_port;
+    uint16_t destination_port;
+    uint8_t source[FLOW_ADDR_LEN];
+    uint8_t destination[FLOW_ADDR_LEN];
+    flow_key reversed() const;
+    bool operator==(const flow_key& other) const;
+} __attribute__((packed));
+
+/**
+ * @brief Hash functor of flow_key.
+ */
+struct flow_key_hash {
+    size_t operator()(const flow_key& key) const;
+};
+
+bool make_flow_key(const Packet& packet, flow_key& key);
+std::string str_address(uint8_t family, const uint8_t* address);
+}
+
+#endif
\ No newline at end of file
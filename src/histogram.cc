@@ -0,0 +1,194 @@
+/**
+ * @file histogram.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Latency histogram.
+ * @version 0.1
+ * @date 2019-05-02
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#include "histogram.h"
+
+#include <cstring>
+
+namespace disspcap {
+
+/**
+ * @brief Construct a new empty LatencyHistogram object.
+ */
+LatencyHistogram::LatencyHistogram()
+    : count_{ 0 }
+    , min_{ UINT64_MAX }
+    , max_{ 0 }
+    , sum_{ 0 }
+{
+    std::memset(this->counts_, 0, sizeof(this->counts_));
+}
+
+/**
+ * @brief Records one latency value.
+ * 
+ * @param seconds Latency in seconds (negative values are clamped to 0).
+ */
+void LatencyHistogram::add(double seconds)
+{
+    uint64_t micros = seconds > 0 ? static_cast<uint64_t>(seconds * 1e6 + 0.5) : 0;
+
+    ++this->counts_[bucket_index(micros)];
+    ++this->count_;
+    this->sum_ += micros;
+
+    if (micros < this->min_)
+        this->min_ = micros;
+
+    if (micros > this->max_)
+        this->max_ = micros;
+}
+
+/**
+ * @brief Adds all values of other histogram (e.g. from another thread).
+ * 
+ * @param other Histogram to merge.
+ */
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        this->counts_[i] += other.counts_[i];
+    }
+
+    this->count_ += other.count_;
+    this->sum_ += other.sum_;
+
+    if (other.min_ < this->min_)
+        this->min_ = other.min_;
+
+    if (other.max_ > this->max_)
+        this->max_ = other.max_;
+}
+
+/**
+ * @brief Getter of number of recorded values.
+ * 
+ * @return uint64_t Number of values.
+ */
+uint64_t LatencyHistogram::count() const
+{
+    return this->count_;
+}
+
+/**
+ * @brief Getter of minimal recorded value.
+ * 
+ * @return double Minimum in seconds (0 if empty).
+ */
+double LatencyHistogram::min() const
+{
+    return this->count_ ? this->min_ / 1e6 : 0;
+}
+
+/**
+ * @brief Getter of maximal recorded value.
+ * 
+ * @return double Maximum in seconds.
+ */
+double LatencyHistogram::max() const
+{
+    return this->max_ / 1e6;
+}
+
+/**
+ * @brief Getter of mean value.
+ * 
+ * @return double Mean in seconds (0 if empty).
+ */
+double LatencyHistogram::mean() const
+{
+    return this->count_ ? this->sum_ / this->count_ / 1e6 : 0;
+}
+
+/**
+ * @brief Estimates percentile.
+ * 
+ * @param q Quantile in <0, 1> (e.g. 0.99).
+ * @return double Upper bound of bucket holding the quantile, in seconds.
+ */
+double LatencyHistogram::percentile(double q) const
+{
+    if (!this->count_)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(q * this->count_ + 0.5);
+    uint64_t seen = 0;
+
+    if (rank < 1)
+        rank = 1;
+
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += this->counts_[i];
+
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(i);
+            return (upper > this->max_ ? this->max_ : upper) / 1e6;
+        }
+    }
+
+    return this->max_ / 1e6;
+}
+
+/**
+ * @brief Returns non-empty buckets.
+ * 
+ * @return std::vector<std::pair<double, uint64_t>> (upper bound in seconds, count) pairs.
+ */
+std::vector<std::pair<double, uint64_t>> LatencyHistogram::buckets() const
+{
+    std::vector<std::pair<double, uint64_t>> buckets;
+
+    for (unsigned int i = 0; i < HIST_BUCKETS; ++i) {
+        if (this->counts_[i]) {
+            buckets.push_back(std::make_pair(bucket_upper(i) / 1e6, this->counts_[i]));
+        }
+    }
+
+    return buckets;
+}
+
+/**
+ * @brief Maps value to bucket.
+ * 
+ * Values below 2 * HIST_SUB_BUCKETS have own bucket, above that each power
+ * of two is divided into HIST_SUB_BUCKETS linear buckets.
+ * 
+ * @param micros Value in microseconds.
+ * @return unsigned int Bucket index.
+ */
+unsigned int LatencyHistogram::bucket_index(uint64_t micros)
+{
+    if (micros < 2 * HIST_SUB_BUCKETS)
+        return micros;
+
+    unsigned int exponent = 63 - __builtin_clzll(micros);
+    unsigned int sub      = (micros >> (exponent - 3)) & (HIST_SUB_BUCKETS - 1);
+    unsigned int index    = 2 * HIST_SUB_BUCKETS + (exponent - 4) * HIST_SUB_BUCKETS + sub;
+
+    return index < HIST_BUCKETS ? index : HIST_BUCKETS - 1;
+}
+
+/**
+ * @brief Returns upper bound of bucket.
+ * 
+ * @param index Bucket index.
+ * @return uint64_t Upper bound in microseconds.
+ */
+uint64_t LatencyHistogram::bucket_upper(unsigned int index)
+{
+    if (index < 2 * HIST_SUB_BUCKETS)
+        return index;
+
+    unsigned int exponent = (index - 2 * HIST_SUB_BUCKETS) / HIST_SUB_BUCKETS + 4;
+    unsigned int sub      = (index - 2 * HIST_SUB_BUCKETS) % HIST_SUB_BUCKETS;
+
+    return ((HIST_SUB_BUCKETS + sub + 1ULL) << (exponent - 3)) - 1;
+}
+}
\ No newline at end of file
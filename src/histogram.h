@@ -0,0 +1,52 @@
+/**
+ * @file histogram.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Latency histogram.
+ * @version 0.1
+ * @date 2019-05-02
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_HISTOGRAM_H
+#define DISSPCAP_HISTOGRAM_H
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace disspcap {
+
+const unsigned int HIST_SUB_BUCKETS = 8;   /**< Linear sub-buckets per power of two. */
+const unsigned int HIST_BUCKETS     = 320; /**< Number of buckets (covers ~2^42 us). */
+
+/**
+ * @brief Log-linear histogram of latencies.
+ * 
+ * Values are kept in microseconds, each power of two is split into
+ * HIST_SUB_BUCKETS buckets (relative error under 12.5 %).
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    void add(double seconds);
+    void merge(const LatencyHistogram& other);
+    uint64_t count() const;
+    double min() const;
+    double max() const;
+    double mean() const;
+    double percentile(double q) const;
+    std::vector<std::pair<double, uint64_t>> buckets() const;
+
+private:
+    uint64_t counts_[HIST_BUCKETS];
+    uint64_t count_;
+    uint64_t min_;
+    uint64_t max_;
+    double sum_;
+    static unsigned int bucket_index(uint64_t micros);
+    static uint64_t bucket_upper(unsigned int index);
+};
+}
+
+#endif
\ No newline at end of file
@@ -13,11 +13,13 @@
 
 #include "http.h"
 #include "common.h"
+#include "scan.h"
 
 #include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <iterator>
+#include <strings.h>
 
 namespace disspcap {
 
@@ -28,11 +30,18 @@ namespace disspcap {
  * @param data_length Data length.
  */
 HTTP::HTTP(uint8_t* data, int data_length)
-    : ptr_{ data }
+    : req_res_{ 2 }
+    , method_{ HTTP_METHOD_UNKNOWN }
+    , version_{ HTTP_VERSION_UNKNOWN }
+    , ptr_{ data }
     , base_ptr_{ data }
     , end_ptr_{ data + data_length }
     , body_{ nullptr }
+    , body_length_{ 0 }
+    , non_ascii_{ false }
 {
+    std::fill(this->known_, this->known_ + HTTP_KNOWN_HEADERS, -1);
+
     if (!data)
         return;
 
@@ -82,6 +91,26 @@ bool HTTP::non_ascii() const
     return this->non_ascii_;
 }
 
+/**
+ * @brief Getter of HTTP request method code.
+ * 
+ * @return uint8_t HTTP_METHOD_* value, HTTP_METHOD_UNKNOWN for responses.
+ */
+uint8_t HTTP::method() const
+{
+    return this->method_;
+}
+
+/**
+ * @brief Getter of HTTP version code.
+ * 
+ * @return uint8_t HTTP_VERSION_* value.
+ */
+uint8_t HTTP::version() const
+{
+    return this->version_;
+}
+
 /**
  * @brief Getter of HTTP request method. (GET, POST, ...)
  * 
@@ -135,13 +164,90 @@ const std::string& HTTP::status_code() const
 /**
  * @brief Getter of HTTP headers.
  * 
- * @return const std::map<std::string, std::string>  Key:Value pairs of headers.
+ * Builds map of copies, header_fields() avoids it.
+ * 
+ * @return std::map<std::string, std::string> Key:Value pairs of headers (first occurrence of key).
  */
-const std::map<std::string, std::string> HTTP::headers() const
+std::map<std::string, std::string> HTTP::headers() const
+{
+    std::map<std::string, std::string> headers;
+
+    for (const http_header& header : this->headers_) {
+        headers.insert(std::make_pair(std::string(header.name, header.name_length),
+                                      std::string(header.value, header.value_length)));
+    }
+
+    return headers;
+}
+
+/**
+ * @brief Getter of HTTP header fields in order of appearance.
+ * 
+ * @return const std::vector<http_header>& Header fields.
+ */
+const std::vector<http_header>& HTTP::header_fields() const
 {
     return this->headers_;
 }
 
+/**
+ * @brief Looks up header by name (case-insensitive).
+ * 
+ * @param name Header name.
+ * @return const http_header* First header of given name, nullptr if there is none.
+ */
+const http_header* HTTP::find_header(const std::string& name) const
+{
+    for (const http_header& header : this->headers_) {
+        if (header.name_length == name.size() && strncasecmp(header.name, name.data(), name.size()) == 0) {
+            return &header;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Looks up known header (precomputed by parser).
+ * 
+ * @param known HTTP_HOST, HTTP_CONTENT_LENGTH, HTTP_TRANSFER_ENCODING or HTTP_USER_AGENT.
+ * @return const http_header* First header of given kind, nullptr if there is none.
+ */
+const http_header* HTTP::find_header(uint8_t known) const
+{
+    if (known >= HTTP_KNOWN_HEADERS || this->known_[known] < 0) {
+        return nullptr;
+    }
+
+    return &this->headers_[this->known_[known]];
+}
+
+/**
+ * @brief Getter of header value by name (case-insensitive).
+ * 
+ * @param name Header name.
+ * @return std::string Header value, empty if there is no such header.
+ */
+std::string HTTP::header(const std::string& name) const
+{
+    const http_header* header = this->find_header(name);
+
+    return header ? std::string(header->value, header->value_length) : std::string();
+}
+
+/**
+ * @brief Getter of known header value.
+ * 
+ * @param known HTTP_HOST, HTTP_CONTENT_LENGTH, HTTP_TRANSFER_ENCODING or HTTP_USER_AGENT.
+ * @return std::string Header value, empty if there is no such header.
+ */
+std::string HTTP::header(uint8_t known) const
+{
+    const http_header* header = this->find_header(known);
+
+    return header ? std::string(header->value, header->value_length) : std::string();
+}
+
 /**
  * @brief Getter of message body.
  * 
@@ -168,19 +274,20 @@ unsigned int HTTP::body_length() const
 void HTTP::parse()
 {
     /* request method */
-    this->req_method_ = this->parse_req_method();
+    this->method_ = this->parse_req_method();
 
-    if (this->req_method_ == "") {
-        this->ptr_      = this->base_ptr_;
-        this->protocol_ = this->parse_protocol();
+    if (this->method_ == HTTP_METHOD_UNKNOWN) {
+        this->ptr_     = this->base_ptr_;
+        this->version_ = this->parse_protocol();
 
-        if (this->protocol_ == "") {
+        if (this->version_ == HTTP_VERSION_UNKNOWN) {
             /* no headers */
             this->req_res_ = 2;
             return;
         }
 
         /* response */
+        this->protocol_        = PROTO_VERSIONS[this->version_];
         this->req_res_         = 1;
         this->status_code_     = this->next_string();
         this->response_phrase_ = this->next_line();
@@ -196,9 +303,12 @@ void HTTP::parse()
 
     } else {
         /* request */
-        this->req_res_  = 0;
-        this->req_uri_  = this->next_string();
-        this->protocol_ = this->next_line();
+        this->req_method_ = REQ_METHODS[this->method_];
+        this->req_res_    = 0;
+        this->req_uri_    = this->next_string();
+        this->protocol_   = this->next_line();
+        this->version_    = http_version_code(reinterpret_cast<const uint8_t*>(this->protocol_.data()),
+                                           this->protocol_.size());
         this->parse_headers();
         this->body_length_ = this->end_ptr_ - this->ptr_;
 
@@ -212,30 +322,40 @@ void HTTP::parse()
 }
 
 /**
- * @brief Read next string of HTTP data.
+ * @brief Skips next string of HTTP data.
  * 
+ * @param length Filled with string length.
  * @param limitter String end - default SP.
- * @return std::string Found string.
+ * @return const uint8_t* Found string (not terminated).
  */
-std::string HTTP::next_string(char limitter)
+const uint8_t* HTTP::next_token(unsigned int& length, char limitter)
 {
-    uint8_t* p       = this->ptr_;
-    unsigned int len = 0;
-
-    while (*p && *p != limitter && p < this->end_ptr_) {
-        ++p;
-        ++len;
-    }
+    const uint8_t* token = this->ptr_;
+    const uint8_t* p     = find_either(this->ptr_, this->end_ptr_, limitter, '\0');
 
-    std::string str = std::string(reinterpret_cast<const char*>(this->ptr_), len);
+    length = p - token;
 
     /* skip limitter */
     if (p < this->end_ptr_)
         ++p;
 
-    this->ptr_ = p;
+    this->ptr_ = const_cast<uint8_t*>(p);
 
-    return str;
+    return token;
+}
+
+/**
+ * @brief Read next string of HTTP data.
+ * 
+ * @param limitter String end - default SP.
+ * @return std::string Found string.
+ */
+std::string HTTP::next_string(char limitter)
+{
+    unsigned int length;
+    const uint8_t* token = this->next_token(length, limitter);
+
+    return std::string(reinterpret_cast<const char*>(token), length);
 }
 
 /**
@@ -245,18 +365,9 @@ std::string HTTP::next_string(char limitter)
  */
 std::string HTTP::next_line()
 {
-    uint8_t* p       = this->ptr_;
-    unsigned int len = 0;
-
-    while (*p && p < this->end_ptr_ - 1) {
-        if (*p == '\r' && *(p + 1) == '\n') {
-            break;
-        }
-        ++p;
-        ++len;
-    }
+    uint8_t* p = const_cast<uint8_t*>(find_line_end(this->ptr_, this->end_ptr_));
 
-    std::string str = std::string(reinterpret_cast<const char*>(this->ptr_), len);
+    std::string str = std::string(reinterpret_cast<const char*>(this->ptr_), p - this->ptr_);
 
     /* skip CRLF */
     if (p < this->end_ptr_ - 1)
@@ -270,76 +381,185 @@ std::string HTTP::next_line()
 /**
  * @brief Parses out request method (GET, POST, ...).
  * 
- * @return std::string HTTP request method.
+ * @return uint8_t HTTP_METHOD_* value.
  */
-std::string HTTP::parse_req_method()
+uint8_t HTTP::parse_req_method()
 {
-    std::string method = this->next_string();
+    unsigned int length;
+    const uint8_t* token = this->next_token(length);
 
-    for (unsigned int i = 0; i < REQ_METHODS.size(); ++i) {
-        if (method == REQ_METHODS[i]) {
-            return method;
-        }
+    return http_method_code(token, length);
+}
+
+/**
+ * @brief Parses out protocol version ( e.g. HTTP/1.1).
+ * 
+ * @return uint8_t HTTP_VERSION_* value.
+ */
+uint8_t HTTP::parse_protocol()
+{
+    unsigned int length;
+    const uint8_t* token = this->next_token(length);
+
+    return http_version_code(token, length);
+}
+
+/**
+ * @brief Recognizes request method by length and word compare.
+ * 
+ * @param token Method token.
+ * @param length Token length.
+ * @return uint8_t HTTP_METHOD_* value, HTTP_METHOD_UNKNOWN if token is not a method.
+ */
+uint8_t http_method_code(const uint8_t* token, unsigned int length)
+{
+    switch (length) {
+    case 3:
+        if (std::memcmp(token, "GET", 3) == 0)
+            return HTTP_METHOD_GET;
+        if (std::memcmp(token, "PUT", 3) == 0)
+            return HTTP_METHOD_PUT;
+        break;
+    case 4:
+        if (std::memcmp(token, "POST", 4) == 0)
+            return HTTP_METHOD_POST;
+        if (std::memcmp(token, "HEAD", 4) == 0)
+            return HTTP_METHOD_HEAD;
+        break;
+    case 5:
+        if (std::memcmp(token, "TRACE", 5) == 0)
+            return HTTP_METHOD_TRACE;
+        break;
+    case 6:
+        if (std::memcmp(token, "DELETE", 6) == 0)
+            return HTTP_METHOD_DELETE;
+        break;
+    case 7:
+        if (std::memcmp(token, "OPTIONS", 7) == 0)
+            return HTTP_METHOD_OPTIONS;
+        if (std::memcmp(token, "CONNECT", 7) == 0)
+            return HTTP_METHOD_CONNECT;
+        break;
     }
 
-    return "";
+    return HTTP_METHOD_UNKNOWN;
 }
 
 /**
- * @brief Parses out protocol version ( e.g. HTTP/1.1).
+ * @brief Recognizes protocol version (HTTP/x.y).
  * 
- * @return std::string HTTP protocol version.
+ * @param token Version token.
+ * @param length Token length.
+ * @return uint8_t HTTP_VERSION_* value, HTTP_VERSION_UNKNOWN if token is not a version.
  */
-std::string HTTP::parse_protocol()
+uint8_t http_version_code(const uint8_t* token, unsigned int length)
 {
-    std::string proto = this->next_string();
+    if (length != 8 || std::memcmp(token, "HTTP/", 5) != 0 || token[6] != '.') {
+        return HTTP_VERSION_UNKNOWN;
+    }
 
-    for (unsigned int i = 0; i < PROTO_VERSIONS.size(); ++i) {
-        if (proto == PROTO_VERSIONS[i]) {
-            return proto;
-        }
+    /* major and minor digit */
+    switch (token[5] << 8 | token[7]) {
+    case '0' << 8 | '9':
+        return HTTP_VERSION_0_9;
+    case '1' << 8 | '0':
+        return HTTP_VERSION_1_0;
+    case '1' << 8 | '1':
+        return HTTP_VERSION_1_1;
+    case '2' << 8 | '0':
+        return HTTP_VERSION_2_0;
+    case '3' << 8 | '0':
+        return HTTP_VERSION_3_0;
+    default:
+        return HTTP_VERSION_UNKNOWN;
     }
+}
 
-    return "";
+/**
+ * @brief Recognizes headers with precomputed lookup.
+ * 
+ * @param name Header name.
+ * @param length Name length.
+ * @return int HTTP_HOST, ... value, -1 for other headers.
+ */
+static int known_header(const char* name, unsigned int length)
+{
+    switch (length) {
+    case 4:
+        return strncasecmp(name, "Host", length) == 0 ? HTTP_HOST : -1;
+    case 10:
+        return strncasecmp(name, "User-Agent", length) == 0 ? HTTP_USER_AGENT : -1;
+    case 14:
+        return strncasecmp(name, "Content-Length", length) == 0 ? HTTP_CONTENT_LENGTH : -1;
+    case 17:
+        return strncasecmp(name, "Transfer-Encoding", length) == 0 ? HTTP_TRANSFER_ENCODING : -1;
+    default:
+        return -1;
+    }
 }
 
 /**
  * @brief Parses out headers information.
  * 
- * Fills this->headers_ map.
+ * Fills this->headers_ with fields pointing into packet data, only values
+ * with non printable ascii are escaped (copied into this->escaped_).
  */
 void HTTP::parse_headers()
 {
-    std::string key;
-    std::string value;
-    size_t div_index;
+    this->headers_.reserve(HTTP_HEADERS_RESERVE);
 
-    for (std::string header = next_line(); header != ""; header = next_line()) {
-        div_index = header.find(':');
-        if (div_index == std::string::npos)
-            break;
+    while (true) {
+        const uint8_t* line = this->ptr_;
+        const uint8_t* p    = find_line_end(this->ptr_, this->end_ptr_);
 
-        key = header.substr(0, div_index);
+        /* skip CRLF */
+        this->ptr_ = const_cast<uint8_t*>(p < this->end_ptr_ - 1 ? p + 2 : p);
 
-        /* empty value check */
-        if (div_index + 2 >= header.length()) {
-            value = "";
-        } else {
-            value = header.substr(div_index + 2);
+        if (p <= line) {
+            break;
         }
 
-        /* check printables */
-        for (unsigned int i = 0; i < value.length(); ++i) {
-            unsigned char repr = static_cast<unsigned char>(value[i]);
+        const uint8_t* colon = static_cast<const uint8_t*>(std::memchr(line, ':', p - line));
 
-            if (!isprint(repr)) {
-                /* non printable ascii */
-                this->non_ascii_ = true;
-                value.replace(i, 1, string_hexa(repr));
+        if (!colon) {
+            break;
+        }
+
+        http_header header;
+        header.name         = reinterpret_cast<const char*>(line);
+        header.name_length  = colon - line;
+        header.value        = "";
+        header.value_length = 0;
+
+        /* empty value check, non printable ascii is escaped */
+        if (colon + 2 < p) {
+            const uint8_t* value = colon + 2;
+            unsigned int length  = p - value;
+
+            if (find_unprintable(value, p, '\0') == p) {
+                header.value        = reinterpret_cast<const char*>(value);
+                header.value_length = length;
+            } else {
+                /* worst case of all remaining data, so stored values never move */
+                if (this->escaped_.empty()) {
+                    this->escaped_.reserve(3 * (this->end_ptr_ - value));
+                }
+
+                unsigned int offset = this->escaped_.size();
+                append_escaped(this->escaped_, value, length);
+                header.value        = this->escaped_.data() + offset;
+                header.value_length = this->escaped_.size() - offset;
+                this->non_ascii_    = true;
             }
         }
 
-        this->headers_.insert(std::make_pair(key, value));
+        int known = known_header(header.name, header.name_length);
+
+        if (known >= 0 && this->known_[known] < 0) {
+            this->known_[known] = this->headers_.size();
+        }
+
+        this->headers_.push_back(header);
     }
 }
-}
+}
\ No newline at end of file
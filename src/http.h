@@ -21,40 +21,91 @@
 
 namespace disspcap {
 
+const uint8_t HTTP_METHOD_UNKNOWN = 0; /**< Not a request method. */
+const uint8_t HTTP_METHOD_OPTIONS = 1;
+const uint8_t HTTP_METHOD_GET     = 2;
+const uint8_t HTTP_METHOD_HEAD    = 3;
+const uint8_t HTTP_METHOD_POST    = 4;
+const uint8_t HTTP_METHOD_PUT     = 5;
+const uint8_t HTTP_METHOD_DELETE  = 6;
+const uint8_t HTTP_METHOD_TRACE   = 7;
+const uint8_t HTTP_METHOD_CONNECT = 8;
+
+const uint8_t HTTP_VERSION_UNKNOWN = 0; /**< Not a protocol version. */
+const uint8_t HTTP_VERSION_0_9     = 1;
+const uint8_t HTTP_VERSION_1_0     = 2;
+const uint8_t HTTP_VERSION_1_1     = 3;
+const uint8_t HTTP_VERSION_2_0     = 4;
+const uint8_t HTTP_VERSION_3_0     = 5;
+
 /**
- * @brief Request methods.
+ * @brief Request methods indexed by HTTP_METHOD_* value.
  */
-const std::vector<std::string> REQ_METHODS = {
-    "OPTIONS", "GET", "HEAD", "POST", "PUT",
-    "DELETE", "TRACE", "CONNECT"
+const char* const REQ_METHODS[] = {
+    "", "OPTIONS", "GET", "HEAD", "POST",
+    "PUT", "DELETE", "TRACE", "CONNECT"
 };
 
 /**
- * @brief Protocol versions.
+ * @brief Protocol versions indexed by HTTP_VERSION_* value.
  */
-const std::vector<std::string> PROTO_VERSIONS = {
-    "HTTP/0.9", "HTTP/1.0", "HTTP/1.1",
+const char* const PROTO_VERSIONS[] = {
+    "", "HTTP/0.9", "HTTP/1.0", "HTTP/1.1",
     "HTTP/2.0", "HTTP/3.0"
 };
 
+const uint8_t HTTP_HOST              = 0; /**< Host header. */
+const uint8_t HTTP_CONTENT_LENGTH    = 1; /**< Content-Length header. */
+const uint8_t HTTP_TRANSFER_ENCODING = 2; /**< Transfer-Encoding header. */
+const uint8_t HTTP_USER_AGENT        = 3; /**< User-Agent header. */
+const uint8_t HTTP_KNOWN_HEADERS     = 4; /**< Number of headers with precomputed lookup. */
+
+const unsigned int HTTP_HEADERS_RESERVE = 16; /**< Header slots reserved up front. */
+
+/**
+ * @brief Header field, name and value point into packet data.
+ *
+ * Values with escaped (non-printable) bytes point into HTTP object
+ * instead, either way they are valid as long as HTTP object is.
+ */
+struct http_header {
+    const char* name;
+    unsigned int name_length;
+    const char* value;
+    unsigned int value_length;
+};
+
 std::string string_hexa(unsigned char);
+uint8_t http_method_code(const uint8_t* token, unsigned int length);
+uint8_t http_version_code(const uint8_t* token, unsigned int length);
 
 /**
  * @brief HTTP class holding HTTP related information.
+ *
+ * Not copyable - header fields point into the object itself (escaped_).
  */
 class HTTP {
 public:
     HTTP(uint8_t* data, int data_length);
+    HTTP(const HTTP&) = delete;
+    HTTP& operator=(const HTTP&) = delete;
     ~HTTP();
     bool is_request() const;
     bool is_response() const;
     bool non_ascii() const;
+    uint8_t method() const;
+    uint8_t version() const;
     const std::string& request_method() const;
     const std::string& request_uri() const;
     const std::string& http_version() const;
     const std::string& response_phrase() const;
     const std::string& status_code() const;
-    const std::map<std::string, std::string> headers() const;
+    std::map<std::string, std::string> headers() const;
+    const std::vector<http_header>& header_fields() const;
+    const http_header* find_header(const std::string& name) const;
+    const http_header* find_header(uint8_t known) const;
+    std::string header(const std::string& name) const;
+    std::string header(uint8_t known) const;
     uint8_t* body();
     unsigned int body_length() const;
 
@@ -64,8 +115,12 @@ private:
     std::string protocol_;
     std::string response_phrase_;
     std::string status_code_;
-    std::map<std::string, std::string> headers_;
+    std::vector<http_header> headers_;
+    int known_[HTTP_KNOWN_HEADERS]; /**< Index of known header in headers_, -1 if missing. */
+    std::string escaped_;           /**< Storage of escaped header values. */
     unsigned int req_res_;
+    uint8_t method_;
+    uint8_t version_;
     uint8_t* ptr_;
     uint8_t* base_ptr_;
     uint8_t* end_ptr_;
@@ -74,10 +129,11 @@ private:
     bool non_ascii_;
     void parse();
     void parse_headers();
+    const uint8_t* next_token(unsigned int& length, char limitter = ' ');
     std::string next_string(char limitter = ' ');
     std::string next_line();
-    std::string parse_req_method();
-    std::string parse_protocol();
+    uint8_t parse_req_method();
+    uint8_t parse_protocol();
 };
 }
 
@@ -0,0 +1,369 @@
+/**
+ * @file http_tracker.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief HTTP request/response pairing and latency metrics.
+ * @version 0.1
+ * @date 2019-05-02
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#include "http_tracker.h"
+
+#include <cstdlib>
+
+namespace disspcap {
+
+/**
+ * @brief Construct a new HTTPTracker object.
+ * 
+ * @param max_connections Maximum number of tracked connections.
+ * @param timeout Idle time (seconds) after which connection is finished.
+ * @param max_keys Maximum number of host + path latency keys, others go to HTTP_TRACKER_OVERFLOW_KEY.
+ */
+HTTPTracker::HTTPTracker(unsigned int max_connections, double timeout, unsigned int max_keys)
+    : max_connections_{ max_connections }
+    , timeout_{ timeout }
+    , max_keys_{ max_keys }
+    , last_expire_{ 0 }
+    , unmatched_responses_{ 0 }
+    , dropped_connections_{ 0 }
+    , dropped_keys_{ 0 }
+{
+}
+
+/**
+ * @brief Processes packet - pairs HTTP messages of known connections.
+ * 
+ * @param packet Dissected packet.
+ */
+void HTTPTracker::process(const Packet& packet)
+{
+    const HTTP* http = packet.http();
+    const TCP* tcp   = packet.tcp();
+    flow_key key;
+
+    if (!http || !tcp || !make_flow_key(packet, key)) {
+        return;
+    }
+
+    double now = packet.timestamp();
+
+    if (now - this->last_expire_ > this->timeout_) {
+        this->expire(now);
+        this->last_expire_ = now;
+    }
+
+    /* client -> server direction is the one which sent requests */
+    bool from_client = true;
+    auto it          = this->connections_.find(key);
+
+    if (it == this->connections_.end()) {
+        it          = this->connections_.find(key.reversed());
+        from_client = false;
+    }
+
+    if (it == this->connections_.end()) {
+        if (!http->is_request()) {
+            if (http->is_response())
+                ++this->unmatched_responses_;
+            return;
+        }
+
+        if (this->connections_.size() >= this->max_connections_) {
+            ++this->dropped_connections_;
+            return;
+        }
+
+        http_connection connection;
+        connection.responding         = false;
+        connection.response_remaining = -1;
+        connection.response_last      = 0;
+
+        it          = this->connections_.insert(std::make_pair(key, connection)).first;
+        from_client = true;
+    }
+
+    http_connection& connection = it->second;
+    connection.last_seen        = now;
+
+    if (tcp->payload_length() > 0) {
+        if (from_client) {
+            if (http->is_request()) {
+                this->process_request(connection, *http, packet);
+            } else if (!connection.pending.empty()) {
+                /* request body continuation */
+                connection.pending.back().request_size += tcp->payload_length();
+                connection.pending.back().request_end = now;
+            }
+        } else {
+            if (http->is_response()) {
+                this->process_response(connection, *http, packet);
+            } else if (connection.responding) {
+                /* response body continuation */
+                connection.pending.front().response_size += tcp->payload_length();
+                connection.response_last = now;
+
+                if (connection.response_remaining >= 0) {
+                    connection.response_remaining -= tcp->payload_length();
+
+                    if (connection.response_remaining <= 0)
+                        this->finish_response(connection);
+                }
+            }
+        }
+    }
+
+    if (tcp->rst() || (tcp->fin() && !from_client)) {
+        this->finish_connection(connection);
+        this->connections_.erase(it);
+    }
+}
+
+/**
+ * @brief Queues new request.
+ * 
+ * @param connection Connection state.
+ * @param http HTTP request.
+ * @param packet Packet holding request.
+ */
+void HTTPTracker::process_request(http_connection& connection, const HTTP& http, const Packet& packet)
+{
+    http_transaction transaction;
+
+    transaction.method             = http.request_method();
+    transaction.uri                = http.request_uri();
+    transaction.host               = http.header(HTTP_HOST);
+    transaction.status_code        = 0;
+    transaction.request_size       = packet.tcp()->payload_length();
+    transaction.response_size      = 0;
+    transaction.request_time       = packet.timestamp();
+    transaction.request_end        = packet.timestamp();
+    transaction.time_to_first_byte = 0;
+    transaction.total_time         = 0;
+
+    connection.pending.push_back(transaction);
+}
+
+/**
+ * @brief Binds response to oldest unanswered request.
+ * 
+ * @param connection Connection state.
+ * @param http HTTP response.
+ * @param packet Packet holding response.
+ */
+void HTTPTracker::process_response(http_connection& connection, const HTTP& http, const Packet& packet)
+{
+    unsigned int status = std::atoi(http.status_code().c_str());
+
+    /* interim responses (100 Continue, ...) are not final answers */
+    if (status >= 100 && status < 200 && status != 101) {
+        return;
+    }
+
+    if (connection.responding) {
+        this->finish_response(connection);
+    }
+
+    if (connection.pending.empty()) {
+        ++this->unmatched_responses_;
+        return;
+    }
+
+    http_transaction& transaction = connection.pending.front();
+    double now                    = packet.timestamp();
+
+    transaction.status_code        = status;
+    transaction.response_size      = packet.tcp()->payload_length();
+    transaction.time_to_first_byte = now - transaction.request_end;
+
+    connection.responding    = true;
+    connection.response_last = now;
+
+    /* responses without body */
+    if (transaction.method == "HEAD" || status == 204 || status == 304) {
+        connection.response_remaining = 0;
+    } else {
+        std::string length = http.header(HTTP_CONTENT_LENGTH);
+
+        if (length.empty()) {
+            connection.response_remaining = -1;
+        } else {
+            int64_t remaining             = std::atoll(length.c_str()) - http.body_length();
+            connection.response_remaining = remaining > 0 ? remaining : 0;
+        }
+    }
+
+    if (connection.response_remaining == 0) {
+        this->finish_response(connection);
+    }
+}
+
+/**
+ * @brief Finishes response currently being received.
+ * 
+ * @param connection Connection state.
+ */
+void HTTPTracker::finish_response(http_connection& connection)
+{
+    if (!connection.responding || connection.pending.empty()) {
+        connection.responding = false;
+        return;
+    }
+
+    http_transaction& transaction = connection.pending.front();
+    transaction.total_time        = connection.response_last - transaction.request_time;
+
+    this->record(transaction);
+    connection.pending.pop_front();
+
+    connection.responding         = false;
+    connection.response_remaining = -1;
+}
+
+/**
+ * @brief Finishes connection - emits response in progress and unanswered requests.
+ * 
+ * @param connection Connection state.
+ */
+void HTTPTracker::finish_connection(http_connection& connection)
+{
+    this->finish_response(connection);
+
+    for (auto& transaction : connection.pending) {
+        this->record(transaction);
+    }
+
+    connection.pending.clear();
+}
+
+/**
+ * @brief Emits transaction and updates latency histograms.
+ * 
+ * @param transaction Finished transaction.
+ */
+void HTTPTracker::record(const http_transaction& transaction)
+{
+    this->transactions_.push_back(transaction);
+
+    if (transaction.status_code == 0) {
+        return;
+    }
+
+    /* aggregate per host and path (query string stripped) */
+    std::string key = transaction.host + transaction.uri.substr(0, transaction.uri.find('?'));
+    auto it         = this->latencies_.find(key);
+
+    if (it == this->latencies_.end()) {
+        /* bounded number of keys, new ones are aggregated together */
+        if (this->latencies_.size() >= this->max_keys_) {
+            ++this->dropped_keys_;
+            key = HTTP_TRACKER_OVERFLOW_KEY;
+        }
+
+        it = this->latencies_.emplace(key, http_latency()).first;
+    }
+
+    http_latency& latency = it->second;
+
+    latency.time_to_first_byte.add(transaction.time_to_first_byte);
+    latency.total_time.add(transaction.total_time);
+}
+
+/**
+ * @brief Finishes connections idle for longer than timeout.
+ * 
+ * @param now Current time (seconds since epoch).
+ */
+void HTTPTracker::expire(double now)
+{
+    for (auto it = this->connections_.begin(); it != this->connections_.end();) {
+        if (now - it->second.last_seen > this->timeout_) {
+            this->finish_connection(it->second);
+            it = this->connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Finishes all tracked connections (e.g. at the end of pcap).
+ */
+void HTTPTracker::flush()
+{
+    for (auto& connection : this->connections_) {
+        this->finish_connection(connection.second);
+    }
+
+    this->connections_.clear();
+}
+
+/**
+ * @brief Getter of finished transactions.
+ * 
+ * @return const std::vector<http_transaction>& Transactions in completion order.
+ */
+const std::vector<http_transaction>& HTTPTracker::transactions() const
+{
+    return this->transactions_;
+}
+
+/**
+ * @brief Drops already consumed transactions.
+ */
+void HTTPTracker::clear_transactions()
+{
+    this->transactions_.clear();
+}
+
+/**
+ * @brief Getter of aggregated latencies.
+ * 
+ * @return const std::unordered_map<std::string, http_latency>& Host + path -> latencies.
+ */
+const std::unordered_map<std::string, http_latency>& HTTPTracker::latencies() const
+{
+    return this->latencies_;
+}
+
+/**
+ * @brief Getter of number of tracked connections.
+ * 
+ * @return unsigned int Number of connections.
+ */
+unsigned int HTTPTracker::connection_count() const
+{
+    return this->connections_.size();
+}
+
+/**
+ * @brief Getter of number of responses without matching request.
+ * 
+ * @return uint64_t Number of responses.
+ */
+uint64_t HTTPTracker::unmatched_responses() const
+{
+    return this->unmatched_responses_;
+}
+
+/**
+ * @brief Getter of number of connections not tracked due to full table.
+ * 
+ * @return uint64_t Number of connections.
+ */
+uint64_t HTTPTracker::dropped_connections() const
+{
+    return this->dropped_connections_;
+}
+
+/**
+ * @brief Getter of number of latency samples aggregated under HTTP_TRACKER_OVERFLOW_KEY.
+ * 
+ * @return uint64_t Number of samples whose host + path did not fit into max_keys.
+ */
+uint64_t HTTPTracker::dropped_keys() const
+{
+    return this->dropped_keys_;
+}
+}
\ No newline at end of file
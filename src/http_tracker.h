@@ -0,0 +1,104 @@
+/**
+ * @file http_tracker.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief HTTP request/response pairing and latency metrics.
+ * @version 0.1
+ * @date 2019-05-02
+ * 
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_HTTP_TRACKER_H
+#define DISSPCAP_HTTP_TRACKER_H
+
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow.h"
+#include "histogram.h"
+#include "packet.h"
+
+namespace disspcap {
+
+const unsigned int HTTP_TRACKER_MAX_CONNECTIONS = 65536; /**< Default connection table size. */
+const double HTTP_TRACKER_TIMEOUT               = 60;    /**< Default idle timeout (seconds). */
+const unsigned int HTTP_TRACKER_MAX_KEYS        = 1024;  /**< Default number of host + path latency keys. */
+const char* const HTTP_TRACKER_OVERFLOW_KEY     = "*";   /**< Latency key of samples over max_keys. */
+
+/**
+ * @brief Completed HTTP transaction (request + matched response).
+ */
+struct http_transaction {
+    std::string method;
+    std::string uri;
+    std::string host;
+    unsigned int status_code;    /**< 0 if no response was seen. */
+    unsigned int request_size;   /**< Request bytes (headers + body). */
+    unsigned int response_size;  /**< Response bytes (headers + body). */
+    double request_time;         /**< Timestamp of first request byte. */
+    double request_end;          /**< Timestamp of last request byte. */
+    double time_to_first_byte;   /**< Last request byte -> first response byte. */
+    double total_time;           /**< First request byte -> last response byte. */
+};
+
+/**
+ * @brief Aggregated latencies of one host/URI.
+ */
+struct http_latency {
+    LatencyHistogram time_to_first_byte;
+    LatencyHistogram total_time;
+};
+
+/**
+ * @brief State of one tracked HTTP connection.
+ */
+struct http_connection {
+    std::deque<http_transaction> pending; /**< Requests in pipelining order. */
+    bool responding;                      /**< Front request is being answered. */
+    int64_t response_remaining;           /**< Body bytes left, -1 if unknown. */
+    double response_last;                 /**< Timestamp of last response byte. */
+    double last_seen;
+};
+
+/**
+ * @brief Matches HTTP responses to requests per connection.
+ */
+class HTTPTracker {
+public:
+    HTTPTracker(unsigned int max_connections = HTTP_TRACKER_MAX_CONNECTIONS,
+                double timeout               = HTTP_TRACKER_TIMEOUT,
+                unsigned int max_keys        = HTTP_TRACKER_MAX_KEYS);
+    void process(const Packet& packet);
+    void expire(double now);
+    void flush();
+    const std::vector<http_transaction>& transactions() const;
+    void clear_transactions();
+    const std::unordered_map<std::string, http_latency>& latencies() const;
+    unsigned int connection_count() const;
+    uint64_t unmatched_responses() const;
+    uint64_t dropped_connections() const;
+    uint64_t dropped_keys() const;
+
+private:
+    std::unordered_map<flow_key, http_connection, flow_key_hash> connections_;
+    std::vector<http_transaction> transactions_;
+    std::unordered_map<std::string, http_latency> latencies_;
+    unsigned int max_connections_;
+    double timeout_;
+    unsigned int max_keys_;
+    double last_expire_;
+    uint64_t unmatched_responses_;
+    uint64_t dropped_connections_;
+    uint64_t dropped_keys_;
+    void process_request(http_connection& connection, const HTTP& http, const Packet& packet);
+    void process_response(http_connection& connection, const HTTP& http, const Packet& packet);
+    void finish_response(http_connection& connection);
+    void finish_connection(http_connection& connection);
+    void record(const http_transaction& transaction);
+};
+}
+
+#endif
\ No newline at end of file
@@ -59,6 +59,78 @@ const std::string& IPv4::protocol() const
     return this->protocol_;
 }
 
+/**
+ * @brief Getter of binary source address.
+ *
+ * @return uint32_t Source IP address (network byte order).
+ */
+uint32_t IPv4::raw_source() const
+{
+    return this->raw_source_;
+}
+
+/**
+ * @brief Getter of binary destination address.
+ *
+ * @return uint32_t Destination IP address (network byte order).
+ */
+uint32_t IPv4::raw_destination() const
+{
+    return this->raw_destination_;
+}
+
+/**
+ * @brief Getter of numeric protocol value.
+ *
+ * @return unsigned int Protocol number (e.g. IP_UDP).
+ */
+unsigned int IPv4::protocol_number() const
+{
+    return this->raw_header_->protocol;
+}
+
+/**
+ * @brief Getter of identification value.
+ *
+ * @return unsigned int Identification shared by fragments of datagram.
+ */
+unsigned int IPv4::identification() const
+{
+    return ntohs(this->raw_header_->identification);
+}
+
+/**
+ * @brief Getter of fragment offset.
+ *
+ * @return unsigned int Offset of payload in original datagram (bytes).
+ */
+unsigned int IPv4::fragment_offset() const
+{
+    return this->fragment_offset_;
+}
+
+/**
+ * @brief Getter of more fragments flag.
+ *
+ * @return true Fragments follow.
+ * @return false Last fragment or not fragmented.
+ */
+bool IPv4::more_fragments() const
+{
+    return this->more_fragments_;
+}
+
+/**
+ * @brief Checks whether packet is fragment of larger datagram.
+ *
+ * @return true Packet is fragment.
+ * @return false Packet carries whole datagram.
+ */
+bool IPv4::is_fragment() const
+{
+    return this->more_fragments_ || this->fragment_offset_;
+}
+
 /**
  * @brief Getter of header length value.
  *
@@ -112,12 +184,21 @@ void IPv4::parse()
         this->protocol_ = "UNKNOWN";
     }
 
+    /* fragmentation */
+    uint16_t fragment = ntohs(this->raw_header_->fragment_offset);
+
+    this->fragment_offset_ = (fragment & IPV4_OFFSET_MASK) * 8;
+    this->more_fragments_  = fragment & IPV4_MORE_FRAGMENTS;
+
     /* header length */
     this->header_length_ = this->raw_header_->version__ihl & 0xf;
 
     struct in_addr tmp_addr;
     char buf[INET_ADDRSTRLEN];
 
+    this->raw_source_      = this->raw_header_->source_addr;
+    this->raw_destination_ = this->raw_header_->destination_addr;
+
     /* source ip */
     tmp_addr.s_addr = this->raw_header_->source_addr;
 
@@ -138,6 +219,11 @@ void IPv4::parse()
 
     /* set payload  */
     this->payload_        = reinterpret_cast<uint8_t*>(this->raw_header_) + this->header_length_ * 4;
-    this->payload_length_ = ntohs(this->raw_header_->total_length) - this->header_length_ * 4;
+    this->payload_length_ = 0;
+
+    /* total length shorter than header - no payload */
+    if (ntohs(this->raw_header_->total_length) > this->header_length_ * 4) {
+        this->payload_length_ = ntohs(this->raw_header_->total_length) - this->header_length_ * 4;
+    }
 }
 }
\ No newline at end of file
@@ -35,6 +35,9 @@ const uint8_t IP_IPV6_MOB     = 0x87; /**< IPv6 Mobility header. */
 const uint8_t IP_IPV6_HOSTID  = 0x8B; /**< IPv6 Host Identity protocol. */
 const uint8_t IP_NO_NEXT      = 0x3B; /**< No next header. */
 
+const uint16_t IPV4_MORE_FRAGMENTS = 0x2000; /**< More fragments flag. */
+const uint16_t IPV4_OFFSET_MASK    = 0x1fff; /**< Fragment offset (8-byte units). */
+
 /**
  * @brief IPv4 header struct.
  */
@@ -60,6 +63,13 @@ public:
     const std::string& source() const;
     const std::string& destination() const;
     const std::string& protocol() const;
+    uint32_t raw_source() const;
+    uint32_t raw_destination() const;
+    unsigned int protocol_number() const;
+    unsigned int identification() const;
+    unsigned int fragment_offset() const;
+    bool more_fragments() const;
+    bool is_fragment() const;
     unsigned int header_length() const;
     unsigned int payload_length() const;
     uint8_t* payload();
@@ -68,6 +78,10 @@ private:
     std::string source_;
     std::string destination_;
     std::string protocol_;
+    uint32_t raw_source_;
+    uint32_t raw_destination_;
+    unsigned int fragment_offset_;
+    bool more_fragments_;
     unsigned int header_length_;
     unsigned int payload_length_;
     struct ipv4_header* raw_header_;
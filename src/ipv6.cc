@@ -15,6 +15,7 @@
 #include "ipv6.h"
 
 #include <arpa/inet.h>
+#include <cstring>
 
 namespace disspcap {
 
@@ -22,9 +23,12 @@ namespace disspcap {
  * @brief Construct a new IPv6::IPv6 object and runs parser.
  * 
  * @param data Packets data (starting w/ IPv6).
+ * @param data_length Captured length of data (extension headers are not read past it).
  */
-IPv6::IPv6(uint8_t* data)
-    : raw_header_{ reinterpret_cast<ipv6_header*>(data) }
+IPv6::IPv6(uint8_t* data, unsigned int data_length)
+    : data_length_{ data_length }
+    , fragment_{ nullptr }
+    , raw_header_{ reinterpret_cast<ipv6_header*>(data) }
 {
     this->parse();
 }
@@ -39,6 +43,60 @@ const std::string& IPv6::next_header() const
     return this->next_header_;
 }
 
+/**
+ * @brief Getter for numeric next header value (after extension headers).
+ * 
+ * For fragments it is type of fragmentable part (first header of reassembled data).
+ * 
+ * @return unsigned int Protocol number (e.g. IP_UDP).
+ */
+unsigned int IPv6::next_header_number() const
+{
+    return this->next_header_number_;
+}
+
+/**
+ * @brief Checks whether packet is fragment of larger datagram.
+ * 
+ * @return true Fragment header present, payload is fragment data.
+ * @return false Otherwise.
+ */
+bool IPv6::is_fragment() const
+{
+    return this->fragment_;
+}
+
+/**
+ * @brief Getter for fragment identification.
+ * 
+ * @return unsigned int Identification (0 if not fragment).
+ */
+unsigned int IPv6::identification() const
+{
+    return this->fragment_ ? ntohl(this->fragment_->identification) : 0;
+}
+
+/**
+ * @brief Getter for fragment offset.
+ * 
+ * @return unsigned int Offset of fragment in fragmentable part (bytes).
+ */
+unsigned int IPv6::fragment_offset() const
+{
+    return this->fragment_ ? ntohs(this->fragment_->offset__m) & IPV6_OFFSET_MASK : 0;
+}
+
+/**
+ * @brief Getter for more fragments flag.
+ * 
+ * @return true Fragments follow.
+ * @return false Last fragment or not fragment.
+ */
+bool IPv6::more_fragments() const
+{
+    return this->fragment_ && (ntohs(this->fragment_->offset__m) & IPV6_MORE_FRAGMENTS);
+}
+
 /**
  * @brief Getter for source address value.
  * 
@@ -59,6 +117,26 @@ const std::string& IPv6::destination() const
     return this->destination_;
 }
 
+/**
+ * @brief Getter for binary source address.
+ * 
+ * @return const uint8_t* 16 bytes of source IPv6 address.
+ */
+const uint8_t* IPv6::raw_source() const
+{
+    return this->raw_source_;
+}
+
+/**
+ * @brief Getter for binary destination address.
+ * 
+ * @return const uint8_t* 16 bytes of destination IPv6 address.
+ */
+const uint8_t* IPv6::raw_destination() const
+{
+    return this->raw_destination_;
+}
+
 /**
  * @brief Getter for hop limit value.
  * 
@@ -91,15 +169,15 @@ uint8_t* IPv6::payload()
 
 void IPv6::parse()
 {
-    /* next header */
-    this->next_header_ = parse_next_header(this->raw_header_->next_header);
-
     /* hop limit */
     this->hop_limit_ = this->raw_header_->hop_limit;
 
     struct in6_addr tmp_addr;
     char buf[INET6_ADDRSTRLEN];
 
+    std::memcpy(this->raw_source_, this->raw_header_->source_addr, IPV6_ADDR_LEN);
+    std::memcpy(this->raw_destination_, this->raw_header_->destination_addr, IPV6_ADDR_LEN);
+
     /* source address */
     for (unsigned int i = 0; i < 8; i++) {
         tmp_addr.__in6_u.__u6_addr16[i] = this->raw_header_->source_addr[i];
@@ -123,50 +201,105 @@ void IPv6::parse()
     }
 
     /* get through extension headers and set payload */
-    this->payload_        = reinterpret_cast<uint8_t*>(this->raw_header_) + IPV6_LEN;
-    this->payload_length_ = ntohs(this->raw_header_->payload_length);
+    uint8_t next         = this->raw_header_->next_header;
+    uint8_t* data        = reinterpret_cast<uint8_t*>(this->raw_header_) + IPV6_LEN;
+    unsigned int length  = ntohs(this->raw_header_->payload_length);
+    unsigned int walked  = this->data_length_ > IPV6_LEN ? this->data_length_ - IPV6_LEN : 0;
+    unsigned int skipped = skip_ipv6_extensions(data, length < walked ? length : walked, next, &this->fragment_);
+
+    this->payload_            = data + skipped;
+    this->payload_length_     = length - skipped;
+    this->next_header_number_ = next;
+    this->next_header_        = parse_next_header(this->fragment_ ? IP_IPV6_FRAG : next);
+}
+
+/**
+ * @brief Length rules of extension headers (indexed by next header value).
+ */
+const uint8_t EXT_NONE     = 0; /**< Upper layer protocol - walk ends. */
+const uint8_t EXT_GENERIC  = 1; /**< Length (hdr_ext_len + 1) * 8. */
+const uint8_t EXT_AUTH     = 2; /**< Length (payload_len + 2) * 4. */
+const uint8_t EXT_FRAGMENT = 3; /**< Fixed length, ends walk - rest is fragment data. */
+
+/**
+ * @brief Table of extension header kinds.
+ */
+struct ipv6_extension_table {
+    uint8_t kind[256];
+
+    ipv6_extension_table()
+    {
+        std::memset(this->kind, EXT_NONE, sizeof(this->kind));
 
-    uint8_t next = this->raw_header_->next_header;
-    struct ipv6_hop_by_hop_header* hop_by_hop;
-    struct ipv6_routing_header* routing;
-    struct ipv6_destination_header* destination;
+        this->kind[IP_IPV6_HOPOPT]  = EXT_GENERIC;
+        this->kind[IP_IPV6_ROUTE]   = EXT_GENERIC;
+        this->kind[IP_IPV6_DESTOPT] = EXT_GENERIC;
+        this->kind[IP_IPV6_MOB]     = EXT_GENERIC;
+        this->kind[IP_IPV6_HOSTID]  = EXT_GENERIC;
+        this->kind[IP_IPV6_SHIM6]   = EXT_GENERIC;
+        this->kind[IP_IPV6_AUTH]    = EXT_AUTH;
+        this->kind[IP_IPV6_FRAG]    = EXT_FRAGMENT;
+    }
+};
+
+static const ipv6_extension_table EXTENSIONS;
+
+/**
+ * @brief Walks IPv6 extension headers in one pass.
+ * 
+ * Every header consumes at least 8 bytes, walk ends on upper layer protocol,
+ * truncated header or right behind Fragment header.
+ * 
+ * @param data Data following IPv6 header (or Fragment header).
+ * @param length Data length.
+ * @param next In: type of first header, out: type of first not skipped header.
+ * @param fragment If not null, set to Fragment header (or nullptr).
+ * @return unsigned int Length of skipped headers.
+ */
+unsigned int skip_ipv6_extensions(const uint8_t* data,
+                                  unsigned int length,
+                                  uint8_t& next,
+                                  const ipv6_fragment_header** fragment)
+{
+    unsigned int offset = 0;
     unsigned int extension_len;
-    unsigned int escape_counter = 0;
-
-    while (next != IP_UDP || next != IP_TCP || next != IP_NO_NEXT) {
-        switch (next) {
-        case IP_IPV6_HOPOPT:
-            hop_by_hop    = reinterpret_cast<ipv6_hop_by_hop_header*>(this->payload_);
-            extension_len = (hop_by_hop->hdr_ext_len + 1) * 8;
-            next          = hop_by_hop->next_header;
-            this->payload_ += extension_len;
-            this->payload_length_ -= extension_len;
-            break;
-        case IP_IPV6_ROUTE:
-            routing       = reinterpret_cast<ipv6_routing_header*>(this->payload_);
-            extension_len = (routing->hdr_ext_len + 1) * 8;
-            next          = routing->next_header;
-            this->payload_ += extension_len;
-            this->payload_length_ -= extension_len;
+    uint8_t kind;
+
+    if (fragment) {
+        *fragment = nullptr;
+    }
+
+    while ((kind = EXTENSIONS.kind[next]) != EXT_NONE && offset + 8 <= length) {
+        const uint8_t* extension = data + offset;
+
+        switch (kind) {
+        case EXT_AUTH:
+            extension_len = (extension[1] + 2) * 4;
             break;
-        case IP_IPV6_DESTOPT:
-            destination   = reinterpret_cast<ipv6_destination_header*>(this->payload_);
-            extension_len = (destination->hdr_ext_len + 1) * 8;
-            next          = destination->next_header;
-            this->payload_ += extension_len;
-            this->payload_length_ -= extension_len;
+        case EXT_FRAGMENT:
+            extension_len = sizeof(struct ipv6_fragment_header);
             break;
-        case IP_IPV6_FRAG:
         default:
-            ++escape_counter;
+            extension_len = (extension[1] + 1) * 8;
+        }
+
+        /* truncated header */
+        if (offset + extension_len > length) {
             break;
         }
 
-        if (escape_counter >= 10)
+        offset += extension_len;
+        next = extension[0];
+
+        if (kind == EXT_FRAGMENT) {
+            if (fragment) {
+                *fragment = reinterpret_cast<const ipv6_fragment_header*>(extension);
+            }
             break;
+        }
     }
 
-    this->next_header_ = parse_next_header(next);
+    return offset;
 }
 
 /**
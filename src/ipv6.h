@@ -22,10 +22,21 @@
 
 namespace disspcap {
 
-const uint8_t IPV6_LEN = 40; /**< IPv6 header length. */
+const uint8_t IPV6_LEN      = 40; /**< IPv6 header length. */
+const uint8_t IPV6_ADDR_LEN = 16; /**< IPv6 address length. */
+const uint8_t IP_IPV6_SHIM6 = 0x8C; /**< IPv6 Shim6 protocol. */
+
+const uint16_t IPV6_MORE_FRAGMENTS = 0x0001; /**< More fragments flag. */
+const uint16_t IPV6_OFFSET_MASK    = 0xfff8; /**< Fragment offset (already in bytes). */
+
+struct ipv6_fragment_header;
 
 /* Function declarations */
 std::string parse_next_header(uint8_t next_header);
+unsigned int skip_ipv6_extensions(const uint8_t* data,
+                                  unsigned int length,
+                                  uint8_t& next,
+                                  const ipv6_fragment_header** fragment = nullptr);
 
 /**
  * @brief IPv6 header struct.
@@ -65,15 +76,32 @@ struct ipv6_destination_header {
     uint8_t hdr_ext_len;
 } __attribute__((packed));
 
+/**
+ * @brief Fragment Header.
+ */
+struct ipv6_fragment_header {
+    uint8_t next_header;
+    uint8_t reserved;
+    uint16_t offset__m;
+    uint32_t identification;
+} __attribute__((packed));
+
 /**
  * @brief IPv6 class holding IPv6 header information.
  */
 class IPv6 {
 public:
-    IPv6(uint8_t* data);
+    IPv6(uint8_t* data, unsigned int data_length);
     const std::string& next_header() const;
+    unsigned int next_header_number() const;
+    bool is_fragment() const;
+    unsigned int identification() const;
+    unsigned int fragment_offset() const;
+    bool more_fragments() const;
     const std::string& source() const;
     const std::string& destination() const;
+    const uint8_t* raw_source() const;
+    const uint8_t* raw_destination() const;
     unsigned int hop_limit() const;
     unsigned int payload_length() const;
     uint8_t* payload();
@@ -82,8 +110,13 @@ private:
     std::string next_header_;
     std::string source_;
     std::string destination_;
+    uint8_t raw_source_[IPV6_ADDR_LEN];
+    uint8_t raw_destination_[IPV6_ADDR_LEN];
     unsigned int hop_limit_;
     unsigned int payload_length_;
+    unsigned int data_length_;
+    uint8_t next_header_number_;
+    const ipv6_fragment_header* fragment_;
     struct ipv6_header* raw_header_;
     uint8_t* payload_;
     void parse();
@@ -13,6 +13,7 @@
 
 #include "irc.h"
 #include "common.h"
+#include "scan.h"
 
 namespace disspcap {
 
@@ -31,22 +32,96 @@ IRC::IRC(uint8_t* data, int data_length)
 }
 
 /**
- * @brief IRC messages getter.
+ * @brief IRC messages getter, makes owned copies.
  * 
- * @return const std::vector<struct irc_message> IRC messages.
+ * @return std::vector<struct irc_message> IRC messages.
  */
-const std::vector<struct irc_message> IRC::messages() const
+std::vector<struct irc_message> IRC::messages() const
+{
+    std::vector<struct irc_message> messages;
+    messages.reserve(this->messages_.size());
+
+    for (unsigned int i = 0; i < this->messages_.size(); ++i) {
+        messages.push_back(this->message(i));
+    }
+
+    return messages;
+}
+
+/**
+ * @brief Getter of messages as views into IRC data.
+ * 
+ * @return const std::vector<irc_message_view>& Message views.
+ */
+const std::vector<irc_message_view>& IRC::message_views() const
 {
     return this->messages_;
 }
 
+/**
+ * @brief Getter of params of all messages.
+ * 
+ * @return const std::vector<irc_span>& Params, message has params_count of them from params_begin.
+ */
+const std::vector<irc_span>& IRC::params() const
+{
+    return this->params_;
+}
+
+/**
+ * @brief Makes owned copy of message.
+ * 
+ * Non printables of trailing are escaped.
+ * 
+ * @param index Message index (less than size()).
+ * @return irc_message Message.
+ */
+irc_message IRC::message(unsigned int index) const
+{
+    const irc_message_view& view = this->messages_[index];
+    irc_message message;
+
+    message.prefix  = this->text(view.prefix);
+    message.command = this->text(view.command);
+    message.params.reserve(view.params_count);
+
+    for (unsigned int i = 0; i < view.params_count; ++i) {
+        message.params.push_back(this->text(this->params_[view.params_begin + i]));
+    }
+
+    message.trailing = escape_unprintable(this->base_ptr_ + view.trailing.offset, view.trailing.length);
+
+    return message;
+}
+
+/**
+ * @brief Getter of number of messages.
+ * 
+ * @return unsigned int Number of messages.
+ */
+unsigned int IRC::size() const
+{
+    return this->messages_.size();
+}
+
+/**
+ * @brief Copies span of IRC data.
+ * 
+ * @param span Span of this IRC data.
+ * @return std::string Span content.
+ */
+std::string IRC::text(const irc_span& span) const
+{
+    return std::string(reinterpret_cast<const char*>(this->base_ptr_) + span.offset, span.length);
+}
+
 /**
  * @brief Main parse IRC method.
  */
 void IRC::parse()
 {
     while (this->end_ptr_ - this->ptr_ > 0) {
-        struct irc_message message;
+        irc_message_view message = {};
 
         if (*this->ptr_ == ':') {
             /* has prefix */
@@ -54,25 +129,27 @@ void IRC::parse()
             message.prefix = this->next_string();
         }
 
-        message.command = this->next_string();
+        message.command      = this->next_string();
+        message.params_begin = this->params_.size();
 
         /* params */
-        std::string param = this->next_string();
+        irc_span param = this->next_string();
 
         while (1) {
-            if (param == "") {
+            if (param.length == 0) {
                 /* end of params */
                 break;
             }
 
-            if (param[0] == ':') {
+            if (this->base_ptr_[param.offset] == ':') {
                 /* trailing - reinterpret */
-                this->ptr_ -= param.length();
+                this->ptr_ -= param.length;
                 message.trailing = this->next_line();
                 break;
             }
 
-            message.params.push_back(param);
+            this->params_.push_back(param);
+            ++message.params_count;
 
             param = this->next_string();
         }
@@ -85,61 +162,34 @@ void IRC::parse()
  * @brief Read next string of IRC data.
  * 
  * @param limitter String end - default SP.
- * @return std::string Found string.
+ * @return irc_span Found string.
  */
-std::string IRC::next_string(char limitter)
+irc_span IRC::next_string(char limitter)
 {
-    uint8_t* p       = this->ptr_;
-    unsigned int len = 0;
-
-    while (*p && *p != limitter && p < this->end_ptr_) {
-        if (!isprint(static_cast<int>(*p))) {
-            break;
-        }
-        ++p;
-        ++len;
-    }
+    const uint8_t* p = find_unprintable(this->ptr_, this->end_ptr_, limitter);
 
-    std::string str = std::string(reinterpret_cast<const char*>(this->ptr_), len);
+    irc_span span = { static_cast<uint32_t>(this->ptr_ - this->base_ptr_), static_cast<uint32_t>(p - this->ptr_) };
 
     /* skip limitter */
-    this->ptr_ = p + 1;
+    this->ptr_ = const_cast<uint8_t*>(p) + 1;
 
-    return str;
+    return span;
 }
 
 /**
  * @brief Read next line of IRC data.
  * 
- * @return std::string Line.
+ * @return irc_span Line (not escaped).
  */
-std::string IRC::next_line()
+irc_span IRC::next_line()
 {
-    uint8_t* p       = this->ptr_;
-    unsigned int len = 0;
-
-    while (*p && p < this->end_ptr_ - 1) {
-        if (*p == '\r' && *(p + 1) == '\n') {
-            break;
-        }
-        ++p;
-        ++len;
-    }
+    const uint8_t* p = find_line_end(this->ptr_, this->end_ptr_);
 
-    std::string str = std::string(reinterpret_cast<const char*>(this->ptr_), len);
+    irc_span span = { static_cast<uint32_t>(this->ptr_ - this->base_ptr_), static_cast<uint32_t>(p - this->ptr_) };
 
     /* skip CRLF */
-    this->ptr_ = p + 2;
-
-    /* check printables */
-    for (unsigned int i = 0; i < str.length(); ++i) {
-        unsigned char repr = static_cast<unsigned char>(str[i]);
-
-        if (!isprint(repr)) {
-            str.replace(i, 1, string_hexa(repr));
-        }
-    }
+    this->ptr_ = const_cast<uint8_t*>(p) + 2;
 
-    return str;
+    return span;
 }
 }
\ No newline at end of file
@@ -30,22 +30,50 @@ struct irc_message {
     std::string trailing;
 };
 
+/**
+ * @brief Part of IRC data (offset from beginning of payload).
+ */
+struct irc_span {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * @brief Message as spans of IRC data, params are stored in IRC object.
+ */
+struct irc_message_view {
+    irc_span prefix;
+    irc_span command;
+    uint32_t params_begin; /**< Index of first param in IRC::params(). */
+    uint32_t params_count;
+    irc_span trailing; /**< Not escaped. */
+};
+
 /**
  * @brief IRC class holding IRC messages.
+ *
+ * Messages are kept as views into packet data, owned strings are only
+ * made by messages() and message().
  */
 class IRC {
 public:
     IRC(uint8_t* data, int data_length);
-    const std::vector<struct irc_message> messages() const;
+    std::vector<struct irc_message> messages() const;
+    const std::vector<irc_message_view>& message_views() const;
+    const std::vector<irc_span>& params() const;
+    irc_message message(unsigned int index) const;
+    unsigned int size() const;
+    std::string text(const irc_span& span) const;
 
 private:
-    std::vector<struct irc_message> messages_;
+    std::vector<irc_message_view> messages_;
+    std::vector<irc_span> params_;
     uint8_t* ptr_;
     uint8_t* base_ptr_;
     uint8_t* end_ptr_;
     void parse();
-    std::string next_string(char limitter = ' ');
-    std::string next_line();
+    irc_span next_string(char limitter = ' ');
+    irc_span next_line();
 };
 }
 
@@ -13,6 +13,8 @@
 
 #include "live_capture.h"
 
+#include <stdexcept>
+
 namespace disspcap {
 
 /**
@@ -21,51 +23,165 @@ namespace disspcap {
  * @param interface Interface name.
  */
 LiveSniffer::LiveSniffer()
-    : last_header_{ new struct pcap_pkthdr }
+    : handle_{ nullptr }
+    , readers_{ 0 }
+    , stopping_{ false }
+    , link_type_{ ENCAP_ETHERNET }
+    , last_header_{ new struct pcap_pkthdr }
 {
 }
 
 /**
  * @brief Open interface for sniffing.
+ *
+ * @param interface Interface name.
+ * @param timeout Read timeout (ms) - reads return without packet after it.
  */
-void LiveSniffer::start_sniffing(const std::string& interface)
+void LiveSniffer::start_sniffing(const std::string& interface, int timeout)
 {
+    this->stop_sniffing();
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (this->handle_) {
+        throw std::runtime_error("Sniffing is being stopped.");
+    }
+
     char* arg     = const_cast<char*>(interface.c_str());
-    this->handle_ = pcap_open_live(arg, BUFSIZ, 0, 1000, this->error_buffer_);
+    this->handle_ = pcap_open_live(arg, BUFSIZ, 0, timeout, this->error_buffer_);
 
     if (!this->handle_) {
         throw std::runtime_error("Could not start sniffing.");
     }
+
+    /* first header is the same for all packets */
+    this->link_type_ = link_layer(pcap_datalink(this->handle_));
 }
 
+/**
+ * @brief Destroy the Live Sniffer:: Live Sniffer object.
+ */
 LiveSniffer::~LiveSniffer()
 {
     this->stop_sniffing();
+    delete this->last_header_;
 }
 
 /**
- * @brief Closes interface for sniffing.
+ * @brief Closes interface for sniffing (if open).
+ *
+ * Reads in progress (in other threads) are interrupted and the last of
+ * them closes the interface.
  */
 void LiveSniffer::stop_sniffing()
 {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (!this->handle_) {
+        return;
+    }
+
+    if (this->readers_) {
+        this->stopping_ = true;
+        pcap_breakloop(this->handle_);
+        return;
+    }
+
     pcap_close(this->handle_);
+    this->handle_ = nullptr;
 }
 
 /**
  * @brief Reads next packet from interface.
  * 
- * @return std::unique_ptr<Packet> Next packet object.
+ * Blocks until packet arrives or timeout expires. Packet data are
+ * borrowed from capture buffer (valid until next read) unless
+ * copy_data is set.
+ *
+ * @param copy_data Packet owns copy of its data.
+ * @return std::unique_ptr<Packet> Next packet object, nullptr on timeout.
  */
-std::unique_ptr<Packet> LiveSniffer::next_packet()
+std::unique_ptr<Packet> LiveSniffer::next_packet(bool copy_data)
 {
-    uint8_t* data = const_cast<uint8_t*>(pcap_next(this->handle_, this->last_header_));
-    auto packet   = std::unique_ptr<Packet>(new Packet(data, this->last_header_->len));
+    uint8_t* data    = const_cast<uint8_t*>(pcap_next(this->begin_read(), this->last_header_));
+    double timestamp = this->last_header_->ts.tv_sec + this->last_header_->ts.tv_usec / 1e6;
+
+    /* stopped meanwhile - data belonged to closed handle */
+    if (!this->end_read()) {
+        return nullptr;
+    }
+
+    if (copy_data) {
+        if (!data) {
+            return nullptr;
+        }
+
+        /* only captured bytes, dissectors stop at their end */
+        std::vector<uint8_t> copy(data, data + this->last_header_->caplen);
+
+        return std::unique_ptr<Packet>(new Packet(std::move(copy), timestamp, &this->fragments_, this->link_type_));
+    }
+
+    auto packet = std::unique_ptr<Packet>(
+        new Packet(data, this->last_header_->caplen, timestamp, &this->fragments_, this->link_type_));
     if (packet->raw_data() == nullptr) {
         return nullptr;
     }
     return packet;
 }
 
+/**
+ * @brief Reads packets available in one capture buffer.
+ *
+ * Blocks until at least one packet arrives or timeout expires (returns
+ * immediately in non-blocking mode). Packets own their data.
+ *
+ * @param max_packets Maximum number of packets (0 - whole buffer).
+ * @return std::vector<std::unique_ptr<Packet>> Packets, empty on timeout.
+ */
+std::vector<std::unique_ptr<Packet>> LiveSniffer::next_packets(int max_packets)
+{
+    std::vector<std::unique_ptr<Packet>> packets;
+    std::pair<LiveSniffer*, std::vector<std::unique_ptr<Packet>>*> user(this, &packets);
+    pcap_t* handle = this->begin_read();
+    std::string error;
+
+    if (pcap_dispatch(handle, max_packets > 0 ? max_packets : -1, &LiveSniffer::collect,
+                      reinterpret_cast<u_char*>(&user))
+        == -1) {
+        error = pcap_geterr(handle);
+    }
+
+    /* copied packets are kept even if sniffing was stopped meanwhile */
+    if (this->end_read() && !error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    return packets;
+}
+
+/**
+ * @brief Getter of file descriptor to wait on (select, poll, asyncio).
+ *
+ * @return int Selectable descriptor, -1 if platform does not provide it.
+ */
+int LiveSniffer::fileno() const
+{
+    return pcap_get_selectable_fd(this->handle());
+}
+
+/**
+ * @brief Switches reads to return immediately when no packet is buffered.
+ *
+ * @param nonblocking Non-blocking mode.
+ */
+void LiveSniffer::set_nonblocking(bool nonblocking)
+{
+    if (pcap_setnonblock(this->handle(), nonblocking, this->error_buffer_) == -1) {
+        throw std::runtime_error(this->error_buffer_);
+    }
+}
+
 /**
  * @brief Returns length of last captured packet.
  * 
@@ -75,4 +191,103 @@ int LiveSniffer::last_packet_length() const
 {
     return this->last_header_->len;
 }
+
+/**
+ * @brief Getter of fragment cache used for IP reassembly.
+ * 
+ * @return FragmentCache& Fragment cache (statistics, configuration).
+ */
+FragmentCache& LiveSniffer::fragments()
+{
+    return this->fragments_;
+}
+
+/**
+ * @brief Getter of first header of packets resolved from data link type.
+ * 
+ * @return uint8_t ENCAP_* value (ENCAP_NONE if data link type is unsupported).
+ */
+uint8_t LiveSniffer::link_type() const
+{
+    return this->link_type_;
+}
+
+/**
+ * @brief Getter of open capture handle.
+ *
+ * @return pcap_t* Handle.
+ */
+pcap_t* LiveSniffer::handle() const
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (!this->handle_ || this->stopping_) {
+        throw std::runtime_error("Sniffing was not started.");
+    }
+
+    return this->handle_;
+}
+
+/**
+ * @brief Registers read in progress, handle stays open until end_read().
+ *
+ * @return pcap_t* Handle.
+ */
+pcap_t* LiveSniffer::begin_read()
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    if (!this->handle_ || this->stopping_) {
+        throw std::runtime_error("Sniffing was not started.");
+    }
+
+    ++this->readers_;
+    return this->handle_;
+}
+
+/**
+ * @brief Unregisters read, closes handle if sniffing was stopped meanwhile.
+ *
+ * @return true Sniffing continues.
+ * @return false Sniffing was stopped during read.
+ */
+bool LiveSniffer::end_read()
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    --this->readers_;
+
+    if (!this->stopping_) {
+        return true;
+    }
+
+    if (!this->readers_) {
+        pcap_close(this->handle_);
+        this->handle_   = nullptr;
+        this->stopping_ = false;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Copies packet of capture buffer (pcap_dispatch() callback).
+ *
+ * @param user Sniffer and packet vector.
+ * @param header Packet header.
+ * @param data Packet data.
+ */
+void LiveSniffer::collect(u_char* user, const struct pcap_pkthdr* header, const u_char* data)
+{
+    auto target          = reinterpret_cast<std::pair<LiveSniffer*, std::vector<std::unique_ptr<Packet>>*>*>(user);
+    LiveSniffer* sniffer = target->first;
+    double timestamp     = header->ts.tv_sec + header->ts.tv_usec / 1e6;
+
+    /* only captured bytes, dissectors stop at their end */
+    std::vector<uint8_t> copy(data, data + header->caplen);
+
+    *sniffer->last_header_ = *header;
+    target->second->push_back(std::unique_ptr<Packet>(
+        new Packet(std::move(copy), timestamp, &sniffer->fragments_, sniffer->link_type_)));
+}
 }
\ No newline at end of file
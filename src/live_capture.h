@@ -14,28 +14,51 @@
 #ifndef DISSPCAP_LIVE_CAPTURE_H
 #define DISSPCAP_LIVE_CAPTURE_H
 
+#include <memory>
+#include <mutex>
 #include <pcap.h>
+#include <string>
+#include <vector>
 
 #include "packet.h"
 
 namespace disspcap {
 
+const int LIVE_TIMEOUT = 1000; /**< Default read timeout (ms). */
+
 /**
  * @brief Packet sniffer from interface.
+ *
+ * stop_sniffing() may be called from another thread while a read is
+ * waiting - the read is interrupted and the interface is closed by it.
  */
 class LiveSniffer {
 public:
     LiveSniffer();
     ~LiveSniffer();
-    void start_sniffing(const std::string& interface);
+    void start_sniffing(const std::string& interface, int timeout = LIVE_TIMEOUT);
     void stop_sniffing();
-    std::unique_ptr<Packet> next_packet();
+    std::unique_ptr<Packet> next_packet(bool copy_data = false);
+    std::vector<std::unique_ptr<Packet>> next_packets(int max_packets = 0);
+    int fileno() const;
+    void set_nonblocking(bool nonblocking);
     int last_packet_length() const;
+    FragmentCache& fragments();
+    uint8_t link_type() const;
 
 private:
     pcap_t* handle_;
+    unsigned int readers_; /**< Reads in progress. */
+    bool stopping_;        /**< Close is deferred until reads finish. */
+    mutable std::mutex mutex_;
+    FragmentCache fragments_;
+    uint8_t link_type_;
     struct pcap_pkthdr* last_header_;
     char error_buffer_[PCAP_ERRBUF_SIZE];
+    pcap_t* handle() const;
+    pcap_t* begin_read();
+    bool end_read();
+    static void collect(u_char* user, const struct pcap_pkthdr* header, const u_char* data);
 };
 }
 
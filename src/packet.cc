@@ -12,15 +12,21 @@
 
 #include "ethernet.h"
 
+#include <cstring>
+
 namespace disspcap {
 
 /**
  * @brief Construct a new Packet:: Packet object and runs parser.
  * 
  * @param length Packet length.
+ * @param timestamp Capture time in seconds since epoch.
+ * @param fragments Fragment cache used for IP reassembly (fragments are not dissected without it).
+ * @param link_type First header of packet (ENCAP_* value, see link_layer()).
  */
-Packet::Packet(uint8_t* data, unsigned int length)
-    : length_{ length }
+Packet::Packet(uint8_t* data, unsigned int length, double timestamp, FragmentCache* fragments, uint8_t link_type)
+    : timestamp_{ timestamp }
+    , length_{ length }
     , payload_length_{ length }
     , raw_data_{ data }
     , ethernet_{ nullptr }
@@ -32,6 +38,8 @@ Packet::Packet(uint8_t* data, unsigned int length)
     , http_{ nullptr }
     , irc_{ nullptr }
     , telnet_{ nullptr }
+    , fragments_{ fragments }
+    , link_type_{ link_type }
 {
     if (!data) {
         return;
@@ -40,6 +48,29 @@ Packet::Packet(uint8_t* data, unsigned int length)
     this->parse();
 }
 
+/**
+ * @brief Construct a new Packet:: Packet object owning its data and runs parser.
+ *
+ * Packet stays valid after capture buffer it was copied from is reused.
+ *
+ * @param data Packet data (moved into packet).
+ * @param timestamp Capture time in seconds since epoch.
+ * @param fragments Fragment cache used for IP reassembly.
+ * @param link_type First header of packet (ENCAP_* value).
+ */
+Packet::Packet(std::vector<uint8_t>&& data, double timestamp, FragmentCache* fragments, uint8_t link_type)
+    : Packet(nullptr, data.size(), timestamp, fragments, link_type)
+{
+    this->data_     = std::move(data);
+    this->raw_data_ = this->data_.data();
+
+    if (!this->raw_data_) {
+        return;
+    }
+
+    this->parse();
+}
+
 /**
  * @brief Destroy the Packet:: Packet object.
  * 
@@ -75,6 +106,36 @@ Packet::~Packet()
         delete this->telnet_;
 }
 
+/**
+ * @brief Getter of capture timestamp.
+ * 
+ * @return double Seconds since epoch (0 if unknown).
+ */
+double Packet::timestamp() const
+{
+    return this->timestamp_;
+}
+
+/**
+ * @brief Limits length announced by header to bytes left in packet.
+ *
+ * @param length Length from header (from current payload).
+ * @return unsigned int Length not reaching past packet end.
+ */
+unsigned int Packet::clamp_length(unsigned int length) const
+{
+    unsigned int offset = this->payload_ - this->raw_data_;
+
+    /* header (IHL) reaching past packet end */
+    if (offset >= this->length_) {
+        return 0;
+    }
+
+    unsigned int left = this->length_ - offset;
+
+    return length < left ? length : left;
+}
+
 /**
  * @brief Getter of packet length value.
  * 
@@ -105,6 +166,76 @@ uint8_t* Packet::payload()
     return this->payload_;
 }
 
+/**
+ * @brief Checks whether transport layer was parsed from reassembled datagram.
+ * 
+ * @return true Packet completed fragmented datagram (see Packet::payload()).
+ * @return false Otherwise.
+ */
+bool Packet::is_reassembled() const
+{
+    return !this->reassembled_.empty();
+}
+
+/**
+ * @brief Getter of number of headers in front of network layer.
+ * 
+ * @return unsigned int Number of layers (Ethernet, VLAN tags, tunnels, ...).
+ */
+unsigned int Packet::layer_count() const
+{
+    return this->encapsulation_.depth;
+}
+
+/**
+ * @brief Getter of headers in front of network layer, outermost first.
+ * 
+ * @return const encap_layer* Array of layer_count() layers.
+ */
+const encap_layer* Packet::layers() const
+{
+    return this->encapsulation_.layers;
+}
+
+/**
+ * @brief Reads most used fields without walking layers separately.
+ * 
+ * @return packet_summary Addresses, transport protocol, ports and lengths.
+ */
+packet_summary Packet::summary() const
+{
+    packet_summary summary;
+
+    summary.timestamp        = this->timestamp_;
+    summary.length           = this->length_;
+    summary.source           = "";
+    summary.destination      = "";
+    summary.transport        = "";
+    summary.source_port      = 0;
+    summary.destination_port = 0;
+    summary.payload_length   = this->payload_length_;
+
+    if (this->ipv4_) {
+        summary.source      = this->ipv4_->source().c_str();
+        summary.destination = this->ipv4_->destination().c_str();
+    } else if (this->ipv6_) {
+        summary.source      = this->ipv6_->source().c_str();
+        summary.destination = this->ipv6_->destination().c_str();
+    }
+
+    if (this->tcp_) {
+        summary.transport        = "TCP";
+        summary.source_port      = this->tcp_->source_port();
+        summary.destination_port = this->tcp_->destination_port();
+    } else if (this->udp_) {
+        summary.transport        = "UDP";
+        summary.source_port      = this->udp_->source_port();
+        summary.destination_port = this->udp_->destination_port();
+    }
+
+    return summary;
+}
+
 /**
  * @brief Getter of raw data pointer.
  * 
@@ -213,29 +344,98 @@ void Packet::parse()
     this->payload_        = this->raw_data_;
     this->payload_length_ = this->length_;
 
-    /* parse ethernet */
-    this->ethernet_ = new Ethernet(this->raw_data_);
+    /* walk link layer, VLAN tags, MPLS labels and tunnels */
+    decapsulate(this->raw_data_, this->length_, this->encapsulation_, this->link_type_);
 
-    if (!this->ethernet_) {
+    if (this->encapsulation_.network_offset > this->length_) {
         return;
     }
 
-    this->payload_        = this->ethernet_->payload();
-    this->payload_length_ = this->length_ - ETH_LENGTH;
+    /* parse (innermost) ethernet, if there is any */
+    for (unsigned int i = 0; i < this->encapsulation_.depth; ++i) {
+        if (this->encapsulation_.layers[i].type == ENCAP_ETHERNET) {
+            this->ethernet_ = new Ethernet(this->raw_data_ + this->encapsulation_.link_offset,
+                                           this->encapsulation_.network_type,
+                                           this->raw_data_ + this->encapsulation_.network_offset);
+            break;
+        }
+    }
+
+    this->payload_        = this->raw_data_ + this->encapsulation_.network_offset;
+    this->payload_length_ = this->length_ - this->encapsulation_.network_offset;
 
     std::string next_header;
 
     /* parse ip */
-    if (this->ethernet_->type() == "IPv4") {
+    if (this->encapsulation_.network_type == ETH_IPv4) {
         this->ipv4_           = new IPv4(this->payload_);
         this->payload_        = this->ipv4_->payload();
-        this->payload_length_ = this->ipv4_->payload_length();
+        this->payload_length_ = this->clamp_length(this->ipv4_->payload_length());
         next_header           = this->ipv4_->protocol();
-    } else if (this->ethernet_->type() == "IPv6") {
-        this->ipv6_           = new IPv6(this->payload_);
+
+        /* header reaching past packet end - nothing to dissect */
+        if (this->payload_ > this->raw_data_ + this->length_) {
+            this->payload_ = this->raw_data_ + this->length_;
+            return;
+        }
+
+        /* incomplete datagram - stop at network layer */
+        if (this->ipv4_->is_fragment()) {
+            fragment_key key;
+            uint32_t source      = this->ipv4_->raw_source();
+            uint32_t destination = this->ipv4_->raw_destination();
+
+            std::memset(&key, 0, sizeof(key));
+            key.family   = 4;
+            key.protocol = this->ipv4_->protocol_number();
+            key.id       = this->ipv4_->identification();
+            std::memcpy(key.source, &source, sizeof(source));
+            std::memcpy(key.destination, &destination, sizeof(destination));
+
+            if (!this->reassemble(key,
+                                  this->ipv4_->fragment_offset(),
+                                  this->ipv4_->payload_length(),
+                                  this->ipv4_->more_fragments())) {
+                return;
+            }
+        }
+    } else if (this->encapsulation_.network_type == ETH_IPv6) {
+        this->ipv6_           = new IPv6(this->payload_, this->payload_length_);
         this->payload_        = this->ipv6_->payload();
-        this->payload_length_ = this->ipv6_->payload_length();
+        this->payload_length_ = this->clamp_length(this->ipv6_->payload_length());
         next_header           = this->ipv6_->next_header();
+
+        /* extension headers reaching past packet end - nothing to dissect */
+        if (this->payload_ > this->raw_data_ + this->length_) {
+            this->payload_ = this->raw_data_ + this->length_;
+            return;
+        }
+
+        /* incomplete datagram - stop at network layer */
+        if (this->ipv6_->is_fragment()) {
+            fragment_key key;
+
+            std::memset(&key, 0, sizeof(key));
+            key.family = 6;
+            key.id     = this->ipv6_->identification();
+            std::memcpy(key.source, this->ipv6_->raw_source(), IPV6_ADDR_LEN);
+            std::memcpy(key.destination, this->ipv6_->raw_destination(), IPV6_ADDR_LEN);
+
+            if (!this->reassemble(key,
+                                  this->ipv6_->fragment_offset(),
+                                  this->ipv6_->payload_length(),
+                                  this->ipv6_->more_fragments())) {
+                return;
+            }
+
+            /* fragmentable part may start with extension headers */
+            uint8_t next         = this->ipv6_->next_header_number();
+            unsigned int skipped = skip_ipv6_extensions(this->payload_, this->payload_length_, next);
+
+            this->payload_ += skipped;
+            this->payload_length_ -= skipped;
+            next_header = parse_next_header(next);
+        }
     }
 
     /* parse udp/tcp */
@@ -284,4 +484,40 @@ void Packet::parse()
         }
     }
 }
+
+/**
+ * @brief Passes fragment to fragment cache.
+ * 
+ * Completed datagram is owned by packet, payload is redirected to it.
+ * Fragments not captured whole (snaplen) are never cached, their missing
+ * bytes would end up in reassembled datagram.
+ * 
+ * @param key Datagram identification.
+ * @param offset Fragment offset (bytes).
+ * @param length Fragment data length announced by header.
+ * @param more_fragments More fragments flag.
+ * @return true Datagram is complete.
+ * @return false Fragment was stored (or dropped).
+ */
+bool Packet::reassemble(const fragment_key& key, unsigned int offset, unsigned int length, bool more_fragments)
+{
+    if (!this->fragments_ || this->payload_length_ != length) {
+        return false;
+    }
+
+    if (!this->fragments_->add(key,
+                               offset,
+                               this->payload_,
+                               this->payload_length_,
+                               more_fragments,
+                               this->timestamp_,
+                               this->reassembled_)) {
+        return false;
+    }
+
+    this->payload_        = this->reassembled_.data();
+    this->payload_length_ = this->reassembled_.size();
+
+    return true;
+}
 }
\ No newline at end of file
@@ -15,25 +15,52 @@
 #include <memory>
 #include <string>
 
+#include "decap.h"
 #include "dns.h"
 #include "ethernet.h"
 #include "http.h"
 #include "ipv4.h"
 #include "ipv6.h"
 #include "irc.h"
+#include "reassembly.h"
 #include "tcp.h"
 #include "telnet.h"
 #include "udp.h"
 
 namespace disspcap {
 
+/**
+ * @brief Most used fields of packet, read at once.
+ *
+ * Strings point into packet (valid while packet exists) or to static storage.
+ */
+struct packet_summary {
+    double timestamp;
+    unsigned int length;
+    const char* source;      /**< Network layer source address, empty if none. */
+    const char* destination; /**< Network layer destination address, empty if none. */
+    const char* transport;   /**< "TCP", "UDP" or empty. */
+    unsigned int source_port;
+    unsigned int destination_port;
+    unsigned int payload_length;
+};
+
 /**
  * @brief Class representing packet information (headers + data).
  */
 class Packet {
 public:
-    Packet(uint8_t* data, unsigned int length);
+    Packet(uint8_t* data,
+           unsigned int length,
+           double timestamp         = 0,
+           FragmentCache* fragments = nullptr,
+           uint8_t link_type        = ENCAP_ETHERNET);
+    Packet(std::vector<uint8_t>&& data,
+           double timestamp         = 0,
+           FragmentCache* fragments = nullptr,
+           uint8_t link_type        = ENCAP_ETHERNET);
     ~Packet();
+    double timestamp() const;
     unsigned int length() const;
     unsigned int payload_length() const;
     const Ethernet* ethernet() const;
@@ -45,10 +72,15 @@ public:
     const HTTP* http() const;
     const IRC* irc() const;
     const Telnet* telnet() const;
+    bool is_reassembled() const;
+    unsigned int layer_count() const;
+    const encap_layer* layers() const;
+    packet_summary summary() const;
     uint8_t* raw_data();
     uint8_t* payload();
 
 private:
+    double timestamp_;
     unsigned int length_;
     unsigned int payload_length_;
     uint8_t* raw_data_;
@@ -62,7 +94,14 @@ private:
     HTTP* http_;
     IRC* irc_;
     Telnet* telnet_;
+    FragmentCache* fragments_;
+    uint8_t link_type_;
+    std::vector<uint8_t> reassembled_;
+    std::vector<uint8_t> data_; /**< Owned copy of data (empty if data are borrowed). */
+    decap_result encapsulation_;
     void parse();
+    unsigned int clamp_length(unsigned int length) const;
+    bool reassemble(const fragment_key& key, unsigned int offset, unsigned int length, bool more_fragments);
 };
 }
 
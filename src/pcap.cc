@@ -14,6 +14,7 @@
 #include "pcap.h"
 
 #include <stdexcept>
+#include <vector>
 
 namespace disspcap {
 
@@ -23,7 +24,9 @@ namespace disspcap {
  * Constructs Pcap object without initialization.
  */
 Pcap::Pcap()
-    : last_header_{ new struct pcap_pkthdr }
+    : link_type_{ ENCAP_ETHERNET }
+    , last_header_{ new struct pcap_pkthdr }
+    , prefetched_{ false }
 {
 }
 
@@ -33,7 +36,9 @@ Pcap::Pcap()
  * Constructs Pcap objects, opens pcap file and initializes data.
  */
 Pcap::Pcap(const std::string& filename)
-    : last_header_{ new struct pcap_pkthdr }
+    : link_type_{ ENCAP_ETHERNET }
+    , last_header_{ new struct pcap_pkthdr }
+    , prefetched_{ false }
 {
     this->open_pcap(filename);
 }
@@ -57,23 +62,73 @@ Pcap::~Pcap()
  */
 void Pcap::open_pcap(const std::string& filename)
 {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->check_owner();
+
     char* arg   = const_cast<char*>(filename.c_str());
     this->pcap_ = pcap_open_offline(arg, this->error_buffer_);
 
     if (!this->pcap_) {
         throw std::runtime_error("Could not open pcap file.");
     }
+
+    /* first header is the same for all packets */
+    this->link_type_ = link_layer(pcap_datalink(this->pcap_));
 }
 
 /**
  * @brief Read next packet from a pcap file. Returns nullptr if no more packets.
  * 
+ * Packet data are borrowed from pcap buffer (valid until next read)
+ * unless copy_data is set. Throws while PacketPrefetcher reads the pcap.
+ * Reads of several threads are serialized. Packets handed back by
+ * destroyed PacketPrefetcher are returned first (they own their data).
+ *
+ * @param copy_data Packet owns copy of its data.
  * @return Packet& Reference to next packet object.
  */
-std::unique_ptr<Packet> Pcap::next_packet()
+std::unique_ptr<Packet> Pcap::next_packet(bool copy_data)
 {
-    uint8_t* data = const_cast<uint8_t*>(pcap_next(this->pcap_, this->last_header_));
-    auto packet   = std::unique_ptr<Packet>(new Packet(data, this->last_header_->len));
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->check_owner();
+
+    return this->read_packet(copy_data);
+}
+
+/**
+ * @brief Reads next packet without owner check (used by reader of PacketPrefetcher).
+ *
+ * Caller holds mutex_.
+ *
+ * @param copy_data Packet owns copy of its data.
+ * @return std::unique_ptr<Packet> Next packet, nullptr if no more packets.
+ */
+std::unique_ptr<Packet> Pcap::read_packet(bool copy_data)
+{
+    if (!this->pending_.empty()) {
+        std::unique_ptr<Packet> packet = std::move(this->pending_.front());
+        this->pending_.pop_front();
+        return packet;
+    }
+
+    uint8_t* data    = const_cast<uint8_t*>(pcap_next(this->pcap_, this->last_header_));
+    double timestamp = this->last_header_->ts.tv_sec + this->last_header_->ts.tv_usec / 1e6;
+
+    if (copy_data) {
+        if (!data) {
+            return nullptr;
+        }
+
+        /* only captured bytes, dissectors stop at their end */
+        std::vector<uint8_t> copy(data, data + this->last_header_->caplen);
+
+        return std::unique_ptr<Packet>(new Packet(std::move(copy), timestamp, &this->fragments_, this->link_type_));
+    }
+
+    auto packet = std::unique_ptr<Packet>(
+        new Packet(data, this->last_header_->caplen, timestamp, &this->fragments_, this->link_type_));
     if (packet->raw_data() == nullptr) {
         return nullptr;
     }
@@ -83,10 +138,48 @@ std::unique_ptr<Packet> Pcap::next_packet()
 /**
  * @brief Returns length of last processed packet.
  * 
+ * Packets handed back by PacketPrefetcher do not change it.
+ * 
  * @return int Packet length.
  */
 int Pcap::last_packet_length() const
 {
     return this->last_header_->len;
 }
+
+/**
+ * @brief Getter of fragment cache used for IP reassembly.
+ * 
+ * Throws while PacketPrefetcher reads the pcap (cache is used by its reader).
+ * 
+ * @return FragmentCache& Fragment cache (statistics, configuration).
+ */
+FragmentCache& Pcap::fragments()
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    this->check_owner();
+
+    return this->fragments_;
+}
+
+/**
+ * @brief Throws if pcap is read by PacketPrefetcher.
+ */
+void Pcap::check_owner() const
+{
+    if (this->prefetched_) {
+        throw std::runtime_error("Pcap is read by PacketPrefetcher.");
+    }
+}
+
+/**
+ * @brief Getter of first header of packets resolved from data link type.
+ * 
+ * @return uint8_t ENCAP_* value (ENCAP_NONE if data link type is unsupported).
+ */
+uint8_t Pcap::link_type() const
+{
+    return this->link_type_;
 }
+}
\ No newline at end of file
@@ -14,7 +14,10 @@
 #ifndef DISSPCAP_PCAP_H
 #define DISSPCAP_PCAP_H
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <pcap.h>
 #include <stdint.h>
 #include <string>
@@ -32,13 +35,23 @@ public:
     Pcap(const std::string& filename);
     ~Pcap();
     void open_pcap(const std::string& filename);
-    std::unique_ptr<Packet> next_packet();
+    std::unique_ptr<Packet> next_packet(bool copy_data = false);
     int last_packet_length() const;
+    FragmentCache& fragments();
+    uint8_t link_type() const;
 
 private:
+    friend class PacketPrefetcher;
     pcap_t* pcap_;
+    FragmentCache fragments_;
+    uint8_t link_type_;
     struct pcap_pkthdr* last_header_;
+    std::atomic<bool> prefetched_;                /**< Owned by reader thread of PacketPrefetcher. */
+    std::mutex mutex_;                            /**< Serializes reads (and fragment cache) of threads. */
+    std::deque<std::unique_ptr<Packet>> pending_; /**< Read ahead by PacketPrefetcher, not taken. */
     char error_buffer_[PCAP_ERRBUF_SIZE];
+    std::unique_ptr<Packet> read_packet(bool copy_data);
+    void check_owner() const;
 };
 }
 
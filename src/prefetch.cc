@@ -0,0 +1,141 @@
+/**
+ * @file prefetch.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Background reading of pcap packets.
+ * @version 0.1
+ * @date 2019-06-17
+ *
+ * @copyright Copyright (c) 2019
+ */
+
+#include "prefetch.h"
+
+namespace disspcap {
+
+/**
+ * @brief Construct a new PacketPrefetcher::PacketPrefetcher object and starts reader.
+ *
+ * Pcap is owned by prefetcher until it is destroyed, its next_packet() and
+ * fragments() throw meanwhile.
+ *
+ * @param pcap Opened pcap (not read by another prefetcher).
+ * @param capacity Maximal number of packets read ahead.
+ */
+PacketPrefetcher::PacketPrefetcher(Pcap& pcap, unsigned int capacity)
+    : pcap_{ pcap }
+    , capacity_{ capacity ? capacity : 1 }
+    , finished_{ false }
+    , stopped_{ false }
+{
+    {
+        std::lock_guard<std::mutex> lock(pcap.mutex_);
+
+        pcap.check_owner();
+        pcap.prefetched_ = true;
+    }
+
+    this->reader_ = std::thread(&PacketPrefetcher::read, this);
+}
+
+/**
+ * @brief Destroy the PacketPrefetcher::PacketPrefetcher object.
+ *
+ * Stops reader and hands pcap back together with packets read ahead but
+ * not taken, so reading of pcap continues where consumer stopped.
+ */
+PacketPrefetcher::~PacketPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stopped_ = true;
+    }
+
+    this->not_full_.notify_one();
+    this->reader_.join();
+
+    std::lock_guard<std::mutex> lock(this->pcap_.mutex_);
+
+    while (!this->queue_.empty()) {
+        this->pcap_.pending_.push_front(std::move(this->queue_.back()));
+        this->queue_.pop_back();
+    }
+
+    this->pcap_.prefetched_ = false;
+}
+
+/**
+ * @brief Returns next packet, waits for reader if needed.
+ *
+ * Rethrows exception of reader.
+ *
+ * @return std::unique_ptr<Packet> Next packet, nullptr if no more packets.
+ */
+std::unique_ptr<Packet> PacketPrefetcher::next_packet()
+{
+    std::unique_lock<std::mutex> lock(this->mutex_);
+
+    this->not_empty_.wait(lock, [this]() { return !this->queue_.empty() || this->finished_; });
+
+    if (this->queue_.empty()) {
+        if (this->error_) {
+            std::rethrow_exception(this->error_);
+        }
+
+        return nullptr;
+    }
+
+    std::unique_ptr<Packet> packet = std::move(this->queue_.front());
+    this->queue_.pop_front();
+
+    lock.unlock();
+    this->not_full_.notify_one();
+
+    return packet;
+}
+
+/**
+ * @brief Reader thread - fills queue until end of file.
+ */
+void PacketPrefetcher::read()
+{
+    try {
+        while (true) {
+            std::unique_ptr<Packet> packet;
+
+            {
+                std::lock_guard<std::mutex> lock(this->pcap_.mutex_);
+                packet = this->pcap_.read_packet(true);
+            }
+
+            if (!packet) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(this->mutex_);
+
+            this->not_full_.wait(lock, [this]() { return this->queue_.size() < this->capacity_ || this->stopped_; });
+
+            if (this->stopped_) {
+                /* handed back to pcap by destructor */
+                this->queue_.push_back(std::move(packet));
+                return;
+            }
+
+            this->queue_.push_back(std::move(packet));
+
+            lock.unlock();
+            this->not_empty_.notify_one();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->error_ = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->finished_ = true;
+    }
+
+    this->not_empty_.notify_one();
+}
+}
@@ -0,0 +1,56 @@
+/**
+ * @file prefetch.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Background reading of pcap packets.
+ * @version 0.1
+ * @date 2019-06-17
+ *
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_PREFETCH_H
+#define DISSPCAP_PREFETCH_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "packet.h"
+#include "pcap.h"
+
+namespace disspcap {
+
+const unsigned int PREFETCH_CAPACITY = 256; /**< Default number of packets read ahead. */
+
+/**
+ * @brief Reads and dissects packets of pcap ahead in background thread.
+ *
+ * Packets own their data. Pcap is owned by prefetcher until it is
+ * destroyed, packets read ahead and not taken by then are handed back
+ * to pcap (its next read returns them first).
+ */
+class PacketPrefetcher {
+public:
+    PacketPrefetcher(Pcap& pcap, unsigned int capacity = PREFETCH_CAPACITY);
+    ~PacketPrefetcher();
+    std::unique_ptr<Packet> next_packet();
+
+private:
+    Pcap& pcap_;
+    unsigned int capacity_;
+    bool finished_; /**< Reader reached end of file (or failed). */
+    bool stopped_;  /**< Consumer is gone. */
+    std::exception_ptr error_;
+    std::deque<std::unique_ptr<Packet>> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::thread reader_;
+    void read();
+};
+}
+
+#endif
@@ -8,26 +8,151 @@
  * @copyright Copyright (c) 2018
  */
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include "cardinality.h"
+#include "columnar.h"
 #include "common.h"
+#include "decap.h"
 #include "dns.h"
+#include "dns_tracker.h"
 #include "ethernet.h"
+#include "histogram.h"
 #include "http.h"
+#include "http_tracker.h"
 #include "ipv4.h"
 #include "ipv6.h"
 #include "irc.h"
+#include "live_capture.h"
 #include "packet.h"
 #include "pcap.h"
+#include "prefetch.h"
+#include "scan.h"
+#include "session.h"
 #include "tcp.h"
 #include "telnet.h"
+#include "telnet_tracker.h"
+#include "topk.h"
 #include "udp.h"
 
 using namespace disspcap;
 
 namespace py = pybind11;
 
+/**
+ * @brief Read-only bytes owned by dissected object (exported by buffer protocol).
+ */
+struct byte_view {
+    const uint8_t* data;
+    unsigned int length;
+    py::object owner; /**< Python object keeping bytes alive (e.g. Packet). */
+};
+
+/**
+ * @brief Creates read-only memoryview of bytes, no copy is made.
+ * 
+ * @param data Bytes (may be nullptr if length is 0).
+ * @param length Number of bytes.
+ * @param owner Python object owning bytes, kept alive by memoryview.
+ * @return py::memoryview View of bytes.
+ */
+static py::memoryview bytes_view(const uint8_t* data, unsigned int length, py::object owner)
+{
+    static const uint8_t empty = 0;
+
+    return py::memoryview(py::cast(byte_view{ data ? data : &empty, data ? length : 0, owner }));
+}
+
+/**
+ * @brief Converts summary of packet into tuple (one object instead of layer wrappers).
+ * 
+ * @param packet Dissected packet.
+ * @return py::tuple (timestamp, length, source, destination, transport, source_port,
+ *                   destination_port, payload_length).
+ */
+static py::tuple summary_tuple(const Packet& packet)
+{
+    packet_summary summary = packet.summary();
+
+    return py::make_tuple(summary.timestamp,
+                          summary.length,
+                          summary.source,
+                          summary.destination,
+                          summary.transport,
+                          summary.source_port,
+                          summary.destination_port,
+                          summary.payload_length);
+}
+
+/**
+ * @brief Wraps exported schema into PyCapsule (Arrow PyCapsule interface).
+ * 
+ * @param schema Exported schema (owned by capsule).
+ * @return py::object Capsule named "arrow_schema".
+ */
+static py::object schema_capsule(ArrowSchema* schema)
+{
+    return py::reinterpret_steal<py::object>(PyCapsule_New(schema, "arrow_schema", [](PyObject* capsule) {
+        ArrowSchema* schema = static_cast<ArrowSchema*>(PyCapsule_GetPointer(capsule, "arrow_schema"));
+
+        if (schema->release) {
+            schema->release(schema);
+        }
+
+        delete schema;
+    }));
+}
+
+/**
+ * @brief Wraps exported array into PyCapsule (Arrow PyCapsule interface).
+ * 
+ * @param array Exported array (owned by capsule).
+ * @return py::object Capsule named "arrow_array".
+ */
+static py::object array_capsule(ArrowArray* array)
+{
+    return py::reinterpret_steal<py::object>(PyCapsule_New(array, "arrow_array", [](PyObject* capsule) {
+        ArrowArray* array = static_cast<ArrowArray*>(PyCapsule_GetPointer(capsule, "arrow_array"));
+
+        if (array->release) {
+            array->release(array);
+        }
+
+        delete array;
+    }));
+}
+
+/**
+ * @brief Wraps records into NumPy structured array owning them (no copy).
+ *
+ * @param records Records (owned by array).
+ * @return py::array Array with one element per packet.
+ */
+static py::array records_array(std::unique_ptr<PacketRecords> records)
+{
+    py::list names;
+    py::list formats;
+    py::list offsets;
+
+    for (const record_field& field : records->fields()) {
+        names.append(field.name);
+        formats.append(field.format);
+        offsets.append(field.offset);
+    }
+
+    py::dtype dtype(names, formats, offsets, records->itemsize());
+    std::vector<ssize_t> shape   = { static_cast<ssize_t>(records->size()) };
+    std::vector<ssize_t> strides = { static_cast<ssize_t>(records->itemsize()) };
+    void* data                   = records->data();
+
+    py::capsule owner(records.get(), [](void* records) { delete static_cast<PacketRecords*>(records); });
+    records.release();
+
+    return py::array(dtype, shape, strides, data, owner);
+}
+
 PYBIND11_MODULE(disspcap, m)
 {
     m.doc() = R"doc(
@@ -40,13 +165,109 @@ PYBIND11_MODULE(disspcap, m)
            :toctree: _generate
     )doc";
 
-    m.def("most_common_ip", &most_common_ip, "Returns most common ip in pcap.");
+    m.def("most_common_ip", &most_common_ip, "Returns most common ip in pcap.",
+          py::arg("pcap_path"),
+          py::arg("capacity") = TOPK_CAPACITY);
+
+    m.def("scan_kernel", &scan_kernel, "Returns scanning kernel in use.");
+    m.def("scan_kernels", &scan_kernels, "Returns scanning kernels supported by CPU.");
+    m.def("set_scan_kernel", &set_scan_kernel, "Switches scanning kernel.", py::arg("name"));
+    m.def("find_either", [](py::bytes data, uint8_t first, uint8_t second) {
+        std::string text = data;
+        auto begin       = reinterpret_cast<const uint8_t*>(text.data());
+
+        return find_either(begin, begin + text.size(), first, second) - begin;
+    }, "Returns index of first of two bytes (length if none).",
+          py::arg("data"), py::arg("first"), py::arg("second"));
+    m.def("find_unprintable", [](py::bytes data, uint8_t delimiter, bool allow_space) {
+        std::string text = data;
+        auto begin       = reinterpret_cast<const uint8_t*>(text.data());
+
+        return find_unprintable(begin, begin + text.size(), delimiter, allow_space) - begin;
+    }, "Returns index of first delimiter or non-printable byte (length if none).",
+          py::arg("data"), py::arg("delimiter") = 0, py::arg("allow_space") = false);
+    m.def("escape_unprintable", [](py::bytes data, bool allow_space) {
+        std::string text = data;
+
+        return escape_unprintable(reinterpret_cast<const uint8_t*>(text.data()), text.size(), allow_space);
+    }, "Replaces non-printable bytes with %xx escapes.",
+          py::arg("data"), py::arg("allow_space") = false);
+
+    py::class_<telnet_command>(m, "telnet_command")
+        .def_readonly("command", &telnet_command::command)
+        .def_readonly("option", &telnet_command::option)
+        .def_property_readonly("parameters", [](const telnet_command& command) {
+            return py::bytes(command.parameters);
+        });
 
     py::class_<Telnet>(m, "Telnet")
         .def_property_readonly("is_command", &Telnet::is_command)
         .def_property_readonly("is_data", &Telnet::is_data)
         .def_property_readonly("is_empty", &Telnet::is_empty)
-        .def_property_readonly("data", &Telnet::data);
+        .def_property_readonly("data", &Telnet::data)
+        .def_property_readonly("commands", &Telnet::commands);
+
+    py::class_<TelnetTracker>(m, "TelnetTracker")
+        .def(py::init<unsigned int, double>(),
+             py::arg("max_streams") = TELNET_TRACKER_MAX_STREAMS,
+             py::arg("timeout")     = TELNET_TRACKER_TIMEOUT)
+        .def("process", &TelnetTracker::process)
+        .def("expire", &TelnetTracker::expire)
+        .def_property_readonly("data", &TelnetTracker::data)
+        .def_property_readonly("commands", &TelnetTracker::commands)
+        .def_property_readonly("stream_count", &TelnetTracker::stream_count)
+        .def_property_readonly("gaps", &TelnetTracker::gaps)
+        .def_property_readonly("dropped_streams", &TelnetTracker::dropped_streams);
+
+    py::class_<session_transcript>(m, "session_transcript")
+        .def_property_readonly("client", [](const session_transcript& transcript) {
+            return str_address(transcript.flow.family, transcript.flow.source);
+        })
+        .def_property_readonly("server", [](const session_transcript& transcript) {
+            return str_address(transcript.flow.family, transcript.flow.destination);
+        })
+        .def_property_readonly("client_port", [](const session_transcript& transcript) {
+            return transcript.flow.source_port;
+        })
+        .def_property_readonly("server_port", [](const session_transcript& transcript) {
+            return transcript.flow.destination_port;
+        })
+        .def_readonly("protocol", &session_transcript::protocol)
+        .def_readonly("start", &session_transcript::start)
+        .def_readonly("end", &session_transcript::end)
+        .def_readonly("closed", &session_transcript::closed)
+        .def_readonly("truncated", &session_transcript::truncated)
+        .def_readonly("gaps", &session_transcript::gaps)
+        .def_property_readonly("lines", [](const session_transcript& transcript) {
+            py::list lines;
+            for (unsigned int i = 0; i < transcript.lines.size(); ++i) {
+                const session_line& line = transcript.lines[i];
+                lines.append(py::make_tuple(line.timestamp, line.from_client, transcript.text(i)));
+            }
+            return lines;
+        })
+        .def("__len__", [](const session_transcript& transcript) { return transcript.lines.size(); });
+
+    py::class_<SessionBuilder>(m, "SessionBuilder")
+        .def(py::init<uint64_t, uint64_t, double, uint64_t>(),
+             py::arg("max_session_bytes") = SESSION_MAX_BYTES,
+             py::arg("max_total_bytes")   = SESSION_MAX_TOTAL_BYTES,
+             py::arg("timeout")           = SESSION_TIMEOUT,
+             py::arg("max_kept_bytes")    = SESSION_MAX_KEPT_BYTES)
+        .def("process", &SessionBuilder::process)
+        .def("expire", &SessionBuilder::expire)
+        .def("flush", &SessionBuilder::flush)
+        .def("set_output", &SessionBuilder::set_output)
+        .def("clear_transcripts", &SessionBuilder::clear_transcripts)
+        .def_property_readonly("transcripts", &SessionBuilder::transcripts, py::return_value_policy::copy)
+        .def_property_readonly("session_count", &SessionBuilder::session_count)
+        .def_property_readonly("memory", &SessionBuilder::memory)
+        .def_property_readonly("evicted_sessions", &SessionBuilder::evicted_sessions)
+        .def_property_readonly("kept_memory", &SessionBuilder::kept_memory)
+        .def_property_readonly("dropped_transcripts", &SessionBuilder::dropped_transcripts);
+
+    m.attr("SESSION_IRC")    = SESSION_IRC;
+    m.attr("SESSION_TELNET") = SESSION_TELNET;
 
     py::class_<irc_message>(m, "irc_message")
         .def_readonly("prefix", &irc_message::prefix)
@@ -55,7 +276,32 @@ PYBIND11_MODULE(disspcap, m)
         .def_readonly("trailing", &irc_message::trailing);
 
     py::class_<IRC>(m, "IRC")
-        .def_property_readonly("messages", &IRC::messages);
+        .def_property_readonly("messages", &IRC::messages)
+        .def("message", [](const IRC& irc, unsigned int index) {
+            if (index >= irc.size()) {
+                throw py::index_error("IRC message index out of range.");
+            }
+
+            return irc.message(index);
+        })
+        .def("__len__", &IRC::size);
+
+    m.attr("HTTP_METHOD_UNKNOWN") = HTTP_METHOD_UNKNOWN;
+    m.attr("HTTP_METHOD_OPTIONS") = HTTP_METHOD_OPTIONS;
+    m.attr("HTTP_METHOD_GET")     = HTTP_METHOD_GET;
+    m.attr("HTTP_METHOD_HEAD")    = HTTP_METHOD_HEAD;
+    m.attr("HTTP_METHOD_POST")    = HTTP_METHOD_POST;
+    m.attr("HTTP_METHOD_PUT")     = HTTP_METHOD_PUT;
+    m.attr("HTTP_METHOD_DELETE")  = HTTP_METHOD_DELETE;
+    m.attr("HTTP_METHOD_TRACE")   = HTTP_METHOD_TRACE;
+    m.attr("HTTP_METHOD_CONNECT") = HTTP_METHOD_CONNECT;
+
+    m.attr("HTTP_VERSION_UNKNOWN") = HTTP_VERSION_UNKNOWN;
+    m.attr("HTTP_VERSION_0_9")     = HTTP_VERSION_0_9;
+    m.attr("HTTP_VERSION_1_0")     = HTTP_VERSION_1_0;
+    m.attr("HTTP_VERSION_1_1")     = HTTP_VERSION_1_1;
+    m.attr("HTTP_VERSION_2_0")     = HTTP_VERSION_2_0;
+    m.attr("HTTP_VERSION_3_0")     = HTTP_VERSION_3_0;
 
     py::class_<HTTP>(m, "HTTP")
         .def_property_readonly("is_request", &HTTP::is_request)
@@ -64,20 +310,43 @@ PYBIND11_MODULE(disspcap, m)
         .def_property_readonly("request_method", &HTTP::request_method)
         .def_property_readonly("request_uri", &HTTP::request_uri)
         .def_property_readonly("version", &HTTP::http_version)
+        .def_property_readonly("method_code", &HTTP::method)
+        .def_property_readonly("version_code", &HTTP::version)
         .def_property_readonly("response_phrase", &HTTP::response_phrase)
         .def_property_readonly("status_code", &HTTP::status_code)
-        .def_property_readonly("headers", &HTTP::headers)
-        .def_property_readonly("body_length", &HTTP::body_length)
-        .def_property_readonly("body", [](HTTP& http) {
-            uint8_t* bytes = http.body();
-            if (bytes == nullptr) {
-                return py::bytes("");
+        .def_property_readonly("headers", [](const HTTP& http) {
+            py::dict headers;
+
+            for (const http_header& header : http.header_fields()) {
+                py::str name(header.name, header.name_length);
+
+                if (!headers.contains(name)) {
+                    headers[name] = py::str(header.value, header.value_length);
+                }
             }
-            return py::bytes((char*)bytes, http.body_length());
+
+            return headers;
+        })
+        .def("header", [](const HTTP& http, const std::string& name) -> py::object {
+            const http_header* header = http.find_header(name);
+
+            if (!header) {
+                return py::none();
+            }
+
+            return py::str(header->value, header->value_length);
+        })
+        .def_property_readonly("body_length", &HTTP::body_length)
+        .def_property_readonly("body", [](py::object self) {
+            HTTP& http = self.cast<HTTP&>();
+
+            return bytes_view(http.body(), http.body_length(), self);
         });
 
     py::class_<DNS>(m, "DNS")
+        .def_property_readonly("id", &DNS::id)
         .def_property_readonly("qr", &DNS::qr)
+        .def_property_readonly("rcode", &DNS::rcode)
         .def_property_readonly("is_incomplete", &DNS::is_incomplete)
         .def_property_readonly("question_count", &DNS::question_count)
         .def_property_readonly("answer_count", &DNS::answer_count)
@@ -86,36 +355,75 @@ PYBIND11_MODULE(disspcap, m)
         .def_property_readonly("questions", &DNS::questions)
         .def_property_readonly("answers", &DNS::answers)
         .def_property_readonly("authoritatives", &DNS::authoritatives)
-        .def_property_readonly("additionals", &DNS::additionals);
+        .def_property_readonly("additionals", &DNS::additionals)
+        .def_property_readonly("records", &DNS::records)
+        .def("name", &DNS::name)
+        .def("text", &DNS::text)
+        .def("name_id", [](const DNS& dns, const dns_record& record) {
+            return dns.name_id(record);
+        })
+        .def("name_id", &DNS::name_id)
+        .def("rdata", [](const DNS& dns, const dns_record& record) {
+            return py::bytes((const char*)dns.rdata(record), record.rdata_length);
+        });
+
+    py::class_<DNSNameTable>(m, "DNSNameTable")
+        .def(py::init<>())
+        .def("intern", &DNSNameTable::intern)
+        .def("lookup", &DNSNameTable::lookup)
+        .def("clear", &DNSNameTable::clear)
+        .def("__len__", &DNSNameTable::size)
+        .def_static("global_table", &DNSNameTable::global, py::return_value_policy::reference);
+
+    py::class_<dns_record>(m, "dns_record")
+        .def_readonly("section", &dns_record::section)
+        .def_readonly("type", &dns_record::type)
+        .def_readonly("rr_class", &dns_record::rr_class)
+        .def_readonly("ttl", &dns_record::ttl)
+        .def_readonly("name_offset", &dns_record::name_offset)
+        .def_readonly("rdata_offset", &dns_record::rdata_offset)
+        .def_readonly("rdata_length", &dns_record::rdata_length);
 
     py::class_<Ethernet>(m, "Ethernet")
         .def_property_readonly("destination", &Ethernet::destination)
         .def_property_readonly("source", &Ethernet::source)
-        .def_property_readonly("type", &Ethernet::type);
+        .def_property_readonly("type", &Ethernet::type)
+        .def_property_readonly("ether_type", &Ethernet::ether_type);
+
+    py::class_<encap_layer>(m, "encap_layer")
+        .def_property_readonly("type", [](const encap_layer& layer) { return str_encap(layer.type); })
+        .def_readonly("offset", &encap_layer::offset)
+        .def_readonly("id", &encap_layer::id);
 
     py::class_<IPv4>(m, "IPv4")
         .def_property_readonly("destination", &IPv4::destination)
         .def_property_readonly("source", &IPv4::source)
         .def_property_readonly("protocol", &IPv4::protocol)
-        .def_property_readonly("header_length", &IPv4::header_length);
+        .def_property_readonly("header_length", &IPv4::header_length)
+        .def_property_readonly("identification", &IPv4::identification)
+        .def_property_readonly("fragment_offset", &IPv4::fragment_offset)
+        .def_property_readonly("more_fragments", &IPv4::more_fragments)
+        .def_property_readonly("is_fragment", &IPv4::is_fragment);
 
     py::class_<IPv6>(m, "IPv6")
         .def_property_readonly("next_header", &IPv6::next_header)
         .def_property_readonly("source", &IPv6::source)
         .def_property_readonly("destination", &IPv6::destination)
-        .def_property_readonly("hop_limit", &IPv6::hop_limit);
+        .def_property_readonly("hop_limit", &IPv6::hop_limit)
+        .def_property_readonly("next_header_number", &IPv6::next_header_number)
+        .def_property_readonly("identification", &IPv6::identification)
+        .def_property_readonly("fragment_offset", &IPv6::fragment_offset)
+        .def_property_readonly("more_fragments", &IPv6::more_fragments)
+        .def_property_readonly("is_fragment", &IPv6::is_fragment);
 
     py::class_<UDP>(m, "UDP")
         .def_property_readonly("source_port", &UDP::source_port)
         .def_property_readonly("destination_port", &UDP::destination_port)
         .def_property_readonly("payload_length", &UDP::payload_length)
-        .def_property_readonly("payload", [](UDP& udp) {
-            uint8_t* bytes = udp.payload();
-            if (bytes == nullptr) {
-                return py::bytes("");
-            }
+        .def_property_readonly("payload", [](py::object self) {
+            UDP& udp = self.cast<UDP&>();
 
-            return py::bytes((char*)bytes, udp.payload_length());
+            return bytes_view(udp.payload(), udp.payload_length(), self);
         });
 
     py::class_<TCP>(m, "TCP")
@@ -135,16 +443,37 @@ PYBIND11_MODULE(disspcap, m)
         .def_property_readonly("syn", &TCP::syn)
         .def_property_readonly("fin", &TCP::fin)
         .def_property_readonly("payload_length", &TCP::payload_length)
-        .def_property_readonly("payload", [](TCP& tcp) {
-            uint8_t* bytes = tcp.payload();
-            if (bytes == nullptr) {
-                return py::bytes("");
-            }
+        .def_property_readonly("payload", [](py::object self) {
+            TCP& tcp = self.cast<TCP&>();
+
+            return bytes_view(tcp.payload(), tcp.payload_length(), self);
+        });
 
-            return py::bytes((char*)bytes, tcp.payload_length());
+    py::class_<byte_view>(m, "ByteView", py::buffer_protocol())
+        .def_buffer([](byte_view& view) {
+            return py::buffer_info(const_cast<uint8_t*>(view.data),
+                                   sizeof(uint8_t),
+                                   py::format_descriptor<uint8_t>::format(),
+                                   1,
+                                   { static_cast<ssize_t>(view.length) },
+                                   { static_cast<ssize_t>(sizeof(uint8_t)) },
+                                   true);
         });
 
     py::class_<Packet>(m, "Packet")
+        .def_property_readonly("timestamp", &Packet::timestamp)
+        .def_property_readonly("length", &Packet::length)
+        .def_property_readonly("payload_length", &Packet::payload_length)
+        .def_property_readonly("raw_data", [](py::object self) {
+            Packet& packet = self.cast<Packet&>();
+
+            return bytes_view(packet.raw_data(), packet.length(), self);
+        })
+        .def_property_readonly("payload", [](py::object self) {
+            Packet& packet = self.cast<Packet&>();
+
+            return bytes_view(packet.payload(), packet.payload_length(), self);
+        })
         .def_property_readonly("ethernet", &Packet::ethernet)
         .def_property_readonly("ipv4", &Packet::ipv4)
         .def_property_readonly("ipv6", &Packet::ipv6)
@@ -153,12 +482,262 @@ PYBIND11_MODULE(disspcap, m)
         .def_property_readonly("dns", &Packet::dns)
         .def_property_readonly("http", &Packet::http)
         .def_property_readonly("irc", &Packet::irc)
-        .def_property_readonly("telnet", &Packet::telnet);
+        .def_property_readonly("telnet", &Packet::telnet)
+        .def_property_readonly("is_reassembled", &Packet::is_reassembled)
+        .def_property_readonly("layers", [](const Packet& packet) {
+            return std::vector<encap_layer>(packet.layers(), packet.layers() + packet.layer_count());
+        })
+        .def("summary", &summary_tuple);
+
+    m.attr("FRAG_OVERLAP_FIRST") = FRAG_OVERLAP_FIRST;
+    m.attr("FRAG_OVERLAP_LAST")  = FRAG_OVERLAP_LAST;
+    m.attr("FRAG_OVERLAP_DROP")  = FRAG_OVERLAP_DROP;
+
+    py::class_<FragmentCache>(m, "FragmentCache")
+        .def("clear", &FragmentCache::clear)
+        .def_property("max_trains", &FragmentCache::max_trains, [](FragmentCache& cache, unsigned int max_trains) {
+            cache.configure(max_trains, cache.timeout(), cache.overlap_policy());
+        })
+        .def_property("timeout", &FragmentCache::timeout, [](FragmentCache& cache, double timeout) {
+            cache.configure(cache.max_trains(), timeout, cache.overlap_policy());
+        })
+        .def_property("overlap_policy", &FragmentCache::overlap_policy, [](FragmentCache& cache, uint8_t overlap_policy) {
+            cache.configure(cache.max_trains(), cache.timeout(), overlap_policy);
+        })
+        .def_property_readonly("size", &FragmentCache::size)
+        .def_property_readonly("reassembled", &FragmentCache::reassembled)
+        .def_property_readonly("timed_out", &FragmentCache::timed_out)
+        .def_property_readonly("dropped", &FragmentCache::dropped);
 
     py::class_<Pcap>(m, "Pcap")
         .def(py::init())
         .def(py::init<const std::string&>())
         .def("open_pcap", &Pcap::open_pcap)
-        .def("next_packet", &Pcap::next_packet)
-        .def_property_readonly("last_packet_length", &Pcap::last_packet_length);
+        .def("next_packet", &Pcap::next_packet,
+             py::arg("copy_data") = true,
+             py::call_guard<py::gil_scoped_release>())
+        .def("__iter__", [](Pcap& pcap) {
+            return std::unique_ptr<PacketPrefetcher>(new PacketPrefetcher(pcap));
+        }, py::keep_alive<0, 1>())
+        .def("next_summary", [](Pcap& pcap) -> py::object {
+            std::unique_ptr<Packet> packet;
+
+            {
+                /* serialized with other threads by mutex of pcap */
+                py::gil_scoped_release release;
+                packet = pcap.next_packet(false);
+            }
+
+            if (!packet) {
+                return py::none();
+            }
+
+            /* summary holds parsed fields only, borrowed data may be overwritten by read of another thread */
+            return summary_tuple(*packet);
+        })
+        .def_property_readonly("last_packet_length", &Pcap::last_packet_length)
+        .def_property_readonly("fragments", &Pcap::fragments, py::return_value_policy::reference_internal)
+        .def_property_readonly("link_type", [](const Pcap& pcap) { return str_encap(pcap.link_type()); });
+
+    py::class_<LiveSniffer>(m, "LiveSniffer")
+        .def(py::init())
+        .def("start_sniffing", &LiveSniffer::start_sniffing,
+             py::arg("interface"),
+             py::arg("timeout") = LIVE_TIMEOUT)
+        .def("stop_sniffing", &LiveSniffer::stop_sniffing)
+        .def("next_packet", &LiveSniffer::next_packet,
+             py::arg("copy_data") = true,
+             py::call_guard<py::gil_scoped_release>())
+        .def("next_packets", &LiveSniffer::next_packets,
+             py::arg("max_packets") = 0,
+             py::call_guard<py::gil_scoped_release>())
+        .def("fileno", &LiveSniffer::fileno)
+        .def("set_nonblocking", &LiveSniffer::set_nonblocking)
+        .def_property_readonly("last_packet_length", &LiveSniffer::last_packet_length)
+        .def_property_readonly("fragments", &LiveSniffer::fragments, py::return_value_policy::reference_internal)
+        .def_property_readonly("link_type", [](const LiveSniffer& sniffer) { return str_encap(sniffer.link_type()); });
+
+    py::class_<PacketPrefetcher>(m, "PacketPrefetcher")
+        .def(py::init<Pcap&, unsigned int>(),
+             py::arg("pcap"),
+             py::arg("capacity") = PREFETCH_CAPACITY,
+             py::keep_alive<1, 2>())
+        .def("__iter__", [](py::object prefetcher) { return prefetcher; })
+        .def("__next__", [](PacketPrefetcher& prefetcher) {
+            std::unique_ptr<Packet> packet;
+
+            {
+                py::gil_scoped_release release;
+                packet = prefetcher.next_packet();
+            }
+
+            if (!packet) {
+                throw py::stop_iteration();
+            }
+
+            return packet;
+        });
+
+    py::class_<LatencyHistogram>(m, "LatencyHistogram")
+        .def_property_readonly("count", &LatencyHistogram::count)
+        .def_property_readonly("min", &LatencyHistogram::min)
+        .def_property_readonly("max", &LatencyHistogram::max)
+        .def_property_readonly("mean", &LatencyHistogram::mean)
+        .def_property_readonly("buckets", &LatencyHistogram::buckets)
+        .def("percentile", &LatencyHistogram::percentile);
+
+    py::class_<http_latency>(m, "http_latency")
+        .def_readonly("time_to_first_byte", &http_latency::time_to_first_byte)
+        .def_readonly("total_time", &http_latency::total_time);
+
+    py::class_<http_transaction>(m, "http_transaction")
+        .def_readonly("method", &http_transaction::method)
+        .def_readonly("uri", &http_transaction::uri)
+        .def_readonly("host", &http_transaction::host)
+        .def_readonly("status_code", &http_transaction::status_code)
+        .def_readonly("request_size", &http_transaction::request_size)
+        .def_readonly("response_size", &http_transaction::response_size)
+        .def_readonly("request_time", &http_transaction::request_time)
+        .def_readonly("time_to_first_byte", &http_transaction::time_to_first_byte)
+        .def_readonly("total_time", &http_transaction::total_time);
+
+    py::class_<HTTPTracker>(m, "HTTPTracker")
+        .def(py::init<unsigned int, double, unsigned int>(),
+             py::arg("max_connections") = HTTP_TRACKER_MAX_CONNECTIONS,
+             py::arg("timeout")         = HTTP_TRACKER_TIMEOUT,
+             py::arg("max_keys")        = HTTP_TRACKER_MAX_KEYS)
+        .def("process", &HTTPTracker::process)
+        .def("expire", &HTTPTracker::expire)
+        .def("flush", &HTTPTracker::flush)
+        .def("clear_transactions", &HTTPTracker::clear_transactions)
+        .def_property_readonly("transactions", &HTTPTracker::transactions, py::return_value_policy::copy)
+        .def_property_readonly("latencies", &HTTPTracker::latencies, py::return_value_policy::copy)
+        .def_property_readonly("connection_count", &HTTPTracker::connection_count)
+        .def_property_readonly("unmatched_responses", &HTTPTracker::unmatched_responses)
+        .def_property_readonly("dropped_connections", &HTTPTracker::dropped_connections)
+        .def_property_readonly("dropped_keys", &HTTPTracker::dropped_keys);
+
+    py::class_<dns_transaction>(m, "dns_transaction")
+        .def_property_readonly("client", [](const dns_transaction& transaction) {
+            return str_address(transaction.flow.family, transaction.flow.source);
+        })
+        .def_property_readonly("server", [](const dns_transaction& transaction) {
+            return str_address(transaction.flow.family, transaction.flow.destination);
+        })
+        .def_property_readonly("client_port", [](const dns_transaction& transaction) {
+            return transaction.flow.source_port;
+        })
+        .def_property_readonly("server_port", [](const dns_transaction& transaction) {
+            return transaction.flow.destination_port;
+        })
+        .def_readonly("id", &dns_transaction::id)
+        .def_readonly("question", &dns_transaction::question)
+        .def_readonly("answered", &dns_transaction::answered)
+        .def_readonly("rcode", &dns_transaction::rcode)
+        .def_readonly("query_time", &dns_transaction::query_time)
+        .def_readonly("latency", &dns_transaction::latency)
+        .def_readonly("answers", &dns_transaction::answers);
+
+    py::class_<DNSTracker>(m, "DNSTracker")
+        .def(py::init<unsigned int, double>(),
+             py::arg("max_pending") = DNS_TRACKER_MAX_PENDING,
+             py::arg("timeout")     = DNS_TRACKER_TIMEOUT)
+        .def("process", &DNSTracker::process)
+        .def("expire", &DNSTracker::expire)
+        .def("flush", &DNSTracker::flush)
+        .def("clear_transactions", &DNSTracker::clear_transactions)
+        .def_property_readonly("transactions", &DNSTracker::transactions, py::return_value_policy::copy)
+        .def_property_readonly("latencies", &DNSTracker::latencies)
+        .def_property_readonly("pending_count", &DNSTracker::pending_count)
+        .def_property_readonly("unmatched_responses", &DNSTracker::unmatched_responses)
+        .def_property_readonly("evicted_queries", &DNSTracker::evicted_queries);
+
+    py::class_<topk_entry>(m, "topk_entry")
+        .def_property_readonly("key", [](const topk_entry& entry) { return py::bytes(entry.key); })
+        .def_readonly("count", &topk_entry::count)
+        .def_readonly("error", &topk_entry::error);
+
+    py::class_<TopK>(m, "TopK")
+        .def(py::init<unsigned int>(), py::arg("capacity") = TOPK_CAPACITY)
+        .def("add", [](TopK& topk, py::bytes key, uint64_t weight) { topk.add(std::string(key), weight); },
+             py::arg("key"),
+             py::arg("weight") = 1)
+        .def("estimate", [](const TopK& topk, py::bytes key) { return topk.estimate(std::string(key)); })
+        .def("merge", &TopK::merge)
+        .def("clear", &TopK::clear)
+        .def("top", &TopK::top)
+        .def("__len__", &TopK::size)
+        .def_property_readonly("error_bound", &TopK::error_bound)
+        .def_property_readonly("total", &TopK::total)
+        .def_property_readonly("capacity", &TopK::capacity);
+
+    m.attr("FIELD_SOURCE")      = FIELD_SOURCE;
+    m.attr("FIELD_DESTINATION") = FIELD_DESTINATION;
+    m.attr("FIELD_FLOW")        = FIELD_FLOW;
+    m.attr("FIELD_DNS_NAME")    = FIELD_DNS_NAME;
+
+    py::class_<HyperLogLog>(m, "HyperLogLog")
+        .def(py::init<uint8_t>(), py::arg("precision") = HLL_PRECISION)
+        .def("add", [](HyperLogLog& hll, py::bytes key) { hll.add(std::string(key)); })
+        .def("add_packet", &HyperLogLog::add_packet)
+        .def("merge", &HyperLogLog::merge)
+        .def("clear", &HyperLogLog::clear)
+        .def("estimate", &HyperLogLog::estimate)
+        .def_property_readonly("relative_error", &HyperLogLog::relative_error)
+        .def_property_readonly("precision", &HyperLogLog::precision);
+
+    py::class_<CardinalitySeries>(m, "CardinalitySeries")
+        .def(py::init<double, uint8_t, unsigned int>(),
+             py::arg("interval")    = 60,
+             py::arg("precision")   = HLL_PRECISION,
+             py::arg("max_buckets") = HLL_MAX_BUCKETS)
+        .def("add", [](CardinalitySeries& series, double timestamp, py::bytes key) {
+            series.add(timestamp, std::string(key));
+        })
+        .def("add_packet", &CardinalitySeries::add_packet)
+        .def("merge", &CardinalitySeries::merge)
+        .def("clear", &CardinalitySeries::clear)
+        .def("series", &CardinalitySeries::series)
+        .def("estimate", &CardinalitySeries::estimate)
+        .def_property_readonly("interval", &CardinalitySeries::interval);
+
+    py::class_<PacketBatch>(m, "PacketBatch")
+        .def(py::init<>())
+        .def("append", &PacketBatch::append)
+        .def("read", &PacketBatch::read,
+             py::arg("pcap"),
+             py::arg("max_packets") = 0,
+             py::call_guard<py::gil_scoped_release>())
+        .def("clear", &PacketBatch::clear)
+        .def("__len__", &PacketBatch::size)
+        .def("__arrow_c_schema__", [](const PacketBatch& batch) {
+            ArrowSchema* schema = new ArrowSchema;
+            batch.export_schema(schema);
+
+            return schema_capsule(schema);
+        })
+        .def("__arrow_c_array__", [](const PacketBatch& batch, py::object requested_schema) {
+            ArrowSchema* schema = new ArrowSchema;
+            ArrowArray* array   = new ArrowArray;
+            batch.export_batch(array, schema);
+
+            return py::make_tuple(schema_capsule(schema), array_capsule(array));
+        }, py::arg("requested_schema") = py::none());
+
+    m.def("read_batch", &read_batch, "Dissects pcap into PacketBatch.",
+          py::arg("pcap_path"),
+          py::call_guard<py::gil_scoped_release>());
+
+    m.def("to_numpy", [](const std::string& pcap_path, const std::vector<std::string>& fields) {
+        std::unique_ptr<PacketRecords> records;
+
+        {
+            py::gil_scoped_release release;
+            records.reset(new PacketRecords(read_records(pcap_path, fields)));
+        }
+
+        return records_array(std::move(records));
+    }, "Dissects pcap into NumPy structured array.",
+          py::arg("pcap_path"),
+          py::arg("fields") = std::vector<std::string>());
 }
\ No newline at end of file
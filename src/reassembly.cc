@@ -0,0 +1,368 @@
+/**
+ * @file reassembly.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief IP fragment reassembly.
+ * @version 0.1
+ * @date 2019-05-13
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * https://tools.ietf.org/html/rfc815
+ * https://tools.ietf.org/html/rfc5722
+ */
+
+#include "reassembly.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "common.h"
+
+namespace disspcap {
+
+/**
+ * @brief Compares two fragment keys.
+ *
+ * @param other Other key.
+ * @return true Keys are equal.
+ * @return false Otherwise.
+ */
+bool fragment_key::operator==(const fragment_key& other) const
+{
+    return std::memcmp(this, &other, sizeof(fragment_key)) == 0;
+}
+
+/**
+ * @brief Hashes fragment key.
+ *
+ * @param key Fragment key.
+ * @return size_t Hash value.
+ */
+size_t fragment_key_hash::operator()(const fragment_key& key) const
+{
+    return hash_bytes(&key, sizeof(fragment_key));
+}
+
+/**
+ * @brief Construct a new FragmentCache::FragmentCache object.
+ *
+ * @param max_trains Maximum number of datagrams reassembled at once.
+ * @param timeout Time (seconds) after which incomplete datagram is dropped.
+ * @param overlap_policy How to handle overlapping fragments (FRAG_OVERLAP_*).
+ */
+FragmentCache::FragmentCache(unsigned int max_trains, double timeout, uint8_t overlap_policy)
+    : max_trains_{ 1 }
+    , timeout_{ timeout }
+    , overlap_policy_{ FRAG_OVERLAP_FIRST }
+    , reassembled_{ 0 }
+    , timed_out_{ 0 }
+    , dropped_{ 0 }
+{
+    this->configure(max_trains, timeout, overlap_policy);
+}
+
+/**
+ * @brief Changes reassembly settings.
+ *
+ * Datagrams over new limit are dropped (oldest first), new timeout
+ * applies on next fragment.
+ *
+ * @param max_trains Maximum number of datagrams reassembled at once.
+ * @param timeout Time (seconds) after which incomplete datagram is dropped.
+ * @param overlap_policy How to handle overlapping fragments (FRAG_OVERLAP_*).
+ */
+void FragmentCache::configure(unsigned int max_trains, double timeout, uint8_t overlap_policy)
+{
+    if (overlap_policy > FRAG_OVERLAP_DROP) {
+        throw std::invalid_argument("Unknown fragment overlap policy.");
+    }
+
+    this->max_trains_     = max_trains ? max_trains : 1;
+    this->timeout_        = timeout;
+    this->overlap_policy_ = overlap_policy;
+
+    while (this->trains_.size() > this->max_trains_) {
+        this->erase(this->trains_.find(this->order_.front()));
+        ++this->dropped_;
+    }
+}
+
+/**
+ * @brief Adds fragment, returns whole datagram once all fragments arrived.
+ *
+ * @param key Datagram identification.
+ * @param offset Offset of fragment data in datagram (bytes).
+ * @param data Fragment data (copied).
+ * @param length Fragment data length.
+ * @param more_fragments More fragments flag.
+ * @param timestamp Capture time of fragment.
+ * @param datagram Filled with reassembled payload when complete.
+ * @return true Datagram was completed by this fragment.
+ * @return false Datagram is incomplete or fragment was dropped.
+ */
+bool FragmentCache::add(const fragment_key& key,
+                        unsigned int offset,
+                        const uint8_t* data,
+                        unsigned int length,
+                        bool more_fragments,
+                        double timestamp,
+                        std::vector<uint8_t>& datagram)
+{
+    unsigned int end = offset + length;
+
+    this->expire(timestamp);
+
+    /* malformed fragment - non-last fragments are multiples of 8 bytes */
+    if (end > FRAG_MAX_DATAGRAM || (more_fragments && (length % 8 || !length))) {
+        ++this->dropped_;
+        return false;
+    }
+
+    auto it = this->trains_.find(key);
+
+    if (it == this->trains_.end()) {
+        /* evict oldest datagram */
+        while (this->trains_.size() >= this->max_trains_) {
+            this->erase(this->trains_.find(this->order_.front()));
+            ++this->dropped_;
+        }
+
+        fragment_train train;
+        train.total_length = 0;
+        train.first_seen   = timestamp;
+        train.position     = this->order_.insert(this->order_.end(), key);
+
+        it = this->trains_.insert(std::make_pair(key, std::move(train))).first;
+    }
+
+    fragment_train& train = it->second;
+    bool inconsistent     = false;
+
+    if (!more_fragments) {
+        /* last fragment defines length, no data may lie behind it */
+        inconsistent = (train.total_length && train.total_length != end) ||
+                       (!train.ranges.empty() && train.ranges.back().second > end);
+        train.total_length = end;
+    } else {
+        inconsistent = train.total_length && end > train.total_length;
+    }
+
+    if (inconsistent || (this->overlap_policy_ == FRAG_OVERLAP_DROP && overlaps(train, offset, end))) {
+        this->erase(it);
+        ++this->dropped_;
+        return false;
+    }
+
+    insert(train, offset, end, data, this->overlap_policy_ == FRAG_OVERLAP_LAST);
+
+    /* complete - single range covering whole datagram */
+    if (!train.total_length || train.ranges.size() != 1 || train.ranges[0].first != 0 ||
+        train.ranges[0].second != train.total_length) {
+        return false;
+    }
+
+    datagram.swap(train.data);
+    this->erase(it);
+    ++this->reassembled_;
+
+    return true;
+}
+
+/**
+ * @brief Drops datagrams older than timeout.
+ *
+ * @param now Current time (seconds since epoch).
+ */
+void FragmentCache::expire(double now)
+{
+    while (!this->order_.empty()) {
+        auto it = this->trains_.find(this->order_.front());
+
+        if (it->second.first_seen + this->timeout_ >= now) {
+            break;
+        }
+
+        this->erase(it);
+        ++this->timed_out_;
+    }
+}
+
+/**
+ * @brief Drops all incomplete datagrams.
+ */
+void FragmentCache::clear()
+{
+    this->trains_.clear();
+    this->order_.clear();
+}
+
+/**
+ * @brief Getter of number of incomplete datagrams.
+ *
+ * @return unsigned int Number of datagrams.
+ */
+unsigned int FragmentCache::size() const
+{
+    return this->trains_.size();
+}
+
+/**
+ * @brief Getter of maximum number of datagrams reassembled at once.
+ *
+ * @return unsigned int Number of datagrams.
+ */
+unsigned int FragmentCache::max_trains() const
+{
+    return this->max_trains_;
+}
+
+/**
+ * @brief Getter of reassembly timeout.
+ *
+ * @return double Seconds.
+ */
+double FragmentCache::timeout() const
+{
+    return this->timeout_;
+}
+
+/**
+ * @brief Getter of overlap policy.
+ *
+ * @return uint8_t FRAG_OVERLAP_* value.
+ */
+uint8_t FragmentCache::overlap_policy() const
+{
+    return this->overlap_policy_;
+}
+
+/**
+ * @brief Getter of number of reassembled datagrams.
+ *
+ * @return uint64_t Number of datagrams.
+ */
+uint64_t FragmentCache::reassembled() const
+{
+    return this->reassembled_;
+}
+
+/**
+ * @brief Getter of number of datagrams dropped on timeout.
+ *
+ * @return uint64_t Number of datagrams.
+ */
+uint64_t FragmentCache::timed_out() const
+{
+    return this->timed_out_;
+}
+
+/**
+ * @brief Getter of number of dropped fragments and datagrams (malformed, overlapping, evicted).
+ *
+ * @return uint64_t Number of drops.
+ */
+uint64_t FragmentCache::dropped() const
+{
+    return this->dropped_;
+}
+
+/**
+ * @brief Removes datagram from cache and from arrival order queue.
+ *
+ * @param it Datagram to remove.
+ */
+void FragmentCache::erase(std::unordered_map<fragment_key, fragment_train, fragment_key_hash>::iterator it)
+{
+    this->order_.erase(it->second.position);
+    this->trains_.erase(it);
+}
+
+/**
+ * @brief Checks whether range overlaps already received data.
+ *
+ * @param train Datagram under reassembly.
+ * @param begin Range begin.
+ * @param end Range end.
+ * @return true Some bytes were already received.
+ * @return false Otherwise.
+ */
+bool FragmentCache::overlaps(const fragment_train& train, unsigned int begin, unsigned int end)
+{
+    for (const auto& range : train.ranges) {
+        if (range.first < end && begin < range.second) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Copies fragment data into datagram and records received range.
+ *
+ * @param train Datagram under reassembly.
+ * @param begin Fragment offset.
+ * @param end Fragment end.
+ * @param data Fragment data.
+ * @param overwrite Overwrite already received bytes.
+ */
+void FragmentCache::insert(fragment_train& train, unsigned int begin, unsigned int end, const uint8_t* data, bool overwrite)
+{
+    auto& ranges = train.ranges;
+
+    if (train.data.size() < end) {
+        train.data.resize(end);
+    }
+
+    if (overwrite) {
+        std::memcpy(train.data.data() + begin, data, end - begin);
+    } else {
+        /* fill only holes */
+        unsigned int cursor = begin;
+
+        for (const auto& range : ranges) {
+            if (range.second <= cursor) {
+                continue;
+            }
+
+            if (range.first >= end) {
+                break;
+            }
+
+            if (range.first > cursor) {
+                std::memcpy(train.data.data() + cursor, data + (cursor - begin), range.first - cursor);
+            }
+
+            cursor = range.second;
+        }
+
+        if (cursor < end) {
+            std::memcpy(train.data.data() + cursor, data + (cursor - begin), end - cursor);
+        }
+    }
+
+    /* in order fragment - extend last range */
+    if (!ranges.empty() && ranges.back().second == begin) {
+        ranges.back().second = end;
+        return;
+    }
+
+    auto position = std::lower_bound(ranges.begin(), ranges.end(), std::make_pair(begin, end));
+    ranges.insert(position, std::make_pair(begin, end));
+
+    /* merge touching ranges */
+    unsigned int merged = 0;
+
+    for (unsigned int i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].first <= ranges[merged].second) {
+            ranges[merged].second = std::max(ranges[merged].second, ranges[i].second);
+        } else {
+            ranges[++merged] = ranges[i];
+        }
+    }
+
+    ranges.resize(merged + 1);
+}
+}
\ No newline at end of file
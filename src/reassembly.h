@@ -0,0 +1,112 @@
+/**
+ * @file reassembly.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief IP fragment reassembly.
+ * @version 0.1
+ * @date 2019-05-13
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * https://tools.ietf.org/html/rfc815
+ * https://tools.ietf.org/html/rfc5722
+ */
+
+#ifndef DISSPCAP_REASSEMBLY_H
+#define DISSPCAP_REASSEMBLY_H
+
+#include <list>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace disspcap {
+
+const unsigned int FRAG_MAX_TRAINS   = 1024;  /**< Default number of datagrams reassembled at once. */
+const double FRAG_TIMEOUT            = 30;    /**< Default reassembly timeout (seconds). */
+const unsigned int FRAG_MAX_DATAGRAM = 65535; /**< Maximum reassembled payload length. */
+
+const uint8_t FRAG_OVERLAP_FIRST = 0; /**< Overlapping data - keep bytes received first. */
+const uint8_t FRAG_OVERLAP_LAST  = 1; /**< Overlapping data - keep bytes received last. */
+const uint8_t FRAG_OVERLAP_DROP  = 2; /**< Overlapping data - drop whole datagram (RFC 5722). */
+
+/**
+ * @brief Identification of fragmented datagram.
+ *
+ * IPv4 addresses occupy first 4 bytes of address fields.
+ */
+struct fragment_key {
+    uint8_t family;
+    uint8_t protocol;
+    uint32_t id;
+    uint8_t source[16];
+    uint8_t destination[16];
+    bool operator==(const fragment_key& other) const;
+} __attribute__((packed));
+
+/**
+ * @brief Hash functor of fragment_key.
+ */
+struct fragment_key_hash {
+    size_t operator()(const fragment_key& key) const;
+};
+
+/**
+ * @brief Datagram under reassembly.
+ */
+struct fragment_train {
+    std::vector<uint8_t> data;
+    std::vector<std::pair<unsigned int, unsigned int>> ranges; /**< Received [begin, end), sorted. */
+    unsigned int total_length;                                 /**< 0 until last fragment arrives. */
+    double first_seen;
+    std::list<fragment_key>::iterator position; /**< Entry in arrival order queue. */
+};
+
+/**
+ * @brief Bounded cache of fragment trains shared by IPv4 and IPv6.
+ *
+ * Fragments have to be copied because capture buffers are reused, but
+ * in-order fragments are appended to one contiguous buffer which is
+ * handed over to caller without another copy.
+ */
+class FragmentCache {
+public:
+    FragmentCache(unsigned int max_trains = FRAG_MAX_TRAINS,
+                  double timeout          = FRAG_TIMEOUT,
+                  uint8_t overlap_policy  = FRAG_OVERLAP_FIRST);
+    bool add(const fragment_key& key,
+             unsigned int offset,
+             const uint8_t* data,
+             unsigned int length,
+             bool more_fragments,
+             double timestamp,
+             std::vector<uint8_t>& datagram);
+    void configure(unsigned int max_trains, double timeout, uint8_t overlap_policy);
+    void expire(double now);
+    void clear();
+    unsigned int size() const;
+    unsigned int max_trains() const;
+    double timeout() const;
+    uint8_t overlap_policy() const;
+    uint64_t reassembled() const;
+    uint64_t timed_out() const;
+    uint64_t dropped() const;
+
+private:
+    std::unordered_map<fragment_key, fragment_train, fragment_key_hash> trains_;
+    std::list<fragment_key> order_; /**< Keys of trains, oldest first. */
+    unsigned int max_trains_;
+    double timeout_;
+    uint8_t overlap_policy_;
+    uint64_t reassembled_;
+    uint64_t timed_out_;
+    uint64_t dropped_;
+    void erase(std::unordered_map<fragment_key, fragment_train, fragment_key_hash>::iterator it);
+    static bool overlaps(const fragment_train& train, unsigned int begin, unsigned int end);
+    static void insert(fragment_train& train, unsigned int begin, unsigned int end, const uint8_t* data, bool overwrite);
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,426 @@
+/**
+ * @file scan.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Delimiter scanning of text protocols (SSE2/AVX2).
+ * @version 0.1
+ * @date 2019-06-24
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Blocks of 32 (AVX2) or 16 (SSE2) bytes are compared at once, the
+ * first match is found from movemask bits, the rest of data shorter than
+ * block is scanned byte by byte. Kernel is selected at run time by CPU
+ * features (AVX2 is compiled in by target attribute, no -mavx2 needed).
+ */
+
+#include "scan.h"
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+namespace disspcap {
+
+/**
+ * @brief Checks whether byte is printable ASCII (isprint() in C locale).
+ *
+ * @param c Byte.
+ * @return true Byte is in 0x20 - 0x7e.
+ * @return false Otherwise.
+ */
+static inline bool printable(uint8_t c)
+{
+    return c >= 0x20 && c < 0x7f;
+}
+
+typedef const uint8_t* (*find_either_t)(const uint8_t*, const uint8_t*, uint8_t, uint8_t);
+typedef const uint8_t* (*find_unprintable_t)(const uint8_t*, const uint8_t*, uint8_t, bool);
+
+/**
+ * @brief Scanning kernel (one instruction set).
+ */
+struct scan_kernel_set {
+    const char* name;
+    find_either_t find_either;
+    find_unprintable_t find_unprintable;
+};
+
+/**
+ * @brief Scalar find_either() (also tail of vector kernels).
+ */
+static const uint8_t* find_either_scalar(const uint8_t* p, const uint8_t* end, uint8_t first, uint8_t second)
+{
+    for (; p < end; ++p) {
+        if (*p == first || *p == second) {
+            return p;
+        }
+    }
+
+    return end;
+}
+
+/**
+ * @brief Scalar find_unprintable() (also tail of vector kernels).
+ */
+static const uint8_t* find_unprintable_scalar(const uint8_t* p, const uint8_t* end, uint8_t delimiter, bool allow_space)
+{
+    for (; p < end; ++p) {
+        if (*p == delimiter || !(printable(*p) || (allow_space && *p >= 0x09 && *p <= 0x0d))) {
+            return p;
+        }
+    }
+
+    return end;
+}
+
+#ifdef SCAN_X86
+
+/**
+ * @brief SSE2 find_either(), 16 bytes per step.
+ */
+__attribute__((target("sse2"))) static const uint8_t* find_either_sse2(const uint8_t* p,
+                                                                       const uint8_t* end,
+                                                                       uint8_t first,
+                                                                       uint8_t second)
+{
+    __m128i a = _mm_set1_epi8(static_cast<char>(first));
+    __m128i b = _mm_set1_epi8(static_cast<char>(second));
+
+    for (; end - p >= 16; p += 16) {
+        __m128i data  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t hits = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(data, a), _mm_cmpeq_epi8(data, b)));
+
+        if (hits) {
+            return p + __builtin_ctz(hits);
+        }
+    }
+
+    return find_either_scalar(p, end, first, second);
+}
+
+/**
+ * @brief SSE2 find_unprintable(), 16 bytes per step.
+ */
+__attribute__((target("sse2"))) static const uint8_t* find_unprintable_sse2(const uint8_t* p,
+                                                                            const uint8_t* end,
+                                                                            uint8_t delimiter,
+                                                                            bool allow_space)
+{
+    __m128i d          = _mm_set1_epi8(static_cast<char>(delimiter));
+    __m128i low        = _mm_set1_epi8(0x1f);
+    __m128i top        = _mm_set1_epi8(0x7f);
+    __m128i space_low  = _mm_set1_epi8(allow_space ? 0x08 : 0x7f);
+    __m128i space_high = _mm_set1_epi8(0x0e);
+
+    for (; end - p >= 16; p += 16) {
+        __m128i data  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        /* signed compare - bytes above 0x7f are negative, so not printable */
+        __m128i print = _mm_and_si128(_mm_cmpgt_epi8(data, low), _mm_cmpgt_epi8(top, data));
+        __m128i space = _mm_and_si128(_mm_cmpgt_epi8(data, space_low), _mm_cmpgt_epi8(space_high, data));
+        uint32_t hits = ~_mm_movemask_epi8(_mm_or_si128(print, space)) | _mm_movemask_epi8(_mm_cmpeq_epi8(data, d));
+
+        hits &= 0xffffu;
+
+        if (hits) {
+            return p + __builtin_ctz(hits);
+        }
+    }
+
+    return find_unprintable_scalar(p, end, delimiter, allow_space);
+}
+
+/**
+ * @brief AVX2 find_either(), 32 bytes per step.
+ */
+__attribute__((target("avx2"))) static const uint8_t* find_either_avx2(const uint8_t* p,
+                                                                       const uint8_t* end,
+                                                                       uint8_t first,
+                                                                       uint8_t second)
+{
+    __m256i a = _mm256_set1_epi8(static_cast<char>(first));
+    __m256i b = _mm256_set1_epi8(static_cast<char>(second));
+
+    for (; end - p >= 32; p += 32) {
+        __m256i data  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        uint32_t hits = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(data, a), _mm256_cmpeq_epi8(data, b)));
+
+        if (hits) {
+            return p + __builtin_ctz(hits);
+        }
+    }
+
+    return find_either_scalar(p, end, first, second);
+}
+
+/**
+ * @brief AVX2 find_unprintable(), 32 bytes per step.
+ */
+__attribute__((target("avx2"))) static const uint8_t* find_unprintable_avx2(const uint8_t* p,
+                                                                            const uint8_t* end,
+                                                                            uint8_t delimiter,
+                                                                            bool allow_space)
+{
+    __m256i d          = _mm256_set1_epi8(static_cast<char>(delimiter));
+    __m256i low        = _mm256_set1_epi8(0x1f);
+    __m256i top        = _mm256_set1_epi8(0x7f);
+    __m256i space_low  = _mm256_set1_epi8(allow_space ? 0x08 : 0x7f);
+    __m256i space_high = _mm256_set1_epi8(0x0e);
+
+    for (; end - p >= 32; p += 32) {
+        __m256i data  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        /* signed compare - bytes above 0x7f are negative, so not printable */
+        __m256i print = _mm256_and_si256(_mm256_cmpgt_epi8(data, low), _mm256_cmpgt_epi8(top, data));
+        __m256i space = _mm256_and_si256(_mm256_cmpgt_epi8(data, space_low), _mm256_cmpgt_epi8(space_high, data));
+        uint32_t hits = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(print, space))) |
+                        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, d)));
+
+        if (hits) {
+            return p + __builtin_ctz(hits);
+        }
+    }
+
+    return find_unprintable_scalar(p, end, delimiter, allow_space);
+}
+
+#endif
+
+/**
+ * @brief All kernels, from the slowest.
+ */
+static const scan_kernel_set KERNELS[] = {
+    { "scalar", find_either_scalar, find_unprintable_scalar },
+#ifdef SCAN_X86
+    { "sse2", find_either_sse2, find_unprintable_sse2 },
+    { "avx2", find_either_avx2, find_unprintable_avx2 },
+#endif
+};
+
+const unsigned int KERNEL_COUNT = sizeof(KERNELS) / sizeof(KERNELS[0]);
+
+/**
+ * @brief Checks whether CPU runs kernel.
+ *
+ * @param kernel Kernel.
+ * @return true Instruction set is supported.
+ * @return false Otherwise.
+ */
+static bool supported(const scan_kernel_set& kernel)
+{
+#ifdef SCAN_X86
+    if (std::strcmp(kernel.name, "sse2") == 0) {
+        return __builtin_cpu_supports("sse2");
+    }
+
+    if (std::strcmp(kernel.name, "avx2") == 0) {
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+
+    return true;
+}
+
+/**
+ * @brief Kernel in use, the fastest supported one unless set_scan_kernel() was called.
+ */
+static std::atomic<const scan_kernel_set*> active_kernel{ nullptr };
+
+/**
+ * @brief Getter of kernel in use (selected on first call).
+ *
+ * @return const scan_kernel_set& Kernel.
+ */
+static const scan_kernel_set& kernel()
+{
+    const scan_kernel_set* active = active_kernel.load(std::memory_order_relaxed);
+
+    if (!active) {
+#ifdef SCAN_X86
+        __builtin_cpu_init();
+#endif
+        active = &KERNELS[0];
+
+        for (unsigned int i = 0; i < KERNEL_COUNT; ++i) {
+            if (supported(KERNELS[i])) {
+                active = &KERNELS[i];
+            }
+        }
+
+        active_kernel.store(active, std::memory_order_relaxed);
+    }
+
+    return *active;
+}
+
+/**
+ * @brief Finds first occurrence of either of two bytes.
+ *
+ * @param begin Data begin.
+ * @param end Data end.
+ * @param first First byte.
+ * @param second Second byte.
+ * @return const uint8_t* Position of byte, end if there is none (begin if data are empty).
+ */
+const uint8_t* find_either(const uint8_t* begin, const uint8_t* end, uint8_t first, uint8_t second)
+{
+    if (begin >= end) {
+        return begin;
+    }
+
+    return kernel().find_either(begin, end, first, second);
+}
+
+/**
+ * @brief Finds first delimiter or non-printable byte (incl. NUL, CR, LF).
+ *
+ * @param begin Data begin.
+ * @param end Data end.
+ * @param delimiter Delimiter (NUL if only non-printables are searched).
+ * @param allow_space Whitespace (HT, LF, VT, FF, CR) is not reported.
+ * @return const uint8_t* Position of byte, end if there is none (begin if data are empty).
+ */
+const uint8_t* find_unprintable(const uint8_t* begin, const uint8_t* end, uint8_t delimiter, bool allow_space)
+{
+    if (begin >= end) {
+        return begin;
+    }
+
+    return kernel().find_unprintable(begin, end, delimiter, allow_space);
+}
+
+/**
+ * @brief Finds end of text line - CRLF or NUL.
+ *
+ * Last byte is never examined as line end, since CR needs LF after it.
+ *
+ * @param begin Data begin.
+ * @param end Data end.
+ * @return const uint8_t* Position of CR (or NUL), end - 1 if there is none (begin if data are shorter).
+ */
+const uint8_t* find_line_end(const uint8_t* begin, const uint8_t* end)
+{
+    if (end - begin < 2) {
+        return begin;
+    }
+
+    const uint8_t* limit = end - 1;
+    const uint8_t* p     = begin;
+
+    while ((p = find_either(p, limit, '\r', '\0')) < limit) {
+        if (*p == '\0' || p[1] == '\n') {
+            return p;
+        }
+
+        ++p;
+    }
+
+    return limit;
+}
+
+/**
+ * @brief Appends data with non-printable bytes replaced by %xx escapes (see string_hexa()).
+ *
+ * Clean runs between escaped bytes are found by find_unprintable() and
+ * copied at once into output grown for the worst case.
+ *
+ * @param output String to append to.
+ * @param data Data.
+ * @param length Data length.
+ * @param allow_space Whitespace (HT, LF, VT, FF, CR) is kept.
+ */
+void append_escaped(std::string& output, const uint8_t* data, unsigned int length, bool allow_space)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    const uint8_t* p   = data;
+    const uint8_t* end = data + length;
+    size_t start       = output.size();
+
+    output.resize(start + 3 * static_cast<size_t>(length));
+    char* out = &output[start];
+
+    while (p < end) {
+        const uint8_t* stop = find_unprintable(p, end, '\0', allow_space);
+
+        std::memcpy(out, p, stop - p);
+        out += stop - p;
+
+        if (stop == end) {
+            break;
+        }
+
+        *out++ = '%';
+        *out++ = hex[*stop >> 4];
+        *out++ = hex[*stop & 0x0f];
+        p      = stop + 1;
+    }
+
+    output.resize(out - output.data());
+}
+
+/**
+ * @brief Replaces non-printable bytes with %xx escapes.
+ *
+ * @param data Data.
+ * @param length Data length.
+ * @param allow_space Whitespace (HT, LF, VT, FF, CR) is kept.
+ * @return std::string Escaped data.
+ */
+std::string escape_unprintable(const uint8_t* data, unsigned int length, bool allow_space)
+{
+    std::string escaped;
+
+    append_escaped(escaped, data, length, allow_space);
+
+    return escaped;
+}
+
+/**
+ * @brief Getter of scanning kernel in use.
+ *
+ * @return const char* "avx2", "sse2" or "scalar".
+ */
+const char* scan_kernel()
+{
+    return kernel().name;
+}
+
+/**
+ * @brief Getter of kernels supported by CPU.
+ *
+ * @return std::vector<std::string> Kernel names, from the slowest.
+ */
+std::vector<std::string> scan_kernels()
+{
+    std::vector<std::string> names;
+
+    for (unsigned int i = 0; i < KERNEL_COUNT; ++i) {
+        if (supported(KERNELS[i])) {
+            names.push_back(KERNELS[i].name);
+        }
+    }
+
+    return names;
+}
+
+/**
+ * @brief Switches scanning kernel (e.g. to compare them), affects all threads.
+ *
+ * @param name Kernel name (see scan_kernels()).
+ */
+void set_scan_kernel(const std::string& name)
+{
+    for (unsigned int i = 0; i < KERNEL_COUNT; ++i) {
+        if (name == KERNELS[i].name && supported(KERNELS[i])) {
+            active_kernel.store(&KERNELS[i], std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    throw std::invalid_argument("Unsupported scan kernel: " + name);
+}
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+/**
+ * @file scan.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Delimiter scanning of text protocols (SSE2/AVX2).
+ * @version 0.1
+ * @date 2019-06-24
+ *
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_SCAN_H
+#define DISSPCAP_SCAN_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace disspcap {
+
+const uint8_t* find_either(const uint8_t* begin, const uint8_t* end, uint8_t first, uint8_t second);
+const uint8_t* find_unprintable(const uint8_t* begin, const uint8_t* end, uint8_t delimiter, bool allow_space = false);
+const uint8_t* find_line_end(const uint8_t* begin, const uint8_t* end);
+void append_escaped(std::string& output, const uint8_t* data, unsigned int length, bool allow_space = false);
+std::string escape_unprintable(const uint8_t* data, unsigned int length, bool allow_space = false);
+const char* scan_kernel();
+std::vector<std::string> scan_kernels();
+void set_scan_kernel(const std::string& name);
+}
+
+#endif
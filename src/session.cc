@@ -0,0 +1,523 @@
+/**
+ * @file session.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Per-connection transcripts of line protocols (IRC, Telnet).
+ * @version 0.1
+ * @date 2019-06-14
+ *
+ * @copyright Copyright (c) 2019
+ */
+
+#include "session.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "scan.h"
+
+namespace disspcap {
+
+/**
+ * @brief Copies text of transcript line.
+ *
+ * @param index Line index.
+ * @return std::string Line text (without line end).
+ */
+std::string session_transcript::text(unsigned int index) const
+{
+    const session_line& line = this->lines[index];
+
+    return this->chunks[line.chunk].substr(line.offset, line.length);
+}
+
+/**
+ * @brief Construct a new SessionBuilder object.
+ *
+ * @param max_session_bytes Memory cap of one session.
+ * @param max_total_bytes Memory cap of all open sessions.
+ * @param timeout Idle time (seconds) after which session is finished.
+ * @param max_kept_bytes Memory cap of finished transcripts kept (without output file).
+ */
+SessionBuilder::SessionBuilder(uint64_t max_session_bytes,
+                               uint64_t max_total_bytes,
+                               double timeout,
+                               uint64_t max_kept_bytes)
+    : max_session_bytes_{ max_session_bytes }
+    , max_total_bytes_{ max_total_bytes }
+    , timeout_{ timeout }
+    , max_kept_bytes_{ max_kept_bytes }
+    , memory_{ 0 }
+    , kept_memory_{ 0 }
+    , evicted_sessions_{ 0 }
+    , dropped_transcripts_{ 0 }
+{
+}
+
+/**
+ * @brief Processes packet - adds its segment to session transcript.
+ *
+ * @param packet Dissected packet.
+ * @return true Packet belongs to IRC or Telnet session.
+ * @return false Otherwise.
+ */
+bool SessionBuilder::process(const Packet& packet)
+{
+    const TCP* tcp = packet.tcp();
+    flow_key key;
+    uint8_t protocol;
+
+    if (packet.telnet()) {
+        protocol = SESSION_TELNET;
+    } else if (packet.irc()) {
+        protocol = SESSION_IRC;
+    } else {
+        return false;
+    }
+
+    if (!tcp || !make_flow_key(packet, key)) {
+        return false;
+    }
+
+    double now = packet.timestamp();
+
+    this->expire(now);
+
+    bool from_client = true;
+    auto it          = this->sessions_.find(key);
+
+    if (it == this->sessions_.end()) {
+        it          = this->sessions_.find(key.reversed());
+        from_client = false;
+    }
+
+    if (it == this->sessions_.end()) {
+        if (!tcp->syn() && tcp->payload_length() == 0) {
+            /* late ACK or FIN of finished session */
+            return true;
+        }
+
+        /* SYN comes from client, otherwise server is the side with lower port */
+        from_client = tcp->syn() ? !tcp->ack() : key.source_port >= key.destination_port;
+
+        session_state session;
+        session.transcript.flow      = from_client ? key : key.reversed();
+        session.transcript.protocol  = protocol;
+        session.transcript.start     = now;
+        session.transcript.end       = now;
+        session.transcript.closed    = false;
+        session.transcript.truncated = false;
+        session.transcript.gaps      = 0;
+        session.memory               = sizeof(session_state);
+
+        for (session_direction& direction : session.directions) {
+            direction.next_seq     = 0;
+            direction.synchronized = false;
+            direction.finished     = false;
+        }
+
+        this->memory_ += session.memory;
+        session.position = this->activity_.insert(this->activity_.end(), session.transcript.flow);
+        it               = this->sessions_.insert(std::make_pair(session.transcript.flow, std::move(session))).first;
+    }
+
+    session_state& session       = it->second;
+    session_direction& direction = session.directions[from_client ? 0 : 1];
+    const uint8_t* payload       = tcp->payload();
+    unsigned int length          = tcp->payload_length();
+    uint32_t seq                 = tcp->seq_number() + tcp->syn();
+
+    if (!direction.synchronized) {
+        /* pure ACKs may be stale, stream starts with SYN or data */
+        if (tcp->syn() || length > 0) {
+            direction.next_seq     = seq;
+            direction.synchronized = true;
+        }
+    } else {
+        int32_t offset = direction.next_seq - seq;
+
+        if (offset > 0) {
+            /* retransmission - skip already added bytes */
+            unsigned int skip = std::min<unsigned int>(offset, length);
+            payload += skip;
+            length -= skip;
+            seq += skip;
+        } else if (offset < 0 && length > 0) {
+            /* lost segment - unfinished line ends here */
+            ++session.transcript.gaps;
+            direction.telnet.reset();
+
+            if (!direction.partial.empty()) {
+                this->add_line(session, from_client, direction.partial.data(), direction.partial.size(), now);
+                direction.partial.clear();
+            }
+        }
+    }
+
+    /* stale segments (e.g. delayed ACKs) do not move stream back */
+    if (direction.synchronized && static_cast<int32_t>(seq + length - direction.next_seq) > 0) {
+        direction.next_seq = seq + length;
+    }
+
+    session.last_seen      = now;
+    session.transcript.end = now;
+    this->activity_.splice(this->activity_.end(), this->activity_, session.position);
+
+    if (length > 0) {
+        this->text_.clear();
+
+        if (protocol == SESSION_TELNET) {
+            this->commands_.clear();
+            direction.telnet.feed(payload, length, this->text_, this->commands_);
+        } else {
+            append_escaped(this->text_, payload, length, true);
+        }
+
+        this->append(session, from_client, now);
+    }
+
+    if (tcp->fin()) {
+        direction.finished = true;
+    }
+
+    if (tcp->rst() || (session.directions[0].finished && session.directions[1].finished)) {
+        session.transcript.closed = true;
+        this->finish(session);
+        this->erase(it);
+    }
+
+    if (this->memory_ > this->max_total_bytes_) {
+        this->evict();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Finishes sessions idle for longer than timeout.
+ *
+ * Only expired sessions are visited (from least recently active).
+ *
+ * @param now Current time (seconds since epoch).
+ */
+void SessionBuilder::expire(double now)
+{
+    while (!this->activity_.empty()) {
+        auto it = this->sessions_.find(this->activity_.front());
+
+        if (now - it->second.last_seen <= this->timeout_) {
+            break;
+        }
+
+        this->finish(it->second);
+        this->erase(it);
+    }
+}
+
+/**
+ * @brief Finishes all open sessions (e.g. at the end of pcap).
+ */
+void SessionBuilder::flush()
+{
+    for (auto& session : this->sessions_) {
+        this->finish(session.second);
+    }
+
+    this->sessions_.clear();
+    this->activity_.clear();
+
+    if (this->output_.is_open()) {
+        this->output_.flush();
+    }
+}
+
+/**
+ * @brief Writes finished transcripts into file instead of keeping them.
+ *
+ * @param path Output file (truncated).
+ */
+void SessionBuilder::set_output(const std::string& path)
+{
+    if (this->output_.is_open()) {
+        this->output_.close();
+    }
+
+    this->output_.open(path, std::ios::out | std::ios::trunc);
+
+    if (!this->output_.is_open()) {
+        throw std::runtime_error("Could not open transcript output: " + path);
+    }
+}
+
+/**
+ * @brief Getter of finished transcripts (empty if output file is set).
+ *
+ * @return const std::vector<session_transcript>& Transcripts in order of finishing.
+ */
+const std::vector<session_transcript>& SessionBuilder::transcripts() const
+{
+    return this->transcripts_;
+}
+
+/**
+ * @brief Drops finished transcripts (e.g. after they were consumed).
+ */
+void SessionBuilder::clear_transcripts()
+{
+    this->transcripts_.clear();
+    this->kept_memory_ = 0;
+}
+
+/**
+ * @brief Getter of number of open sessions.
+ *
+ * @return unsigned int Number of sessions.
+ */
+unsigned int SessionBuilder::session_count() const
+{
+    return this->sessions_.size();
+}
+
+/**
+ * @brief Getter of memory held by open sessions.
+ *
+ * @return uint64_t Accounted bytes.
+ */
+uint64_t SessionBuilder::memory() const
+{
+    return this->memory_;
+}
+
+/**
+ * @brief Getter of number of sessions finished early because of global cap.
+ *
+ * @return uint64_t Number of evicted sessions.
+ */
+uint64_t SessionBuilder::evicted_sessions() const
+{
+    return this->evicted_sessions_;
+}
+
+/**
+ * @brief Getter of memory held by finished transcripts kept.
+ *
+ * @return uint64_t Accounted bytes.
+ */
+uint64_t SessionBuilder::kept_memory() const
+{
+    return this->kept_memory_;
+}
+
+/**
+ * @brief Getter of number of finished transcripts dropped because of max_kept_bytes.
+ *
+ * @return uint64_t Number of transcripts.
+ */
+uint64_t SessionBuilder::dropped_transcripts() const
+{
+    return this->dropped_transcripts_;
+}
+
+/**
+ * @brief Frames decoded segment (this->text_) into lines.
+ *
+ * Only new data are scanned, unfinished line is kept in direction state
+ * and its buffer is accounted in session memory.
+ *
+ * @param session Session.
+ * @param from_client Segment direction.
+ * @param timestamp Segment time.
+ */
+void SessionBuilder::append(session_state& session, bool from_client, double timestamp)
+{
+    session_direction& direction = session.directions[from_client ? 0 : 1];
+    const char* p                = this->text_.data();
+    const char* end              = p + this->text_.size();
+    size_t capacity              = direction.partial.capacity();
+
+    /* lines of truncated transcript are not stored */
+    if (session.transcript.truncated) {
+        return;
+    }
+
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* stop    = newline ? newline : end;
+        unsigned int room   = SESSION_CHUNK_SIZE - direction.partial.size();
+
+        if (static_cast<unsigned int>(stop - p) > room) {
+            /* too long line is split */
+            direction.partial.append(p, room);
+            this->add_line(session, from_client, direction.partial.data(), direction.partial.size(), timestamp);
+            direction.partial.clear();
+            p += room;
+            continue;
+        }
+
+        direction.partial.append(p, stop - p);
+
+        if (!newline) {
+            break;
+        }
+
+        if (!direction.partial.empty() && direction.partial.back() == '\r') {
+            direction.partial.pop_back();
+        }
+
+        this->add_line(session, from_client, direction.partial.data(), direction.partial.size(), timestamp);
+        direction.partial.clear();
+        p = newline + 1;
+    }
+
+    /* buffer only grows (clear() keeps capacity), it is released with session */
+    uint64_t grown = direction.partial.capacity() - capacity;
+    session.memory += grown;
+    this->memory_ += grown;
+}
+
+/**
+ * @brief Stores line into transcript chunks.
+ *
+ * @param session Session.
+ * @param from_client Line direction.
+ * @param data Line text.
+ * @param length Text length (at most SESSION_CHUNK_SIZE).
+ * @param timestamp Line time.
+ */
+void SessionBuilder::add_line(session_state& session,
+                              bool from_client,
+                              const char* data,
+                              unsigned int length,
+                              double timestamp)
+{
+    session_transcript& transcript = session.transcript;
+
+    if (transcript.truncated) {
+        return;
+    }
+
+    bool new_chunk = transcript.chunks.empty() || transcript.chunks.back().size() + length > SESSION_CHUNK_SIZE;
+    uint64_t cost  = sizeof(session_line) + (new_chunk ? SESSION_CHUNK_SIZE : 0);
+
+    if (session.memory + cost > this->max_session_bytes_) {
+        transcript.truncated = true;
+        return;
+    }
+
+    if (new_chunk) {
+        transcript.chunks.push_back(std::string());
+        transcript.chunks.back().reserve(SESSION_CHUNK_SIZE);
+    }
+
+    std::string& chunk = transcript.chunks.back();
+    session_line line  = { timestamp,
+                          from_client,
+                          static_cast<uint32_t>(transcript.chunks.size() - 1),
+                          static_cast<uint32_t>(chunk.size()),
+                          length };
+
+    chunk.append(data, length);
+    transcript.lines.push_back(line);
+
+    session.memory += cost;
+    this->memory_ += cost;
+}
+
+/**
+ * @brief Ends session - unfinished lines are added and transcript is emitted.
+ *
+ * @param session Session (erased by caller).
+ */
+void SessionBuilder::finish(session_state& session)
+{
+    for (unsigned int i = 0; i < 2; ++i) {
+        session_direction& direction = session.directions[i];
+
+        if (!direction.partial.empty()) {
+            this->add_line(session, i == 0, direction.partial.data(), direction.partial.size(), session.last_seen);
+            direction.partial.clear();
+        }
+    }
+
+    this->memory_ -= session.memory;
+
+    if (this->output_.is_open()) {
+        write_transcript(this->output_, session.transcript);
+    } else if (this->kept_memory_ + session.memory > this->max_kept_bytes_) {
+        ++this->dropped_transcripts_;
+    } else {
+        this->kept_memory_ += session.memory;
+        this->transcripts_.push_back(std::move(session.transcript));
+    }
+}
+
+/**
+ * @brief Removes session from table and from activity order.
+ *
+ * @param it Session to remove.
+ */
+void SessionBuilder::erase(std::unordered_map<flow_key, session_state, flow_key_hash>::iterator it)
+{
+    this->activity_.erase(it->second.position);
+    this->sessions_.erase(it);
+}
+
+/**
+ * @brief Finishes least recently active sessions until memory fits global cap.
+ */
+void SessionBuilder::evict()
+{
+    while (this->memory_ > this->max_total_bytes_ && !this->activity_.empty()) {
+        auto oldest = this->sessions_.find(this->activity_.front());
+
+        this->finish(oldest->second);
+        this->erase(oldest);
+        ++this->evicted_sessions_;
+    }
+}
+
+/**
+ * @brief Writes transcript in text form.
+ *
+ * Header line "# client -> server protocol start end flags" is followed
+ * by "timestamp C: text" (client) or "timestamp S: text" (server) lines.
+ *
+ * @param out Output stream.
+ * @param transcript Transcript.
+ */
+void write_transcript(std::ostream& out, const session_transcript& transcript)
+{
+    const flow_key& flow = transcript.flow;
+    char times[64];
+
+    std::snprintf(times, sizeof(times), "%.6f %.6f", transcript.start, transcript.end);
+
+    out << "# " << str_address(flow.family, flow.source) << ":" << flow.source_port << " -> "
+        << str_address(flow.family, flow.destination) << ":" << flow.destination_port << " "
+        << (transcript.protocol == SESSION_TELNET ? "TELNET" : "IRC") << " " << times;
+
+    if (transcript.closed) {
+        out << " closed";
+    }
+
+    if (transcript.truncated) {
+        out << " truncated";
+    }
+
+    if (transcript.gaps) {
+        out << " gaps=" << transcript.gaps;
+    }
+
+    out << "\n";
+
+    for (unsigned int i = 0; i < transcript.lines.size(); ++i) {
+        const session_line& line = transcript.lines[i];
+
+        std::snprintf(times, sizeof(times), "%.6f", line.timestamp);
+        out << times << (line.from_client ? " C: " : " S: ");
+        out.write(transcript.chunks[line.chunk].data() + line.offset, line.length);
+        out << "\n";
+    }
+}
+}
\ No newline at end of file
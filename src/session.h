@@ -0,0 +1,140 @@
+/**
+ * @file session.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Per-connection transcripts of line protocols (IRC, Telnet).
+ * @version 0.1
+ * @date 2019-06-14
+ *
+ * @copyright Copyright (c) 2019
+ */
+
+#ifndef DISSPCAP_SESSION_H
+#define DISSPCAP_SESSION_H
+
+#include <fstream>
+#include <list>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow.h"
+#include "packet.h"
+#include "telnet.h"
+
+namespace disspcap {
+
+const unsigned int SESSION_CHUNK_SIZE = 4096;      /**< Transcript storage chunk, longer lines are split. */
+const uint64_t SESSION_MAX_BYTES       = 1 << 20;   /**< Default transcript cap of one session. */
+const uint64_t SESSION_MAX_TOTAL_BYTES = 256 << 20; /**< Default cap of all open sessions. */
+const uint64_t SESSION_MAX_KEPT_BYTES  = 256 << 20; /**< Default cap of finished transcripts kept. */
+const double SESSION_TIMEOUT           = 600;       /**< Default idle timeout (seconds). */
+
+const uint8_t SESSION_IRC    = 0; /**< IRC session. */
+const uint8_t SESSION_TELNET = 1; /**< Telnet session (commands are left out). */
+
+/**
+ * @brief Line of transcript, text is stored in transcript chunks.
+ */
+struct session_line {
+    double timestamp; /**< Time of segment which completed line. */
+    bool from_client;
+    uint32_t chunk;
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * @brief Transcript of one connection.
+ */
+struct session_transcript {
+    flow_key flow; /**< Client -> server. */
+    uint8_t protocol;
+    double start;
+    double end;
+    bool closed;    /**< Ended by FIN/RST (not by timeout or eviction). */
+    bool truncated; /**< Memory cap was hit, later lines are missing. */
+    uint64_t gaps;  /**< Number of lost segments. */
+    std::vector<std::string> chunks;
+    std::vector<session_line> lines;
+    std::string text(unsigned int index) const;
+};
+
+/**
+ * @brief State of one direction of session.
+ */
+struct session_direction {
+    TelnetParser telnet;
+    uint32_t next_seq;   /**< Sequence number of next expected byte. */
+    bool synchronized;
+    bool finished;       /**< FIN was seen. */
+    std::string partial; /**< Unfinished line (capacity is accounted in session memory). */
+};
+
+/**
+ * @brief Open session.
+ */
+struct session_state {
+    session_transcript transcript;
+    session_direction directions[2]; /**< Client, server. */
+    uint64_t memory;                 /**< Accounted bytes (state, unfinished lines, lines and chunks). */
+    double last_seen;
+    std::list<flow_key>::iterator position; /**< Entry in activity order. */
+};
+
+/**
+ * @brief Builds transcripts of IRC and Telnet connections.
+ *
+ * Segments are added in sequence order (retransmissions are skipped) and
+ * framed into lines incrementally, only new data are scanned. Text is kept
+ * in fixed size chunks. Session stops growing at max_session_bytes, when
+ * all sessions exceed max_total_bytes the least recently active one is
+ * finished early. Finished transcripts are kept (transcripts()) up to
+ * max_kept_bytes, later ones are dropped until clear_transcripts(), or
+ * written to output file.
+ */
+class SessionBuilder {
+public:
+    SessionBuilder(uint64_t max_session_bytes = SESSION_MAX_BYTES,
+                   uint64_t max_total_bytes   = SESSION_MAX_TOTAL_BYTES,
+                   double timeout             = SESSION_TIMEOUT,
+                   uint64_t max_kept_bytes    = SESSION_MAX_KEPT_BYTES);
+    bool process(const Packet& packet);
+    void expire(double now);
+    void flush();
+    void set_output(const std::string& path);
+    const std::vector<session_transcript>& transcripts() const;
+    void clear_transcripts();
+    unsigned int session_count() const;
+    uint64_t memory() const;
+    uint64_t evicted_sessions() const;
+    uint64_t kept_memory() const;
+    uint64_t dropped_transcripts() const;
+
+private:
+    std::unordered_map<flow_key, session_state, flow_key_hash> sessions_;
+    std::list<flow_key> activity_; /**< Open sessions, least recently active first. */
+    std::vector<session_transcript> transcripts_;
+    std::ofstream output_;
+    std::string text_; /**< Decoded segment, reused between packets. */
+    std::vector<telnet_command> commands_;
+    uint64_t max_session_bytes_;
+    uint64_t max_total_bytes_;
+    double timeout_;
+    uint64_t max_kept_bytes_;
+    uint64_t memory_;
+    uint64_t kept_memory_;
+    uint64_t evicted_sessions_;
+    uint64_t dropped_transcripts_;
+    void append(session_state& session, bool from_client, double timestamp);
+    void add_line(session_state& session, bool from_client, const char* data, unsigned int length, double timestamp);
+    void finish(session_state& session);
+    void erase(std::unordered_map<flow_key, session_state, flow_key_hash>::iterator it);
+    void evict();
+};
+
+void write_transcript(std::ostream& out, const session_transcript& transcript);
+}
+
+#endif
\ No newline at end of file
@@ -223,6 +223,16 @@ uint8_t* TCP::payload()
     return this->payload_;
 }
 
+/**
+ * @brief Getter of payload.
+ * 
+ * @return const uint8_t* Pointer to first byte of payload.
+ */
+const uint8_t* TCP::payload() const
+{
+    return this->payload_;
+}
+
 /**
  * @brief Getter of payload length value.
  * 
@@ -59,6 +59,7 @@ public:
     bool syn() const;
     bool fin() const;
     uint8_t* payload();
+    const uint8_t* payload() const;
     unsigned int payload_length() const;
 
 private:
@@ -6,13 +6,171 @@
  * @date 2019-04-11
  * 
  * @copyright Copyright (c) 2019
+ * 
+ * Based on:
+ * https://tools.ietf.org/html/rfc854
+ * https://tools.ietf.org/html/rfc855
  */
 
 #include "telnet.h"
 #include "common.h"
+#include "scan.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace disspcap {
 
+/**
+ * @brief Construct a new TelnetParser::TelnetParser object.
+ */
+TelnetParser::TelnetParser()
+    : state_{ TELNET_STATE_DATA }
+{
+}
+
+/**
+ * @brief Parses next part of Telnet stream.
+ * 
+ * Data runs are escaped in bulk (printables and whitespace are kept,
+ * IAC IAC is data byte 0xff), completed commands are appended.
+ * 
+ * @param data Stream data.
+ * @param length Data length.
+ * @param text Data are appended to it.
+ * @param commands Completed commands are appended to it.
+ */
+void TelnetParser::feed(const uint8_t* data,
+                        unsigned int length,
+                        std::string& text,
+                        std::vector<telnet_command>& commands)
+{
+    const uint8_t* p   = data;
+    const uint8_t* end = data + length;
+
+    while (p < end) {
+        switch (this->state_) {
+        case TELNET_STATE_DATA: {
+            const uint8_t* stop = find_either(p, end, TELNET_IAC, '\r');
+
+            append_escaped(text, p, stop - p, true);
+
+            if (stop == end) {
+                return;
+            }
+
+            if (*stop == '\r') {
+                text += '\r';
+                this->state_ = TELNET_STATE_CR;
+            } else {
+                this->state_ = TELNET_STATE_IAC;
+            }
+
+            p = stop + 1;
+            break;
+        }
+        case TELNET_STATE_CR:
+            /* CR NUL is bare CR */
+            if (*p == '\0') {
+                ++p;
+            }
+
+            this->state_ = TELNET_STATE_DATA;
+            break;
+        case TELNET_STATE_IAC: {
+            uint8_t command = *p++;
+
+            if (command == TELNET_IAC) {
+                /* escaped data byte */
+                append_escaped(text, &command, 1, true);
+                this->state_ = TELNET_STATE_DATA;
+            } else if (command >= TELNET_WILL) {
+                this->pending_.command = command;
+                this->state_           = TELNET_STATE_OPTION;
+            } else if (command == TELNET_SB) {
+                this->state_ = TELNET_STATE_SB;
+            } else {
+                commands.push_back(telnet_command{ command, 0, std::string() });
+                this->state_ = TELNET_STATE_DATA;
+            }
+
+            break;
+        }
+        case TELNET_STATE_OPTION:
+            commands.push_back(telnet_command{ this->pending_.command, *p++, std::string() });
+            this->state_ = TELNET_STATE_DATA;
+            break;
+        case TELNET_STATE_SB:
+            this->pending_.command = TELNET_SB;
+            this->pending_.option  = *p++;
+            this->pending_.parameters.clear();
+            this->state_ = TELNET_STATE_SB_DATA;
+            break;
+        case TELNET_STATE_SB_DATA: {
+            const uint8_t* stop = static_cast<const uint8_t*>(std::memchr(p, TELNET_IAC, end - p));
+
+            if (!stop) {
+                stop = end;
+            }
+
+            unsigned int room = TELNET_MAX_PARAMETERS - this->pending_.parameters.size();
+            this->pending_.parameters.append(reinterpret_cast<const char*>(p),
+                                             std::min<unsigned int>(stop - p, room));
+
+            if (stop == end) {
+                return;
+            }
+
+            this->state_ = TELNET_STATE_SB_IAC;
+            p            = stop + 1;
+            break;
+        }
+        case TELNET_STATE_SB_IAC:
+            if (*p == TELNET_IAC) {
+                if (this->pending_.parameters.size() < TELNET_MAX_PARAMETERS) {
+                    this->pending_.parameters += static_cast<char>(TELNET_IAC);
+                }
+
+                this->state_ = TELNET_STATE_SB_DATA;
+                ++p;
+            } else {
+                commands.push_back(this->pending_);
+
+                if (*p == TELNET_SE) {
+                    this->state_ = TELNET_STATE_DATA;
+                    ++p;
+                } else {
+                    /* missing SE - byte is next command */
+                    this->state_ = TELNET_STATE_IAC;
+                }
+            }
+
+            break;
+        default:
+            this->state_ = TELNET_STATE_DATA;
+        }
+    }
+}
+
+/**
+ * @brief Forgets partial sequence (e.g. after lost segment).
+ */
+void TelnetParser::reset()
+{
+    this->state_ = TELNET_STATE_DATA;
+    this->pending_.parameters.clear();
+}
+
+/**
+ * @brief Getter of parser state.
+ * 
+ * @return uint8_t TELNET_STATE_* value.
+ */
+uint8_t TelnetParser::state() const
+{
+    return this->state_;
+}
+
 /**
  * @brief Construct a new Telnet:: Telnet object and runs parser.
  * 
@@ -29,14 +187,35 @@ Telnet::Telnet(uint8_t* data, int data_length)
     if (!data || data_length < 1)
         return;
 
-    this->parse();
+    TelnetParser parser;
+    this->parse(parser);
+}
+
+/**
+ * @brief Construct a new Telnet:: Telnet object and continues stream of parser.
+ * 
+ * @param data Packets data (next part of Telnet stream).
+ * @param data_length Data length.
+ * @param parser Parser of stream direction.
+ */
+Telnet::Telnet(uint8_t* data, int data_length, TelnetParser& parser)
+    : is_command_{ false }
+    , data_{ "" }
+    , ptr_{ data }
+    , base_ptr_{ data }
+    , end_ptr_{ data + data_length }
+{
+    if (!data || data_length < 1)
+        return;
+
+    this->parse(parser);
 }
 
 /**
  * @brief Is Telnet packet command.
  * 
- * @return true Command
- * @return false Data.
+ * @return true Packet contains command (or its part).
+ * @return false Data only.
  */
 bool Telnet::is_command() const
 {
@@ -46,17 +225,23 @@ bool Telnet::is_command() const
 /**
  * @brief Is Telnet packet data.
  * 
- * @return true Data.
- * @return false Command.
+ * @return true Packet contains data (or no command).
+ * @return false Command only.
  */
 bool Telnet::is_data() const
 {
-    return !this->is_command_;
+    return !this->is_command_ || !this->data_.empty();
 }
 
+/**
+ * @brief Telnet packet has no data.
+ * 
+ * @return true No data.
+ * @return false Otherwise.
+ */
 bool Telnet::is_empty() const
 {
-    return this->data_ == "";
+    return this->data_.empty();
 }
 
 /**
@@ -70,36 +255,25 @@ const std::string& Telnet::data() const
 }
 
 /**
- * @brief Main parse Telnet method.
+ * @brief Telnet commands getter.
+ * 
+ * @return const std::vector<telnet_command>& Commands completed in this packet.
  */
-void Telnet::parse()
+const std::vector<telnet_command>& Telnet::commands() const
 {
-    /* is command? (commands starts w/ 0xff - IAC) */
-    if (*(this->ptr_) == 255) {
-        this->is_command_ = true;
-
-        /* not yet implemented parsing commands */
-        return;
-    }
-
-    /* is data */
-    this->is_command_ = false;
-    this->parse_data();
+    return this->commands_;
 }
 
 /**
- * @brief Parses raw Telnet data.
+ * @brief Main parse Telnet method.
+ * 
+ * @param parser Parser (state of stream).
  */
-void Telnet::parse_data()
+void Telnet::parse(TelnetParser& parser)
 {
-    for (uint8_t* p = this->ptr_; p < this->end_ptr_; ++p) {
-        unsigned char repr = static_cast<unsigned char>(*p);
+    parser.feed(this->ptr_, this->end_ptr_ - this->ptr_, this->data_, this->commands_);
 
-        if (isprint(repr) or isspace(repr)) {
-            this->data_ += *p;
-        } else {
-            this->data_ += string_hexa(repr);
-        }
-    }
+    /* unfinished sequence at the end is command too */
+    this->is_command_ = !this->commands_.empty() || parser.state() >= TELNET_STATE_IAC;
 }
 }
\ No newline at end of file
@@ -6,6 +6,10 @@
  * @date 2019-04-11
  * 
  * @copyright Copyright (c) 2019
+ * 
+ * Based on:
+ * https://tools.ietf.org/html/rfc854
+ * https://tools.ietf.org/html/rfc855
  */
 
 #ifndef DISSPCAP_TELNET_H
@@ -14,6 +18,7 @@
 #include <map>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace disspcap {
 
@@ -39,25 +44,75 @@ const std::map<int, std::string> TELNET_COMMANDS = {
     { 255, "IAC" }
 };
 
+const uint8_t TELNET_SE   = 240; /**< End of subnegotiation. */
+const uint8_t TELNET_SB   = 250; /**< Start of subnegotiation. */
+const uint8_t TELNET_WILL = 251;
+const uint8_t TELNET_WONT = 252;
+const uint8_t TELNET_DO   = 253;
+const uint8_t TELNET_DONT = 254;
+const uint8_t TELNET_IAC  = 255; /**< Interpret as command. */
+
+const uint8_t TELNET_STATE_DATA    = 0; /**< Data. */
+const uint8_t TELNET_STATE_CR      = 1; /**< Data after CR (NUL is dropped). */
+const uint8_t TELNET_STATE_IAC     = 2; /**< After IAC. */
+const uint8_t TELNET_STATE_OPTION  = 3; /**< After WILL, WONT, DO or DONT. */
+const uint8_t TELNET_STATE_SB      = 4; /**< After IAC SB. */
+const uint8_t TELNET_STATE_SB_DATA = 5; /**< Subnegotiation parameters. */
+const uint8_t TELNET_STATE_SB_IAC  = 6; /**< IAC in subnegotiation parameters. */
+
+const unsigned int TELNET_MAX_PARAMETERS = 1024; /**< Longer subnegotiation parameters are truncated. */
+
+/**
+ * @brief Telnet command (e.g. IAC DO ECHO).
+ */
+struct telnet_command {
+    uint8_t command;        /**< Command code (e.g. 253 - DO). */
+    uint8_t option;         /**< Option of WILL, WONT, DO, DONT and SB, 0 otherwise. */
+    std::string parameters; /**< Subnegotiation parameters (SB only, IAC IAC unescaped). */
+};
+
+/**
+ * @brief Streaming Telnet parser.
+ *
+ * Splits stream into data and commands, state is kept between calls,
+ * so sequences may be split across segments.
+ */
+class TelnetParser {
+public:
+    TelnetParser();
+    void feed(const uint8_t* data,
+              unsigned int length,
+              std::string& text,
+              std::vector<telnet_command>& commands);
+    void reset();
+    uint8_t state() const;
+
+private:
+    uint8_t state_;
+    telnet_command pending_;
+};
+
 /**
  * @brief Telnet message class.
  */
 class Telnet {
 public:
     Telnet(uint8_t* data, int data_length);
+    Telnet(uint8_t* data, int data_length, TelnetParser& parser);
     bool is_command() const;
     bool is_data() const;
     bool is_empty() const;
     const std::string& data() const;
+    const std::vector<telnet_command>& commands() const;
 
 private:
     bool is_command_;
     std::string data_;
+    std::vector<telnet_command> commands_;
     uint8_t* ptr_;
     uint8_t* base_ptr_;
     uint8_t* end_ptr_;
-    void parse();
-    void parse_data();
+    void parse(TelnetParser& parser);
 };
 }
 
@@ -0,0 +1,175 @@
+/**
+ * @file telnet_tracker.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Telnet stream parsing across TCP segments.
+ * @version 0.1
+ * @date 2019-06-12
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ * Based on:
+ * https://tools.ietf.org/html/rfc854
+ */
+
+#include "telnet_tracker.h"
+
+#include <algorithm>
+
+namespace disspcap {
+
+/**
+ * @brief Construct a new TelnetTracker object.
+ * 
+ * @param max_streams Maximum number of tracked directions.
+ * @param timeout Idle time (seconds) after which stream is forgotten.
+ */
+TelnetTracker::TelnetTracker(unsigned int max_streams, double timeout)
+    : max_streams_{ max_streams }
+    , timeout_{ timeout }
+    , last_expire_{ 0 }
+    , gaps_{ 0 }
+    , dropped_streams_{ 0 }
+{
+}
+
+/**
+ * @brief Processes packet - continues stream of its direction.
+ * 
+ * Results are available by data() and commands() until next call.
+ * 
+ * @param packet Dissected packet.
+ * @return true Packet is Telnet segment of tracked stream.
+ * @return false Otherwise.
+ */
+bool TelnetTracker::process(const Packet& packet)
+{
+    const TCP* tcp = packet.tcp();
+    flow_key key;
+
+    this->data_.clear();
+    this->commands_.clear();
+
+    if (!packet.telnet() || !tcp || !make_flow_key(packet, key)) {
+        return false;
+    }
+
+    double now = packet.timestamp();
+
+    if (now - this->last_expire_ > this->timeout_) {
+        this->expire(now);
+        this->last_expire_ = now;
+    }
+
+    const uint8_t* payload = tcp->payload();
+    unsigned int length    = tcp->payload_length();
+    uint32_t seq           = tcp->seq_number() + tcp->syn();
+    auto it                = this->streams_.find(key);
+
+    if (it == this->streams_.end()) {
+        if (this->streams_.size() >= this->max_streams_) {
+            ++this->dropped_streams_;
+            return false;
+        }
+
+        it                  = this->streams_.insert(std::make_pair(key, telnet_stream())).first;
+        it->second.next_seq = seq;
+    } else {
+        telnet_stream& stream = it->second;
+        int32_t offset        = stream.next_seq - seq;
+
+        if (offset > 0) {
+            /* retransmission - skip already parsed bytes */
+            unsigned int skip = std::min<unsigned int>(offset, length);
+            payload += skip;
+            length -= skip;
+            seq += skip;
+        } else if (offset < 0) {
+            /* lost segment */
+            ++this->gaps_;
+            stream.parser.reset();
+        }
+    }
+
+    telnet_stream& stream = it->second;
+    stream.last_seen      = now;
+
+    /* stale segments (e.g. delayed ACKs) do not move stream back */
+    if (static_cast<int32_t>(seq + length - stream.next_seq) > 0) {
+        stream.next_seq = seq + length;
+    }
+
+    stream.parser.feed(payload, length, this->data_, this->commands_);
+
+    if (tcp->rst() || tcp->fin()) {
+        this->streams_.erase(it);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Forgets streams idle for longer than timeout.
+ * 
+ * @param now Current time (seconds since epoch).
+ */
+void TelnetTracker::expire(double now)
+{
+    for (auto it = this->streams_.begin(); it != this->streams_.end();) {
+        if (now - it->second.last_seen > this->timeout_) {
+            it = this->streams_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Getter of data of last processed packet.
+ * 
+ * @return const std::string& Data (escaped as Telnet::data()).
+ */
+const std::string& TelnetTracker::data() const
+{
+    return this->data_;
+}
+
+/**
+ * @brief Getter of commands completed by last processed packet.
+ * 
+ * @return const std::vector<telnet_command>& Commands.
+ */
+const std::vector<telnet_command>& TelnetTracker::commands() const
+{
+    return this->commands_;
+}
+
+/**
+ * @brief Getter of number of tracked directions.
+ * 
+ * @return unsigned int Number of streams.
+ */
+unsigned int TelnetTracker::stream_count() const
+{
+    return this->streams_.size();
+}
+
+/**
+ * @brief Getter of number of lost segments.
+ * 
+ * @return uint64_t Number of gaps.
+ */
+uint64_t TelnetTracker::gaps() const
+{
+    return this->gaps_;
+}
+
+/**
+ * @brief Getter of number of streams not tracked because table was full.
+ * 
+ * @return uint64_t Number of dropped streams.
+ */
+uint64_t TelnetTracker::dropped_streams() const
+{
+    return this->dropped_streams_;
+}
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @file telnet_tracker.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Telnet stream parsing across TCP segments.
+ * @version 0.1
+ * @date 2019-06-12
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ * Based on:
+ * https://tools.ietf.org/html/rfc854
+ */
+
+#ifndef DISSPCAP_TELNET_TRACKER_H
+#define DISSPCAP_TELNET_TRACKER_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flow.h"
+#include "packet.h"
+#include "telnet.h"
+
+namespace disspcap {
+
+const unsigned int TELNET_TRACKER_MAX_STREAMS = 65536; /**< Default stream table size. */
+const double TELNET_TRACKER_TIMEOUT           = 600;   /**< Default idle timeout (seconds). */
+
+/**
+ * @brief State of one direction of Telnet connection.
+ */
+struct telnet_stream {
+    TelnetParser parser;
+    uint32_t next_seq; /**< Sequence number of next expected byte. */
+    double last_seen;
+};
+
+/**
+ * @brief Parses Telnet connections as streams.
+ *
+ * Every direction has its own parser, so commands split across segments
+ * are recognized. Retransmitted bytes are skipped, after lost segment
+ * parser starts over in data state.
+ */
+class TelnetTracker {
+public:
+    TelnetTracker(unsigned int max_streams = TELNET_TRACKER_MAX_STREAMS, double timeout = TELNET_TRACKER_TIMEOUT);
+    bool process(const Packet& packet);
+    void expire(double now);
+    const std::string& data() const;
+    const std::vector<telnet_command>& commands() const;
+    unsigned int stream_count() const;
+    uint64_t gaps() const;
+    uint64_t dropped_streams() const;
+
+private:
+    std::unordered_map<flow_key, telnet_stream, flow_key_hash> streams_;
+    std::string data_;
+    std::vector<telnet_command> commands_;
+    unsigned int max_streams_;
+    double timeout_;
+    double last_expire_;
+    uint64_t gaps_;
+    uint64_t dropped_streams_;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,424 @@
+/**
+ * @file topk.cc
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Streaming heavy hitters (top-K).
+ * @version 0.1
+ * @date 2019-05-27
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * Metwally et al., Efficient Computation of Frequent and Top-k Elements in Data Streams
+ * Agarwal et al., Mergeable Summaries
+ */
+
+#include "topk.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common.h"
+
+namespace disspcap {
+
+/**
+ * @brief Orders entries by count (descending), ties by key.
+ *
+ * @param a First entry.
+ * @param b Second entry.
+ * @return true First entry goes first.
+ * @return false Otherwise.
+ */
+static bool entry_greater(const topk_entry& a, const topk_entry& b)
+{
+    return a.count != b.count ? a.count > b.count : a.key < b.key;
+}
+
+/**
+ * @brief Construct a new TopK::TopK object.
+ *
+ * @param capacity Number of monitored keys (memory is linear in it).
+ */
+TopK::TopK(unsigned int capacity)
+    : capacity_{ capacity ? capacity : 1 }
+    , total_{ 0 }
+{
+    unsigned int table_size = 1;
+
+    /* load factor at most 1/2 */
+    while (table_size < 2 * this->capacity_) {
+        table_size <<= 1;
+    }
+
+    this->table_.assign(table_size, 0);
+    this->mask_ = table_size - 1;
+}
+
+/**
+ * @brief Counts key.
+ *
+ * @param key Binary key.
+ * @param length Key length.
+ * @param weight Number of occurrences (e.g. 1 or bytes).
+ */
+void TopK::add(const void* key, unsigned int length, uint64_t weight)
+{
+    uint64_t hash = hash_bytes(key, length);
+    int found     = this->find(key, length, hash);
+
+    this->total_ += weight;
+
+    if (found >= 0) {
+        this->counters_[found].count += weight;
+        this->sift_down(this->counters_[found].heap);
+        return;
+    }
+
+    if (this->counters_.size() < this->capacity_) {
+        counter entry;
+        unsigned int index = this->counters_.size();
+
+        entry.key.assign(static_cast<const char*>(key), length);
+        entry.hash  = hash;
+        entry.count = weight;
+        entry.error = 0;
+        entry.heap  = this->heap_.size();
+
+        this->counters_.push_back(std::move(entry));
+        this->heap_.push_back(index);
+        this->table_insert(index);
+        this->sift_up(this->heap_.size() - 1);
+        return;
+    }
+
+    /* replace least frequent key, its count bounds overestimation */
+    unsigned int index = this->heap_[0];
+    counter& entry     = this->counters_[index];
+
+    this->table_erase(index);
+
+    entry.key.assign(static_cast<const char*>(key), length);
+    entry.hash  = hash;
+    entry.error = entry.count;
+    entry.count += weight;
+
+    this->table_insert(index);
+    this->sift_down(0);
+}
+
+/**
+ * @brief Counts key.
+ *
+ * @param key Binary key.
+ * @param weight Number of occurrences.
+ */
+void TopK::add(const std::string& key, uint64_t weight)
+{
+    this->add(key.data(), key.size(), weight);
+}
+
+/**
+ * @brief Merges other summary (e.g. of another thread) into this one.
+ *
+ * Key missing in full summary may have occurred up to its minimal
+ * count times, so that count is added to both count and error.
+ *
+ * @param other Other summary.
+ */
+void TopK::merge(const TopK& other)
+{
+    uint64_t own_min   = this->error_bound();
+    uint64_t other_min = other.error_bound();
+
+    std::vector<topk_entry> entries;
+    entries.reserve(this->counters_.size() + other.counters_.size());
+
+    for (const counter& entry : this->counters_) {
+        int found = other.find(entry.key.data(), entry.key.size(), entry.hash);
+
+        if (found >= 0) {
+            const counter& match = other.counters_[found];
+            entries.push_back(topk_entry{ entry.key, entry.count + match.count, entry.error + match.error });
+        } else {
+            entries.push_back(topk_entry{ entry.key, entry.count + other_min, entry.error + other_min });
+        }
+    }
+
+    for (const counter& entry : other.counters_) {
+        if (this->find(entry.key.data(), entry.key.size(), entry.hash) < 0) {
+            entries.push_back(topk_entry{ entry.key, entry.count + own_min, entry.error + own_min });
+        }
+    }
+
+    this->total_ += other.total_;
+    this->rebuild(entries);
+}
+
+/**
+ * @brief Drops all counters.
+ */
+void TopK::clear()
+{
+    this->counters_.clear();
+    this->heap_.clear();
+    std::fill(this->table_.begin(), this->table_.end(), 0);
+    this->total_ = 0;
+}
+
+/**
+ * @brief Returns most frequent keys.
+ *
+ * @param k Number of keys.
+ * @return std::vector<topk_entry> At most k entries, most frequent first.
+ */
+std::vector<topk_entry> TopK::top(unsigned int k) const
+{
+    std::vector<topk_entry> entries;
+    entries.reserve(this->counters_.size());
+
+    for (const counter& entry : this->counters_) {
+        entries.push_back(topk_entry{ entry.key, entry.count, entry.error });
+    }
+
+    k = std::min<unsigned int>(k, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + k, entries.end(), entry_greater);
+    entries.resize(k);
+
+    return entries;
+}
+
+/**
+ * @brief Returns upper bound of key count.
+ *
+ * @param key Binary key.
+ * @param length Key length.
+ * @return uint64_t Count of monitored key, error_bound() otherwise.
+ */
+uint64_t TopK::estimate(const void* key, unsigned int length) const
+{
+    int found = this->find(key, length, hash_bytes(key, length));
+
+    return found >= 0 ? this->counters_[found].count : this->error_bound();
+}
+
+/**
+ * @brief Returns upper bound of key count.
+ *
+ * @param key Binary key.
+ * @return uint64_t Count of monitored key, error_bound() otherwise.
+ */
+uint64_t TopK::estimate(const std::string& key) const
+{
+    return this->estimate(key.data(), key.size());
+}
+
+/**
+ * @brief Getter of maximal count of key which is not monitored.
+ *
+ * Never exceeds total() / capacity().
+ *
+ * @return uint64_t Minimal monitored count when full, 0 otherwise.
+ */
+uint64_t TopK::error_bound() const
+{
+    if (this->counters_.size() < this->capacity_) {
+        return 0;
+    }
+
+    return this->counters_[this->heap_[0]].count;
+}
+
+/**
+ * @brief Getter of sum of all added weights.
+ *
+ * @return uint64_t Total count.
+ */
+uint64_t TopK::total() const
+{
+    return this->total_;
+}
+
+/**
+ * @brief Getter of number of monitored keys.
+ *
+ * @return unsigned int Number of keys.
+ */
+unsigned int TopK::size() const
+{
+    return this->counters_.size();
+}
+
+/**
+ * @brief Getter of maximal number of monitored keys.
+ *
+ * @return unsigned int Capacity.
+ */
+unsigned int TopK::capacity() const
+{
+    return this->capacity_;
+}
+
+/**
+ * @brief Looks up counter of key.
+ *
+ * @param key Binary key.
+ * @param length Key length.
+ * @param hash hash_bytes() of key.
+ * @return int Counter index, -1 if key is not monitored.
+ */
+int TopK::find(const void* key, unsigned int length, uint64_t hash) const
+{
+    unsigned int position = hash & this->mask_;
+
+    while (this->table_[position]) {
+        const counter& entry = this->counters_[this->table_[position] - 1];
+
+        if (entry.hash == hash && entry.key.size() == length && std::memcmp(entry.key.data(), key, length) == 0) {
+            return this->table_[position] - 1;
+        }
+
+        position = (position + 1) & this->mask_;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Inserts counter into lookup table (linear probing).
+ *
+ * @param index Counter index.
+ */
+void TopK::table_insert(unsigned int index)
+{
+    unsigned int position = this->counters_[index].hash & this->mask_;
+
+    while (this->table_[position]) {
+        position = (position + 1) & this->mask_;
+    }
+
+    this->table_[position] = index + 1;
+}
+
+/**
+ * @brief Removes counter from lookup table.
+ *
+ * Following entries are shifted back, so no tombstones are needed.
+ *
+ * @param index Counter index.
+ */
+void TopK::table_erase(unsigned int index)
+{
+    unsigned int position = this->counters_[index].hash & this->mask_;
+
+    while (this->table_[position] != index + 1) {
+        position = (position + 1) & this->mask_;
+    }
+
+    this->table_[position] = 0;
+
+    for (unsigned int next = (position + 1) & this->mask_; this->table_[next]; next = (next + 1) & this->mask_) {
+        unsigned int ideal = this->counters_[this->table_[next] - 1].hash & this->mask_;
+
+        /* entry may move to hole only if hole lies on its probe path */
+        if (((next - ideal) & this->mask_) >= ((next - position) & this->mask_)) {
+            this->table_[position] = this->table_[next];
+            this->table_[next]     = 0;
+            position               = next;
+        }
+    }
+}
+
+/**
+ * @brief Restores heap order after count of element increased.
+ *
+ * @param position Heap position.
+ */
+void TopK::sift_down(unsigned int position)
+{
+    unsigned int size = this->heap_.size();
+
+    while (true) {
+        unsigned int smallest = position;
+        unsigned int left     = 2 * position + 1;
+        unsigned int right    = left + 1;
+
+        if (left < size && this->counters_[this->heap_[left]].count < this->counters_[this->heap_[smallest]].count) {
+            smallest = left;
+        }
+
+        if (right < size && this->counters_[this->heap_[right]].count < this->counters_[this->heap_[smallest]].count) {
+            smallest = right;
+        }
+
+        if (smallest == position) {
+            return;
+        }
+
+        this->swap(position, smallest);
+        position = smallest;
+    }
+}
+
+/**
+ * @brief Restores heap order after element was appended.
+ *
+ * @param position Heap position.
+ */
+void TopK::sift_up(unsigned int position)
+{
+    while (position) {
+        unsigned int parent = (position - 1) / 2;
+
+        if (this->counters_[this->heap_[parent]].count <= this->counters_[this->heap_[position]].count) {
+            return;
+        }
+
+        this->swap(position, parent);
+        position = parent;
+    }
+}
+
+/**
+ * @brief Swaps two heap elements.
+ *
+ * @param a First position.
+ * @param b Second position.
+ */
+void TopK::swap(unsigned int a, unsigned int b)
+{
+    std::swap(this->heap_[a], this->heap_[b]);
+    this->counters_[this->heap_[a]].heap = a;
+    this->counters_[this->heap_[b]].heap = b;
+}
+
+/**
+ * @brief Replaces counters with most frequent of given entries.
+ *
+ * @param entries Entries (reordered).
+ */
+void TopK::rebuild(std::vector<topk_entry>& entries)
+{
+    unsigned int kept = std::min<unsigned int>(entries.size(), this->capacity_);
+    std::partial_sort(entries.begin(), entries.begin() + kept, entries.end(), entry_greater);
+
+    this->counters_.clear();
+    this->heap_.clear();
+    std::fill(this->table_.begin(), this->table_.end(), 0);
+
+    /* descending counts - reversed order is valid min-heap */
+    for (unsigned int i = 0; i < kept; ++i) {
+        const topk_entry& source = entries[kept - 1 - i];
+        counter entry;
+
+        entry.key   = source.key;
+        entry.hash  = hash_bytes(source.key.data(), source.key.size());
+        entry.count = source.count;
+        entry.error = source.error;
+        entry.heap  = i;
+
+        this->counters_.push_back(std::move(entry));
+        this->heap_.push_back(i);
+        this->table_insert(i);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+/**
+ * @file topk.h
+ * @author Daniel Uhricek (daniel.uhricek@gypri.cz)
+ * @brief Streaming heavy hitters (top-K).
+ * @version 0.1
+ * @date 2019-05-27
+ *
+ * @copyright Copyright (c) 2019
+ *
+ * Based on:
+ * Metwally et al., Efficient Computation of Frequent and Top-k Elements in Data Streams
+ * Agarwal et al., Mergeable Summaries
+ */
+
+#ifndef DISSPCAP_TOPK_H
+#define DISSPCAP_TOPK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace disspcap {
+
+const unsigned int TOPK_CAPACITY = 1024; /**< Default number of monitored keys. */
+
+/**
+ * @brief Monitored key with its estimated count.
+ *
+ * True count lies in [count - error, count].
+ */
+struct topk_entry {
+    std::string key; /**< Binary key (address, port, 5-tuple, name, ...). */
+    uint64_t count;
+    uint64_t error;
+};
+
+/**
+ * @brief Space-Saving summary of most frequent binary keys.
+ *
+ * Memory is fixed by capacity - when all counters are used, the least
+ * frequent key is replaced by the new one, which inherits its count as
+ * error. Any key with true count above total() / capacity() is monitored.
+ * Counters are kept in indexed min-heap and located by open addressing
+ * table over hash_bytes(), so lookup does not allocate.
+ * Not thread-safe, use one instance per thread and merge() them.
+ */
+class TopK {
+public:
+    TopK(unsigned int capacity = TOPK_CAPACITY);
+    void add(const void* key, unsigned int length, uint64_t weight = 1);
+    void add(const std::string& key, uint64_t weight = 1);
+    void merge(const TopK& other);
+    void clear();
+    std::vector<topk_entry> top(unsigned int k) const;
+    uint64_t estimate(const void* key, unsigned int length) const;
+    uint64_t estimate(const std::string& key) const;
+    uint64_t error_bound() const;
+    uint64_t total() const;
+    unsigned int size() const;
+    unsigned int capacity() const;
+
+private:
+    /**
+     * @brief Monitored key.
+     */
+    struct counter {
+        std::string key;
+        uint64_t hash;
+        uint64_t count;
+        uint64_t error;
+        unsigned int heap; /**< Position in heap_. */
+    };
+
+    unsigned int capacity_;
+    uint64_t total_;
+    std::vector<counter> counters_;
+    std::vector<unsigned int> heap_;  /**< Counter indices, min-heap by count. */
+    std::vector<unsigned int> table_; /**< Counter index + 1, 0 if empty. */
+    unsigned int mask_;
+    int find(const void* key, unsigned int length, uint64_t hash) const;
+    void table_insert(unsigned int index);
+    void table_erase(unsigned int index);
+    void sift_down(unsigned int position);
+    void sift_up(unsigned int position);
+    void swap(unsigned int a, unsigned int b);
+    void rebuild(std::vector<topk_entry>& entries);
+};
+}
+
+#endif
\ No newline at end of file
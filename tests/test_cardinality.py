@@ -0,0 +1,75 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+packets = []
+
+
+def setup_module():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/dns.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        packets.append(packet)
+        packet = pcap.next_packet()
+
+
+def test_small_exact():
+    hll = disspcap.HyperLogLog()
+
+    for i in range(100):
+        hll.add(i.to_bytes(4, 'big'))
+        hll.add(i.to_bytes(4, 'big'))
+
+    assert abs(hll.estimate() - 100) <= 2
+
+
+def test_error_bound():
+    hll = disspcap.HyperLogLog(12)
+
+    for i in range(50000):
+        hll.add(i.to_bytes(8, 'little'))
+
+    assert abs(hll.estimate() - 50000) < 50000 * 4 * hll.relative_error
+
+
+def test_merge():
+    first = disspcap.HyperLogLog(10)
+    second = disspcap.HyperLogLog(10)
+
+    for i in range(1000):
+        first.add(i.to_bytes(4, 'big'))
+        second.add((i + 500).to_bytes(4, 'big'))
+
+    first.merge(second)
+    assert abs(first.estimate() - 1500) < 1500 * 0.15
+
+
+def test_packet_fields():
+    sources = disspcap.HyperLogLog()
+    names = disspcap.HyperLogLog()
+    exact_names = set()
+
+    for packet in packets:
+        sources.add_packet(packet, disspcap.FIELD_SOURCE)
+
+        if names.add_packet(packet, disspcap.FIELD_DNS_NAME):
+            exact_names.add(packet.dns.questions[0].split(' ')[0])
+
+    assert sources.estimate() == 2
+    assert names.estimate() == len(exact_names)
+
+
+def test_series():
+    series = disspcap.CardinalitySeries(interval=60, max_buckets=2)
+
+    for minute in range(3):
+        for i in range(10 * (minute + 1)):
+            series.add(minute * 60 + 1, i.to_bytes(4, 'big'))
+
+    assert series.series() == [(60.0, 20), (120.0, 30)]
+    assert series.estimate(60, 180) == 30
+
+    series.add(0, b'old')
+    assert len(series.series()) == 2
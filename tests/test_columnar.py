@@ -0,0 +1,50 @@
+import os
+import pytest
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+def test_read_batch():
+    batch = disspcap.read_batch(f'{dir_path}/pcaps/dns.pcap')
+    assert len(batch) == 18
+
+    schema, array = batch.__arrow_c_array__()
+    assert type(schema).__name__ == 'PyCapsule'
+    assert type(array).__name__ == 'PyCapsule'
+
+
+def test_chunked_read():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/http.pcap')
+    batch = disspcap.PacketBatch()
+
+    assert batch.read(pcap, 10) == 10
+    assert batch.read(pcap) == 28
+    assert len(batch) == 38
+
+    batch.clear()
+    assert len(batch) == 0
+
+
+def test_arrow_columns():
+    pa = pytest.importorskip('pyarrow')
+    table = pa.record_batch(disspcap.read_batch(f'{dir_path}/pcaps/dns.pcap'))
+    table.validate(full=True)
+
+    assert table.num_rows == 18
+    assert table.column('source').to_pylist()[0] == '10.9.242.16'
+    assert table.column('destination').to_pylist()[0] == '10.9.0.12'
+    assert table.column('protocol').to_pylist()[0] == 17
+    assert table.column('destination_port').to_pylist()[0] == 53
+    assert table.column('dns_qname').to_pylist()[:3] == ['youtube.com', 'youtube.com', 'www.youtube.com']
+    assert table.column('http_host').null_count == 18
+    assert table.column('source').dictionary.to_pylist() == ['10.9.242.16', '10.9.0.12']
+
+
+def test_arrow_http():
+    pa = pytest.importorskip('pyarrow')
+    table = pa.record_batch(disspcap.read_batch(f'{dir_path}/pcaps/http.pcap'))
+
+    assert table.column('http_host').to_pylist()[0] == 'su.fit.vutbr.cz'
+    assert table.column('http_uri').to_pylist()[:3] == ['/', None, '/style.min.css']
+    assert table.column('source_port').to_pylist()[0] == 37336
@@ -0,0 +1,81 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+captures = {}
+
+
+def read(name):
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/{name}.pcap')
+    packets = []
+    packet = pcap.next_packet()
+
+    while packet:
+        packets.append(packet)
+        packet = pcap.next_packet()
+
+    return pcap.link_type, packets
+
+
+def setup_module():
+    for name in ('linux_sll2', 'linux_sll', 'raw_ip', 'loopback', 'radiotap', 'dns'):
+        captures[name] = read(name)
+
+
+def test_ethernet():
+    link_type, packets = captures['dns']
+    assert link_type == 'Ethernet'
+    assert packets[0].ethernet.type == 'IPv4'
+
+
+def test_sll2():
+    link_type, packets = captures['linux_sll2']
+    assert link_type == 'SLL2'
+    assert packets[0].ethernet is None
+    assert [(layer.type, layer.id) for layer in packets[0].layers] == [('SLL2', 3)]
+    assert packets[0].ipv4.source == '10.9.242.16'
+    assert packets[0].dns.questions[0] == 'youtube.com A'
+    assert packets[1].dns.answers[0] == 'youtube.com A 172.217.23.206'
+    assert packets[2].layers[0].id == 7
+    assert packets[2].ipv6.source == '2001:db8::35'
+    assert packets[2].udp.destination_port == 53
+    assert packets[3].ipv4 is None
+    assert packets[3].ipv6 is None
+
+
+def test_sll():
+    link_type, packets = captures['linux_sll']
+    assert link_type == 'SLL'
+    assert packets[0].layers[0].type == 'SLL'
+    assert packets[0].udp.source_port == 47783
+    assert packets[1].ipv6.destination == '2001:db8::1234'
+
+
+def test_raw_ip():
+    link_type, packets = captures['raw_ip']
+    assert link_type == 'Raw IP'
+    assert packets[0].layers == []
+    assert packets[0].ipv4.destination == '10.9.0.12'
+    assert packets[1].udp.source_port == 53
+    assert packets[2].ipv6.next_header == 'UDP'
+
+
+def test_loopback():
+    link_type, packets = captures['loopback']
+    assert link_type == 'Loopback'
+    assert packets[0].layers[0].id == 2
+    assert packets[0].ipv4.source == '10.9.242.16'
+    assert packets[1].layers[0].id == 30
+    assert packets[1].ipv6.source == '2001:db8::35'
+    assert packets[2].ipv4.source == '10.9.0.12'
+
+
+def test_radiotap():
+    link_type, packets = captures['radiotap']
+    assert link_type == 'Radiotap'
+    assert [layer.type for layer in packets[0].layers] == ['Radiotap', '802.11']
+    assert packets[0].dns.questions[0] == 'youtube.com A'
+    assert packets[1].ipv6.destination == '2001:db8::1234'
+    assert packets[2].ipv4 is None
+    assert packets[2].ipv6 is None
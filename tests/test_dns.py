@@ -55,3 +55,43 @@ def test_dns_ptr():
 def test_dns_aaaa():
     assert packets[16].dns.answers[0] == ('ehw.fit.vutbr.cz AAAA '
                                           '2001:67c:1220:8b0::93e5:b19f')
+
+
+def test_dns_records():
+    dns = packets[5].dns
+    records = dns.records
+
+    assert [r.section for r in records] == [0, 1, 3, 3, 3]
+    assert records[1].type == 6
+    assert records[1].ttl == 6
+    assert dns.name(records[1]) == 'google.com'
+    assert dns.text(records[1]) == dns.answers[0]
+
+
+def test_dns_record_rdata():
+    dns = packets[1].dns
+    answer = dns.records[1]
+
+    assert answer.type == 1
+    assert answer.rdata_length == 4
+    assert dns.rdata(answer) == bytes([172, 217, 23, 206])
+
+
+def test_dns_name_id():
+    table = disspcap.DNSNameTable()
+    question = packets[0].dns.records[0]
+    answer = packets[1].dns.records[1]
+
+    assert packets[0].dns.name_id(question, table) == 0
+    assert packets[1].dns.name_id(answer, table) == 0
+    assert packets[2].dns.name_id(packets[2].dns.records[0], table) == 1
+    assert table.lookup(1) == 'www.youtube.com'
+    assert len(table) == 2
+
+
+def test_dns_global_name_table():
+    table = disspcap.DNSNameTable.global_table()
+    dns = packets[13].dns
+    name_id = dns.name_id(dns.records[0])
+
+    assert table.lookup(name_id) == '159.177.229.147.in-addr.arpa'
@@ -0,0 +1,66 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+tracker = disspcap.DNSTracker()
+
+
+def setup_module():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/dns.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        tracker.process(packet)
+        packet = pcap.next_packet()
+
+    tracker.flush()
+
+
+def test_transactions_count():
+    assert len(tracker.transactions) == 9
+    assert tracker.pending_count == 0
+    assert tracker.unmatched_responses == 0
+
+
+def test_transactions_matching():
+    transactions = tracker.transactions
+    assert transactions[0].question == 'youtube.com A'
+    assert transactions[0].client == '10.9.242.16'
+    assert transactions[0].server == '10.9.0.12'
+    assert transactions[0].client_port == 47783
+    assert transactions[0].server_port == 53
+    assert transactions[0].answers == ['youtube.com A 172.217.23.206']
+    assert transactions[5].question == 'connectivity-check.ubuntu.com AAAA'
+    assert transactions[5].answers == []
+    assert transactions[7].question == 'ehw.fit.vutbr.cz AAAA'
+    assert transactions[8].question == 'ehw.fit.vutbr.cz A'
+
+
+def test_transactions_latency():
+    for transaction in tracker.transactions:
+        assert transaction.answered is True
+        assert transaction.rcode == 0
+        assert transaction.latency > 0
+
+
+def test_resolver_latencies():
+    latency = tracker.latencies['10.9.0.12']
+    assert latency.count == 9
+    assert latency.max >= latency.percentile(0.5) >= latency.min
+
+
+def test_answered_queries_not_evicted():
+    small = disspcap.DNSTracker(max_pending=2, timeout=3600)
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/dns.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        small.process(packet)
+        packet = pcap.next_packet()
+
+    small.flush()
+
+    assert small.evicted_queries == 0
+    assert all(transaction.answered for transaction in small.transactions)
+    assert small.latencies['10.9.0.12'].count == 9
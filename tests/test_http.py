@@ -27,6 +27,15 @@ def test_http_versions():
     assert packets[15].http.version == ''
 
 
+def test_http_codes():
+    assert packets[0].http.method_code == disspcap.HTTP_METHOD_GET
+    assert packets[7].http.method_code == disspcap.HTTP_METHOD_POST
+    assert packets[12].http.method_code == disspcap.HTTP_METHOD_UNKNOWN
+    assert packets[0].http.version_code == disspcap.HTTP_VERSION_1_1
+    assert packets[12].http.version_code == disspcap.HTTP_VERSION_1_1
+    assert packets[15].http.version_code == disspcap.HTTP_VERSION_UNKNOWN
+
+
 def test_http_status_code():
     assert packets[1].http.status_code == '200'
     assert packets[10].http.status_code == '404'
@@ -0,0 +1,44 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+packets = []
+fault_packets = []
+
+
+def load(path, target):
+    pcap = disspcap.Pcap(path)
+    packet = pcap.next_packet()
+
+    while packet:
+        target.append(packet)
+        packet = pcap.next_packet()
+
+
+def setup_module():
+    load(f'{dir_path}/pcaps/http.pcap', packets)
+    load(f'{dir_path}/pcaps/fault_http_decode.pcap', fault_packets)
+
+
+def test_header_case_insensitive():
+    http = packets[0].http
+    assert http.header('Host') == 'su.fit.vutbr.cz'
+    assert http.header('host') == 'su.fit.vutbr.cz'
+    assert http.header('HOST') == 'su.fit.vutbr.cz'
+
+
+def test_header_missing():
+    assert packets[0].http.header('X-Missing') is None
+
+
+def test_header_matches_dict():
+    http = packets[5].http
+    for name, value in http.headers.items():
+        assert http.header(name.lower()) == value
+
+
+def test_escaped_header():
+    user_agent = ('%98%a4%91%03%e8%c4%91%037 Professional 32 bit | '
+                  'CPU: Intel(R) Xeon(R) Platinum 8160 CPU @ 2.10GHz')
+    assert fault_packets[0].http.header('user-agent') == user_agent
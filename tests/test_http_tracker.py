@@ -0,0 +1,76 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+tracker = disspcap.HTTPTracker()
+
+
+def setup_module():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/http.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        tracker.process(packet)
+        packet = pcap.next_packet()
+
+    tracker.flush()
+
+
+def test_transactions_count():
+    assert len(tracker.transactions) == 7
+    assert tracker.unmatched_responses == 0
+    assert tracker.connection_count == 0
+
+
+def test_transactions_pairing():
+    transactions = tracker.transactions
+    assert transactions[0].method == 'GET'
+    assert transactions[0].uri == '/'
+    assert transactions[0].host == 'su.fit.vutbr.cz'
+    assert transactions[0].status_code == 200
+    assert transactions[3].method == 'POST'
+    assert transactions[3].host == 'ocsp.pki.goog'
+    assert transactions[4].uri == '/favicon.ico'
+    assert transactions[4].status_code == 404
+    assert transactions[6].status_code == 204
+
+
+def test_transactions_sizes():
+    transactions = tracker.transactions
+    assert transactions[0].request_size == 430
+    assert transactions[0].response_size == 1399
+    assert transactions[5].uri == '/img/bg.jpg'
+    assert transactions[5].response_size == 350868
+
+
+def test_transactions_timing():
+    for transaction in tracker.transactions:
+        assert transaction.time_to_first_byte > 0
+        assert transaction.total_time >= transaction.time_to_first_byte
+
+
+def test_latencies():
+    latency = tracker.latencies['su.fit.vutbr.cz/img/bg.jpg']
+    assert latency.time_to_first_byte.count == 1
+    assert latency.total_time.max > latency.time_to_first_byte.max
+    assert latency.total_time.percentile(0.5) <= latency.total_time.max
+
+
+def test_latencies_max_keys():
+    capped = disspcap.HTTPTracker(max_keys=2)
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/http.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        capped.process(packet)
+        packet = pcap.next_packet()
+
+    capped.flush()
+    latencies = capped.latencies
+    answered = [t for t in capped.transactions if t.status_code != 0]
+
+    assert len(latencies) == 3
+    assert capped.dropped_keys > 0
+    assert latencies['*'].total_time.count == capped.dropped_keys
+    assert sum(latency.total_time.count for latency in latencies.values()) == len(answered)
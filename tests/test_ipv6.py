@@ -0,0 +1,43 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+packets = []
+
+
+def setup_module():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/ipv6_extensions.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        packets.append(packet)
+        packet = pcap.next_packet()
+
+
+def test_options_headers():
+    assert packets[0].ipv6.next_header == 'UDP'
+    assert not packets[0].ipv6.is_fragment
+    assert packets[0].dns.questions[0] == 'youtube.com A'
+
+
+def test_authentication_header():
+    assert packets[4].ipv6.next_header == 'TCP'
+    assert packets[4].tcp.destination_port == 80
+
+
+def test_fragments():
+    assert packets[1].ipv6.next_header == 'IPv6 Fragment'
+    assert packets[1].ipv6.is_fragment
+    assert packets[1].ipv6.next_header_number == 17
+    assert packets[1].ipv6.fragment_offset == 48
+    assert not packets[1].ipv6.more_fragments
+    assert packets[1].ipv6.identification == 0xabcd
+    assert packets[1].udp is None
+    assert packets[2].udp is None
+
+
+def test_fragment_reassembly():
+    assert packets[3].is_reassembled
+    assert packets[3].udp.source_port == 53
+    assert packets[3].dns.answers[0] == 'youtube.com A 172.217.23.206'
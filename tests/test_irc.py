@@ -54,3 +54,12 @@ def test_irc_trailing():
                                                    ' this server')
     assert packets[22].irc.messages[0].trailing == 'Hello world.'
     assert packets[24].irc.messages[0].trailing == 'leaving'
+
+
+def test_irc_message_on_demand():
+    irc = packets[7].irc
+    assert len(irc) == len(irc.messages)
+    assert irc.message(0).command == '001'
+    assert irc.message(6).command == '251'
+    assert irc.message(6).params == irc.messages[6].params
+    assert irc.message(6).trailing == irc.messages[6].trailing
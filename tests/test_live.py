@@ -0,0 +1,40 @@
+import pytest
+import disspcap
+
+
+def test_not_started():
+    sniffer = disspcap.LiveSniffer()
+
+    with pytest.raises(RuntimeError):
+        sniffer.next_packet()
+
+    with pytest.raises(RuntimeError):
+        sniffer.next_packets()
+
+    with pytest.raises(RuntimeError):
+        sniffer.fileno()
+
+    sniffer.stop_sniffing()
+
+
+def test_unknown_interface():
+    sniffer = disspcap.LiveSniffer()
+
+    with pytest.raises(RuntimeError):
+        sniffer.start_sniffing('nonexistent0')
+
+
+def test_loopback():
+    sniffer = disspcap.LiveSniffer()
+
+    try:
+        sniffer.start_sniffing('lo', timeout=10)
+    except RuntimeError:
+        pytest.skip('capturing is not permitted')
+
+    assert sniffer.fileno() >= 0
+
+    sniffer.set_nonblocking(True)
+    assert isinstance(sniffer.next_packets(), list)
+
+    sniffer.stop_sniffing()
@@ -0,0 +1,37 @@
+import os
+import pytest
+import disspcap
+
+np = pytest.importorskip('numpy')
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+def test_to_numpy():
+    records = disspcap.to_numpy(f'{dir_path}/pcaps/http.pcap')
+
+    assert records.shape == (38,)
+    assert records.dtype.names == ('timestamp', 'length', 'payload_length', 'ip_version', 'source',
+                                   'destination', 'protocol', 'source_port', 'destination_port')
+    assert records.dtype.itemsize == 100
+
+    assert records['length'][0] == 496
+    assert records['ip_version'][0] == 4
+    assert records['source'][0] == b'10.9.242.16'
+    assert records['destination'][0] == b'147.229.177.160'
+    assert records['protocol'][0] == 6
+    assert records['source_port'][0] == 37336
+    assert records['destination_port'][0] == 80
+    assert np.all(records['timestamp'][1:] >= records['timestamp'][:-1])
+
+
+def test_fields():
+    records = disspcap.to_numpy(f'{dir_path}/pcaps/dns.pcap', fields=['destination_port', 'protocol'])
+
+    assert records.dtype.names == ('destination_port', 'protocol')
+    assert records.dtype.itemsize == 3
+    assert records['destination_port'][0] == 53
+    assert np.count_nonzero(records['protocol'] == 17) == 18
+
+    with pytest.raises(ValueError):
+        disspcap.to_numpy(f'{dir_path}/pcaps/dns.pcap', fields=['unknown'])
@@ -0,0 +1,134 @@
+import os
+import pytest
+import threading
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+def read_all(path):
+    pcap = disspcap.Pcap(path)
+    packets = []
+    packet = pcap.next_packet(copy_data=True)
+
+    while packet:
+        packets.append(packet)
+        packet = pcap.next_packet(copy_data=True)
+
+    return packets
+
+
+def test_iterate():
+    expected = read_all(f'{dir_path}/pcaps/http.pcap')
+    packets = list(disspcap.Pcap(f'{dir_path}/pcaps/http.pcap'))
+
+    assert len(packets) == len(expected) == 38
+
+    for packet, other in zip(packets, expected):
+        assert packet.timestamp == other.timestamp
+        assert packet.tcp.payload_length == other.tcp.payload_length
+        assert packet.tcp.payload == other.tcp.payload
+
+    assert packets[0].http.request_uri == '/'
+    assert packets[0].tcp.source_port == 37336
+
+
+def test_capacity():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/telnet.pcap')
+    prefetcher = disspcap.PacketPrefetcher(pcap, capacity=1)
+
+    assert iter(prefetcher) is prefetcher
+    assert sum(1 for _ in prefetcher) == 92
+    assert next(prefetcher, None) is None
+
+
+def test_early_stop():
+    for packet in disspcap.Pcap(f'{dir_path}/pcaps/telnet.pcap'):
+        if packet.telnet:
+            break
+
+    assert packet.telnet is not None
+
+
+def test_threads():
+    counts = []
+
+    def count(path):
+        counts.append(sum(1 for _ in disspcap.Pcap(path)))
+
+    threads = [threading.Thread(target=count, args=(f'{dir_path}/pcaps/dns.pcap',)) for _ in range(4)]
+
+    for thread in threads:
+        thread.start()
+
+    for thread in threads:
+        thread.join()
+
+    assert counts == [18, 18, 18, 18]
+
+
+def test_shared_pcap():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/telnet.pcap')
+    timestamps = []
+
+    def read():
+        packet = pcap.next_packet()
+
+        while packet:
+            timestamps.append(packet.timestamp)
+            packet = pcap.next_packet()
+
+    threads = [threading.Thread(target=read) for _ in range(4)]
+
+    for thread in threads:
+        thread.start()
+
+    for thread in threads:
+        thread.join()
+
+    assert sorted(timestamps) == [packet.timestamp for packet in read_all(f'{dir_path}/pcaps/telnet.pcap')]
+
+
+def test_owned_by_prefetcher():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/telnet.pcap')
+    prefetcher = iter(pcap)
+
+    with pytest.raises(RuntimeError):
+        pcap.next_packet()
+
+    with pytest.raises(RuntimeError):
+        pcap.fragments
+
+    with pytest.raises(RuntimeError):
+        iter(pcap)
+
+    assert sum(1 for _ in prefetcher) == 92
+
+    del prefetcher
+
+    assert pcap.next_packet() is None
+    assert pcap.fragments.size == 0
+
+
+def test_resume_after_break():
+    expected = [packet.timestamp for packet in read_all(f'{dir_path}/pcaps/telnet.pcap')]
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/telnet.pcap')
+    timestamps = []
+
+    for packet in pcap:
+        timestamps.append(packet.timestamp)
+
+        if len(timestamps) == 5:
+            break
+
+    timestamps.append(pcap.next_packet().timestamp)
+
+    for packet in pcap:
+        timestamps.append(packet.timestamp)
+
+        if len(timestamps) == 20:
+            break
+
+    timestamps.extend(packet.timestamp for packet in pcap)
+
+    assert timestamps == expected
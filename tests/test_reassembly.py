@@ -0,0 +1,108 @@
+import os
+import pytest
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+packets = []
+fragments = None
+
+
+def setup_module():
+    global fragments
+
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/ipv4_fragments.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        packets.append(packet)
+        packet = pcap.next_packet()
+
+    fragments = pcap.fragments
+
+
+def test_incomplete_fragments():
+    assert packets[0].ipv4.is_fragment
+    assert packets[0].ipv4.more_fragments
+    assert packets[0].udp is None
+    assert packets[1].ipv4.fragment_offset == 64
+    assert packets[1].udp is None
+
+
+def test_in_order_reassembly():
+    assert packets[2].is_reassembled
+    assert packets[2].ipv4.fragment_offset == 128
+    assert packets[2].udp.source_port == 53
+    assert packets[2].dns.answers[0] == ('google.com SOA "ns1.google.com '
+                                         'dns-admin.google.com 237687157 900 '
+                                         '900 1800 60"')
+
+
+def test_unfragmented():
+    assert not packets[3].ipv4.is_fragment
+    assert not packets[3].is_reassembled
+    assert packets[3].dns.questions[0] == 'youtube.com A'
+
+
+def test_out_of_order_reassembly():
+    assert packets[4].ipv4.fragment_offset == 24
+    assert packets[4].udp is None
+    assert packets[6].is_reassembled
+    assert packets[6].dns.answers[0] == 'youtube.com A 172.217.23.206'
+
+
+def test_fragment_cache_stats():
+    assert packets[7].udp is None
+    assert fragments.reassembled == 2
+    assert fragments.size == 1
+
+
+def read_overlapping(**settings):
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/ipv4_overlap.pcap')
+
+    for name, value in settings.items():
+        setattr(pcap.fragments, name, value)
+
+    payloads = []
+    packet = pcap.next_packet()
+
+    while packet:
+        if packet.udp:
+            payloads.append(packet.udp.payload)
+
+        packet = pcap.next_packet()
+
+    return payloads, pcap.fragments
+
+
+def test_overlap_first():
+    payloads, fragments = read_overlapping()
+
+    assert fragments.overlap_policy == disspcap.FRAG_OVERLAP_FIRST
+    assert payloads == [b'AAAAAAAACCCCCCCCDDDDDDDD']
+
+
+def test_overlap_last():
+    payloads, fragments = read_overlapping(overlap_policy=disspcap.FRAG_OVERLAP_LAST)
+
+    assert payloads == [b'BBBBBBBBCCCCCCCCDDDDDDDD']
+    assert fragments.reassembled == 1
+
+
+def test_overlap_drop():
+    payloads, fragments = read_overlapping(overlap_policy=disspcap.FRAG_OVERLAP_DROP)
+
+    assert payloads == []
+    assert fragments.reassembled == 0
+    assert fragments.dropped == 1
+
+
+def test_fragment_settings():
+    payloads, fragments = read_overlapping(max_trains=8, timeout=0.5)
+
+    assert fragments.max_trains == 8
+    assert fragments.timeout == 0.5
+    assert len(payloads) == 1
+
+    with pytest.raises(ValueError):
+        fragments.overlap_policy = 3
@@ -0,0 +1,64 @@
+import random
+import pytest
+import disspcap
+
+
+def reference_either(data, first, second):
+    return next((i for i, byte in enumerate(data) if byte in (first, second)), len(data))
+
+
+def reference_unprintable(data, delimiter, allow_space):
+    def stops(byte):
+        space = allow_space and 0x09 <= byte <= 0x0d
+        return byte == delimiter or not (0x20 <= byte < 0x7f or space)
+
+    return next((i for i, byte in enumerate(data) if stops(byte)), len(data))
+
+
+@pytest.fixture(params=disspcap.scan_kernels())
+def kernel(request):
+    previous = disspcap.scan_kernel()
+    disspcap.set_scan_kernel(request.param)
+    yield request.param
+    disspcap.set_scan_kernel(previous)
+
+
+def test_kernels():
+    kernels = disspcap.scan_kernels()
+
+    assert kernels[0] == 'scalar'
+    assert disspcap.scan_kernel() == kernels[-1]
+
+    with pytest.raises(ValueError):
+        disspcap.set_scan_kernel('unknown')
+
+
+@pytest.mark.parametrize('length', [0, 1, 15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65, 100])
+def test_block_boundaries(kernel, length):
+    for position in range(-1, length):
+        for byte in (0x00, 0x0a, 0x0d, 0x1f, 0x20, 0x3a, 0x7e, 0x7f, 0x80, 0xff):
+            data = bytearray(b'a' * length)
+
+            if position >= 0:
+                data[position] = byte
+
+            data = bytes(data)
+
+            assert disspcap.find_either(data, 0x0d, 0x00) == reference_either(data, 0x0d, 0x00)
+
+            for allow_space in (False, True):
+                expected = reference_unprintable(data, 0x3a, allow_space)
+                assert disspcap.find_unprintable(data, 0x3a, allow_space) == expected
+
+
+def test_random_data(kernel):
+    generator = random.Random(41)
+
+    for _ in range(500):
+        length = generator.randrange(0, 130)
+        data = bytes(generator.choice(b'abc :\r\n\t\x00\x7f\xff') for _ in range(length))
+
+        assert disspcap.find_either(data, 0x0d, 0x0a) == reference_either(data, 0x0d, 0x0a)
+        assert disspcap.find_unprintable(data, 0x3a, True) == reference_unprintable(data, 0x3a, True)
+        assert disspcap.escape_unprintable(data) == ''.join(
+            chr(byte) if 0x20 <= byte < 0x7f else f'%{byte:02x}' for byte in data)
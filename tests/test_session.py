@@ -0,0 +1,113 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+def build(name, builder):
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/{name}')
+    packet = pcap.next_packet()
+
+    while packet:
+        builder.process(packet)
+        packet = pcap.next_packet()
+
+    builder.flush()
+    return builder
+
+
+def test_telnet_transcript():
+    builder = build('telnet.pcap', disspcap.SessionBuilder())
+    transcripts = builder.transcripts
+
+    assert len(transcripts) == 1
+    assert builder.session_count == 0
+    assert builder.memory == 0
+
+    transcript = transcripts[0]
+    assert transcript.protocol == disspcap.SESSION_TELNET
+    assert transcript.client == '192.168.0.2'
+    assert transcript.client_port == 1550
+    assert transcript.server_port == 23
+    assert transcript.closed is True
+    assert transcript.truncated is False
+    assert transcript.gaps == 0
+    assert (True, '/sbin/ping www.yahoo.com') in [(line[1], line[2]) for line in transcript.lines]
+
+
+def test_irc_transcript():
+    transcript = build('irc.pcap', disspcap.SessionBuilder()).transcripts[0]
+
+    assert transcript.protocol == disspcap.SESSION_IRC
+    assert transcript.server_port == 6667
+    assert transcript.lines[0][1] is True
+    assert transcript.lines[0][2] == 'CAP LS'
+    assert transcript.lines[1][2] == 'NICK daniel'
+
+
+def test_session_cap():
+    transcript = build('telnet.pcap', disspcap.SessionBuilder(max_session_bytes=5000)).transcripts[0]
+
+    assert transcript.truncated is True
+    assert len(transcript) < len(build('telnet.pcap', disspcap.SessionBuilder()).transcripts[0])
+
+
+def test_output(tmp_path):
+    path = str(tmp_path / 'transcripts.txt')
+    builder = disspcap.SessionBuilder()
+    builder.set_output(path)
+    build('telnet.pcap', builder)
+
+    assert builder.transcripts == []
+
+    with open(path) as output:
+        lines = output.read().splitlines()
+
+    assert lines[0].startswith('# 192.168.0.2:1550 -> 192.168.0.1:23 TELNET')
+    assert any(line.endswith('C: /sbin/ping www.yahoo.com') for line in lines)
+
+
+def test_total_cap_evicts():
+    builder = build('telnet.pcap', disspcap.SessionBuilder(max_total_bytes=1))
+
+    assert builder.evicted_sessions == 49
+    assert len(builder.transcripts) == 49
+    assert not any(transcript.closed for transcript in builder.transcripts[:-1])
+    assert builder.session_count == 0
+    assert builder.memory == 0
+
+
+def test_kept_cap():
+    builder = build('irc.pcap', disspcap.SessionBuilder(max_kept_bytes=1))
+
+    assert builder.transcripts == []
+    assert builder.dropped_transcripts == 1
+    assert builder.kept_memory == 0
+
+    builder = build('irc.pcap', disspcap.SessionBuilder())
+
+    assert builder.kept_memory > 0
+    builder.clear_transcripts()
+    assert builder.kept_memory == 0
+
+
+def test_partial_line_memory():
+    builder = disspcap.SessionBuilder()
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/irc_partial.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        builder.process(packet)
+        packet = pcap.next_packet()
+
+    # 2800 bytes of unfinished line are held by open session
+    assert builder.session_count == 1
+    assert builder.memory >= 2800
+
+    builder.flush()
+    assert builder.memory == 0
+    assert builder.transcripts[0].lines[0][2] == 'a' * 2800
+
+    transcript = build('irc_partial.pcap', disspcap.SessionBuilder(max_session_bytes=2000)).transcripts[0]
+    assert transcript.truncated is True
+    assert len(transcript) == 0
@@ -0,0 +1,30 @@
+import os
+import pytest
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+@pytest.mark.parametrize('copy_data', [False, True])
+def test_captured_bytes_only(copy_data):
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/snaplen.pcap')
+    packet = pcap.next_packet(copy_data)
+
+    assert packet.length == 68
+    assert len(packet.raw_data) == 68
+    assert pcap.last_packet_length == 496
+    assert packet.tcp.source_port == 37336
+    assert packet.payload_length == 2
+
+
+@pytest.mark.parametrize('copy_data', [False, True])
+def test_truncated_ipv6_extensions(copy_data):
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/snaplen_ipv6.pcap')
+    packet = pcap.next_packet(copy_data)
+
+    assert packet.length == 55
+    assert pcap.last_packet_length == 82
+    assert packet.ipv6.source == '2001:db8::1'
+    assert packet.ipv6.next_header == 'IPv6 Hop-by-Hop'
+    assert packet.payload_length == 1
+    assert packet.udp is None
@@ -0,0 +1,91 @@
+import os
+import threading
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+pcaps = ['dns.pcap', 'http.pcap', 'ipv6_extensions.pcap', 'irc.pcap', 'tunnels.pcap']
+
+
+def fields(packet):
+    network = packet.ipv4 or packet.ipv6
+    transport = packet.tcp or packet.udp
+
+    return (packet.timestamp,
+            packet.length,
+            network.source if network else '',
+            network.destination if network else '',
+            'TCP' if packet.tcp else 'UDP' if packet.udp else '',
+            transport.source_port if transport else 0,
+            transport.destination_port if transport else 0,
+            packet.payload_length)
+
+
+def test_summary():
+    for name in pcaps:
+        pcap = disspcap.Pcap(f'{dir_path}/pcaps/{name}')
+        packet = pcap.next_packet()
+
+        while packet:
+            assert packet.summary() == fields(packet)
+            packet = pcap.next_packet()
+
+
+def test_summary_values():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/http.pcap')
+    summary = pcap.next_packet().summary()
+
+    assert summary[4] == 'TCP'
+    assert summary[6] == 80
+
+
+def test_next_summary():
+    for name in pcaps:
+        expected = []
+        pcap = disspcap.Pcap(f'{dir_path}/pcaps/{name}')
+        packet = pcap.next_packet()
+
+        while packet:
+            expected.append(packet.summary())
+            packet = pcap.next_packet()
+
+        summaries = []
+        pcap = disspcap.Pcap(f'{dir_path}/pcaps/{name}')
+        summary = pcap.next_summary()
+
+        while summary:
+            summaries.append(summary)
+            summary = pcap.next_summary()
+
+        assert summaries == expected
+
+
+
+def test_next_summary_threads():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/http.pcap')
+    expected = []
+    packet = pcap.next_packet()
+
+    while packet:
+        expected.append(packet.summary())
+        packet = pcap.next_packet()
+
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/http.pcap')
+    summaries = []
+
+    def read():
+        summary = pcap.next_summary()
+
+        while summary:
+            summaries.append(summary)
+            summary = pcap.next_summary()
+
+    threads = [threading.Thread(target=read) for _ in range(4)]
+
+    for thread in threads:
+        thread.start()
+
+    for thread in threads:
+        thread.join()
+
+    assert sorted(summaries) == sorted(expected)
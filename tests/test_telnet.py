@@ -61,3 +61,36 @@ def test_empty():
     assert packets[7].telnet.is_empty is True
     assert packets[15].telnet.is_empty is True
     assert packets[29].telnet.is_empty is True
+
+
+def test_commands():
+    commands = packets[4].telnet.commands
+    assert len(commands) == 1
+    assert commands[0].command == 253
+    assert commands[0].option == 37
+
+
+def test_subnegotiation():
+    commands = packets[14].telnet.commands
+    assert [c.command for c in commands] == [250] * 4
+    assert [c.option for c in commands] == [32, 35, 39, 24]
+    assert commands[0].parameters == b'\x01'
+
+
+def test_tracker_split_command():
+    tracker = disspcap.TelnetTracker()
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/telnet.pcap')
+    commands = {}
+    index = 0
+    packet = pcap.next_packet()
+
+    while packet:
+        if tracker.process(packet):
+            commands[index] = [c.command for c in tracker.commands]
+        index += 1
+        packet = pcap.next_packet()
+
+    # IAC DM split over packets 71 and 72
+    assert commands[71] == []
+    assert commands[72] == [242]
+    assert tracker.gaps == 0
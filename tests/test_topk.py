@@ -0,0 +1,62 @@
+import os
+import socket
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+def test_most_common_ip():
+    assert disspcap.most_common_ip(f'{dir_path}/pcaps/dns.pcap') == '10.9.0.12'
+    assert disspcap.most_common_ip(f'{dir_path}/pcaps/http.pcap', capacity=4) == '10.9.242.16'
+
+
+def test_exact_counts():
+    topk = disspcap.TopK(8)
+
+    for i in range(5):
+        topk.add(bytes([i]), weight=i + 1)
+
+    top = topk.top(3)
+    assert [entry.key for entry in top] == [b'\x04', b'\x03', b'\x02']
+    assert [entry.count for entry in top] == [5, 4, 3]
+    assert all(entry.error == 0 for entry in top)
+    assert topk.total == 15
+    assert topk.error_bound == 0
+    assert len(topk) == 5
+
+
+def test_error_bounds():
+    topk = disspcap.TopK(4)
+    counts = {}
+
+    for i in range(1000):
+        key = socket.inet_aton(f'10.0.0.{i % 3 if i % 2 else i % 50}')
+        counts[key] = counts.get(key, 0) + 1
+        topk.add(key)
+
+    assert len(topk) == 4
+    assert topk.error_bound <= topk.total // 4
+
+    for entry in topk.top(4):
+        assert entry.count - entry.error <= counts[entry.key] <= entry.count
+
+    for key, count in counts.items():
+        assert topk.estimate(key) >= count
+
+
+def test_merge():
+    first = disspcap.TopK(16)
+    second = disspcap.TopK(16)
+
+    for i in range(100):
+        first.add(b'a')
+        second.add(b'b' if i % 4 else b'a')
+
+    first.merge(second)
+    assert first.total == 200
+    assert first.top(1)[0].key == b'a'
+    assert first.top(1)[0].count == 125
+    assert first.estimate(b'b') == 75
+
+    first.clear()
+    assert len(first) == 0
@@ -0,0 +1,69 @@
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+packets = []
+
+
+def setup_module():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/tunnels.pcap')
+    packet = pcap.next_packet()
+
+    while packet:
+        packets.append(packet)
+        packet = pcap.next_packet()
+
+
+def layers(packet):
+    return [(layer.type, layer.id) for layer in packet.layers]
+
+
+def test_vxlan():
+    assert layers(packets[0]) == [('Ethernet', 0), ('IPv4', 0), ('VXLAN', 4242), ('Ethernet', 0)]
+    assert packets[0].layers[2].offset == 34
+    assert packets[0].ethernet.source == '20:47:47:cc:ff:1a'
+    assert packets[0].ipv4.source == '10.9.242.16'
+    assert packets[0].udp.destination_port == 53
+    assert packets[0].dns.questions[0] == 'youtube.com A'
+
+
+def test_qinq():
+    assert layers(packets[1]) == [('Ethernet', 0), ('VLAN', 100), ('VLAN', 200)]
+    assert packets[1].ethernet.type == 'IPv4'
+    assert packets[1].ethernet.ether_type == 0x0800
+    assert packets[1].dns.questions[0] == 'youtube.com A'
+
+
+def test_mpls():
+    assert layers(packets[2]) == [('Ethernet', 0), ('MPLS', 1000), ('MPLS', 2000)]
+    assert packets[2].ipv4.destination == '10.9.0.12'
+    assert packets[2].udp.source_port == 47783
+
+
+def test_gre_erspan():
+    assert layers(packets[3]) == [('Ethernet', 0), ('IPv4', 0), ('GRE', 77), ('ERSPAN', 5), ('Ethernet', 0)]
+    assert packets[3].ethernet.source == 'c8:1f:be:7a:e6:72'
+    assert packets[3].ipv4.source == '10.9.0.12'
+    assert packets[3].udp.source_port == 53
+
+
+def test_gtpu():
+    assert layers(packets[4]) == [('Ethernet', 0), ('IPv4', 0), ('GTP-U', 4660)]
+    assert packets[4].ipv4.source == '10.9.242.16'
+    assert packets[4].dns.questions[0] == 'youtube.com A'
+
+
+def test_not_tunneled():
+    assert layers(packets[5]) == [('Ethernet', 0)]
+    assert packets[5].ipv4.source == '10.0.0.1'
+    assert packets[5].udp.source_port == 2152
+    assert packets[5].udp.destination_port == 2152
+    assert packets[5].dns is None
+
+
+def test_gre_unknown_protocol():
+    assert layers(packets[6]) == [('Ethernet', 0)]
+    assert packets[6].ethernet.ether_type == 0x0800
+    assert packets[6].ipv4.source == '10.0.0.1'
+    assert packets[6].ipv4.destination == '10.0.0.2'
@@ -0,0 +1,49 @@
+import gc
+import os
+import disspcap
+
+dir_path = os.path.dirname(os.path.realpath(__file__))
+
+
+def first_http():
+    for packet in disspcap.Pcap(f'{dir_path}/pcaps/http.pcap'):
+        if packet.http:
+            return packet
+
+
+def test_payload_view():
+    packet = first_http()
+    payload = packet.tcp.payload
+
+    assert isinstance(payload, memoryview)
+    assert payload.readonly
+    assert len(payload) == packet.tcp.payload_length
+    assert payload.tobytes().startswith(b'GET / HTTP/1.1\r\n')
+    assert payload[:3] == b'GET'
+
+
+def test_view_keeps_packet_alive():
+    payload = first_http().tcp.payload
+    gc.collect()
+
+    assert payload.tobytes().startswith(b'GET / HTTP/1.1\r\n')
+
+
+def test_raw_data():
+    pcap = disspcap.Pcap(f'{dir_path}/pcaps/dns.pcap')
+    packet = pcap.next_packet()
+    raw = packet.raw_data
+
+    pcap.next_packet()
+
+    assert len(raw) == packet.length
+    assert raw[12:14] == b'\x08\x00'
+    assert packet.payload == packet.udp.payload
+    assert packet.payload_length == packet.udp.payload_length
+
+
+def test_empty_body():
+    packet = first_http()
+
+    assert packet.http.body.tobytes() == b''
+    assert packet.http.body_length == 0